@@ -0,0 +1,272 @@
+#include "IoThread.h"
+#include "StoreServer.h"
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#elif defined(_WIN32)
+#define poll WSAPoll
+#else
+#include <poll.h>
+#endif
+
+constexpr uint32_t IoThread::PollTimeoutMillis;
+
+IoThread::IoThread(StoreServer* server)
+		: mServer(server), mRunning(false), mPollFd(-1), mWakeFd(-1) {
+}
+
+IoThread::~IoThread() {
+	stop();
+}
+
+uint32_t IoThread::size() const {
+	lock_guard<mutex> l(mLock);
+	return mClients.size();
+}
+
+void IoThread::receive(StoreClient* client) {
+	serve(client, client->receive());
+}
+
+void IoThread::serve(StoreClient* client, ESErrorCode err) {
+	// The requests that are already received are handled when the client is resumed
+	while (err != ESERR_SOCKET_DISCONNECTED && !isErrorCodeFatal(err) && client->full()) {
+		if (client->pause()) {
+			watch(client, false);
+			return;
+		}
+		err = client->handleFrames();
+	}
+
+	if (err == ESERR_SOCKET_DISCONNECTED || isErrorCodeFatal(err)) {
+		remove(client);
+	}
+}
+
+void IoThread::resumeClients() {
+	{
+		lock_guard<mutex> l(mResumeLock);
+		mResuming.swap(mResumed);
+	}
+
+	// A client might have been removed after it was resumed
+	for (auto id : mResuming) {
+		StoreClient* client = nullptr;
+		{
+			lock_guard<mutex> l(mLock);
+			const auto it = mClients.find(id);
+			if (it != mClients.end()) {
+				client = it->second;
+			}
+		}
+		if (client != nullptr && !client->paused()) {
+			watch(client, true);
+			serve(client, client->handleFrames());
+		}
+	}
+	mResuming.clear();
+}
+
+void IoThread::remove(StoreClient* client) {
+	Log::Write(Log::Info, "IoThread(%p) | Client %d is no longer running", this, client->handle()->GetHandle());
+#if defined(__linux__)
+	epoll_ctl(mPollFd, EPOLL_CTL_DEL, client->handle()->GetHandle(), nullptr);
+#endif
+	{
+		lock_guard<mutex> l(mLock);
+		mClients.erase(client->id());
+	}
+	mServer->onClientDisconnected(client);
+	delete client;
+}
+
+void IoThread::stop() {
+	if (mRunning.exchange(false)) {
+		mThread.join();
+	}
+
+	// Gracefully disconnect all clients. The workers might still be sending responses to them through the server
+	lock_guard<mutex> l(mLock);
+	for (auto& pair : mClients) {
+		mServer->onClientDisconnected(pair.second);
+		delete pair.second;
+	}
+	mClients.clear();
+	mResumed.clear();
+
+#if defined(__linux__)
+	if (mPollFd != -1) {
+		close(mPollFd);
+		mPollFd = -1;
+	}
+	if (mWakeFd != -1) {
+		close(mWakeFd);
+		mWakeFd = -1;
+	}
+#endif
+}
+
+#if defined(__linux__)
+
+ESErrorCode IoThread::start() {
+	mPollFd = epoll_create1(EPOLL_CLOEXEC);
+	if (mPollFd == -1) {
+		return ESERR_SOCKET_CONFIGURE;
+	}
+
+	// The eventfd is found by its null pointer, since a client is never null
+	mWakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (mWakeFd == -1) {
+		return ESERR_SOCKET_CONFIGURE;
+	}
+	epoll_event event;
+	memset(&event, 0, sizeof(event));
+	event.events = EPOLLIN;
+	event.data.ptr = nullptr;
+	if (epoll_ctl(mPollFd, EPOLL_CTL_ADD, mWakeFd, &event) == -1) {
+		return ESERR_SOCKET_CONFIGURE;
+	}
+
+	mRunning = true;
+	mThread = thread(&IoThread::run, this);
+	return ESERR_NO_ERROR;
+}
+
+ESErrorCode IoThread::add(StoreClient* client) {
+	client->setIoThread(this);
+	{
+		lock_guard<mutex> l(mLock);
+		mClients[client->id()] = client;
+	}
+
+	// Level triggered, so that a client with more than one request waiting is served again on the next turn
+	epoll_event event;
+	memset(&event, 0, sizeof(event));
+	event.events = EPOLLIN | EPOLLRDHUP;
+	event.data.ptr = client;
+	if (epoll_ctl(mPollFd, EPOLL_CTL_ADD, client->handle()->GetHandle(), &event) == -1) {
+		lock_guard<mutex> l(mLock);
+		mClients.erase(client->id());
+		return ESERR_SOCKET_CONFIGURE;
+	}
+	return ESERR_NO_ERROR;
+}
+
+void IoThread::run() {
+	Log::Write(Log::Info, "IoThread(%p) | Starting up thread", this);
+
+	epoll_event events[64];
+	while (mRunning) {
+		const int count = epoll_wait(mPollFd, events, 64, PollTimeoutMillis);
+		bool woken = false;
+		for (int i = 0; i < count; ++i) {
+			if (events[i].data.ptr == nullptr) {
+				uint64_t value;
+				while (read(mWakeFd, &value, sizeof(value)) > 0) {}
+				woken = true;
+			} else {
+				receive((StoreClient*) events[i].data.ptr);
+			}
+		}
+
+		// A resumed client might be removed, so the clients are resumed after the events are handled. Otherwise the
+		// events after the wake-up could point to a deleted client
+		if (woken) {
+			resumeClients();
+		}
+	}
+
+	Log::Write(Log::Info, "IoThread(%p) | Shutting down thread", this);
+}
+
+void IoThread::resume(int32_t client) {
+	{
+		lock_guard<mutex> l(mResumeLock);
+		mResumed.push_back(client);
+	}
+	const uint64_t value = 1;
+	if (write(mWakeFd, &value, sizeof(value)) == -1) {
+		// The eventfd is already readable
+	}
+}
+
+void IoThread::watch(StoreClient* client, bool reading) {
+	// A paused client is still removed when the connection is closed, since EPOLLHUP is always reported
+	epoll_event event;
+	memset(&event, 0, sizeof(event));
+	event.events = reading ? EPOLLIN | EPOLLRDHUP : 0;
+	event.data.ptr = client;
+	epoll_ctl(mPollFd, EPOLL_CTL_MOD, client->handle()->GetHandle(), &event);
+}
+
+#else
+
+ESErrorCode IoThread::start() {
+	mRunning = true;
+	mThread = thread(&IoThread::run, this);
+	return ESERR_NO_ERROR;
+}
+
+ESErrorCode IoThread::add(StoreClient* client) {
+	// The client is polled from the next turn
+	client->setIoThread(this);
+	lock_guard<mutex> l(mLock);
+	mClients[client->id()] = client;
+	return ESERR_NO_ERROR;
+}
+
+void IoThread::run() {
+	Log::Write(Log::Info, "IoThread(%p) | Starting up thread", this);
+
+	vector<pollfd> fds;
+	vector<StoreClient*> clients;
+	while (mRunning) {
+		resumeClients();
+
+		fds.clear();
+		clients.clear();
+		{
+			lock_guard<mutex> l(mLock);
+			for (auto& pair : mClients) {
+				StoreClient* const client = pair.second;
+				if (client->paused()) {
+					continue;
+				}
+
+				pollfd fd;
+				fd.fd = client->handle()->GetHandle();
+				fd.events = POLLIN;
+				fd.revents = 0;
+				fds.push_back(fd);
+				clients.push_back(client);
+			}
+		}
+
+		if (fds.empty()) {
+			this_thread::sleep_for(chrono::milliseconds(PollTimeoutMillis));
+			continue;
+		}
+
+		const int count = poll(fds.data(), fds.size(), PollTimeoutMillis);
+		for (uint32_t i = 0; count > 0 && i < fds.size(); ++i) {
+			if (fds[i].revents != 0) {
+				receive(clients[i]);
+			}
+		}
+	}
+
+	Log::Write(Log::Info, "IoThread(%p) | Shutting down thread", this);
+}
+
+void IoThread::resume(int32_t client) {
+	// The client is polled again from the next turn
+	lock_guard<mutex> l(mResumeLock);
+	mResumed.push_back(client);
+}
+
+void IoThread::watch(StoreClient* client, bool reading) {
+	// The paused clients are skipped when the clients are polled
+}
+
+#endif
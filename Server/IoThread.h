@@ -0,0 +1,78 @@
+#ifndef _EVERSTORE_IO_THREAD_H_
+#define _EVERSTORE_IO_THREAD_H_
+
+#include "../Shared/everstore.h"
+#include "StoreClient.h"
+
+class StoreServer;
+
+//
+// A thread that waits for requests on many client connections at the same time. Uses epoll on Linux and poll on
+// the other platforms. A client is removed, and the server notified, as soon as it disconnects. A client with too many
+// requests in flight is not read from until it's resumed
+class IoThread
+{
+public:
+	// How long the thread waits for a request before it checks if it's stopped
+	static constexpr uint32_t PollTimeoutMillis = 100;
+
+	explicit IoThread(StoreServer* server);
+
+	~IoThread();
+
+	// Start the thread
+	ESErrorCode start();
+
+	// Stop the thread and delete all clients that are still connected
+	void stop();
+
+	// Add a client. The thread takes ownership of the client
+	ESErrorCode add(StoreClient* client);
+
+	// Retrieves how many clients that are served by this thread
+	uint32_t size() const;
+
+	//
+	// Continue with a paused client. Can be called by any thread. The client is found by its id, since it might be
+	// removed, and another client created at the same address, before the I/O thread gets to it
+	void resume(int32_t client);
+
+private:
+	// Wait for requests until the thread is stopped
+	void run();
+
+	// Read the requests from the supplied client. The client is removed if it's disconnected
+	void receive(StoreClient* client);
+
+	// Pause the client if it's full after its requests are handled. The client is removed if it's disconnected
+	void serve(StoreClient* client, ESErrorCode err);
+
+	// Continue with the clients that are resumed
+	void resumeClients();
+
+	// Start or stop waiting for requests from the supplied client
+	void watch(StoreClient* client, bool reading);
+
+	// Remove and delete the supplied client
+	void remove(StoreClient* client);
+
+private:
+	StoreServer* const mServer;
+	atomic_bool mRunning;
+	thread mThread;
+
+	// The epoll instance, and the eventfd that wakes up the thread when a client is resumed (Linux only)
+	int mPollFd;
+	int mWakeFd;
+
+	// The clients served by this thread, found by their id
+	mutable mutex mLock;
+	unordered_map<int32_t, StoreClient*> mClients;
+
+	// The ids of the clients that are resumed by other threads
+	mutex mResumeLock;
+	vector<int32_t> mResumed;
+	vector<int32_t> mResuming;
+};
+
+#endif
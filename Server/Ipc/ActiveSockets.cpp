@@ -0,0 +1,67 @@
+#include "ActiveSockets.h"
+#include "../StoreClient.h"
+
+void ActiveSockets::add(StoreClient* client) {
+	ActiveSocket activeSocket;
+	activeSocket.socket = client->handle();
+	activeSocket.m = client->clientLock();
+	activeSocket.client = client;
+
+	lock_guard<mutex> l(mLock);
+	mSockets[client->id()] = activeSocket;
+}
+
+void ActiveSockets::remove(int32_t client) {
+	Mutex* m = nullptr;
+	{
+		lock_guard<mutex> l(mLock);
+		auto it = mSockets.find(client);
+		if (it == mSockets.end()) {
+			return;
+		}
+		m = it->second.m;
+		mSockets.erase(it);
+	}
+
+	// A response that's being sent holds the client's mutex. The mutex is locked after the client is removed, so no
+	// other response can be started
+	m->Lock();
+	m->Unlock();
+}
+
+ESErrorCode ActiveSockets::send(int32_t client, const SocketPart* parts, uint32_t count, uint32_t completed) {
+	unique_lock<mutex> l(mLock);
+	auto it = mSockets.find(client);
+	if (it == mSockets.end()) {
+		return ESERR_SOCKET_NOT_ATTACHED;
+	}
+	const ActiveSocket activeSocket = it->second;
+
+	// Lock the client before the list is unlocked, so that the client is not removed while the response is sent
+	activeSocket.m->Lock();
+	l.unlock();
+
+	uint32_t size = 0;
+	for (uint32_t i = 0; i < count; ++i) {
+		size += parts[i].size;
+	}
+	const auto sentBytes = count > 0 ? activeSocket.socket->SendAll(parts, count) : 0;
+	if (completed > 0) {
+		activeSocket.client->onRequestsCompleted(completed);
+	}
+	activeSocket.m->Unlock();
+
+	if (sentBytes != (int32_t) size) {
+		return ESERR_SOCKET_SEND;
+	}
+	return ESERR_NO_ERROR;
+}
+
+void ActiveSockets::forgetRequests() {
+	lock_guard<mutex> l(mLock);
+	for (auto& pair : mSockets) {
+		pair.second.m->Lock();
+		pair.second.client->onRequestsLost();
+		pair.second.m->Unlock();
+	}
+}
@@ -0,0 +1,43 @@
+#ifndef _EVERSTORE_ACTIVE_SOCKETS_H_
+#define _EVERSTORE_ACTIVE_SOCKETS_H_
+
+#include "../../Shared/everstore.h"
+
+class StoreClient;
+
+struct ActiveSocket
+{
+	Socket* socket;
+	Mutex* m;
+	StoreClient* client;
+};
+
+//
+// The clients connected to the server, found by their id when the workers send responses back to the server. Can be
+// used by many threads at the same time
+class ActiveSockets
+{
+public:
+	void add(StoreClient* client);
+
+	//
+	// Remove the supplied client. Waits until no response is being sent to it, so the socket can be deleted as soon
+	// as this returns
+	void remove(int32_t client);
+
+	//
+	// Send the supplied memory blocks to the client, without any other response in between, and tell the client how
+	// many of its requests are completed by them. Nothing is sent if there are no memory blocks
+	//
+	// \return ESERR_SOCKET_NOT_ATTACHED if the client has disconnected
+	ESErrorCode send(int32_t client, const SocketPart* parts, uint32_t count, uint32_t completed);
+
+	// Forget the requests in flight for all clients. The requests sent to a worker that's restarted never complete
+	void forgetRequests();
+
+private:
+	mutex mLock;
+	unordered_map<int32_t, ActiveSocket> mSockets;
+};
+
+#endif
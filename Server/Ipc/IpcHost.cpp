@@ -1,26 +1,39 @@
 #include "IpcHost.h"
+#include "../StoreClient.h"
 #include "../../Shared/StringUtils.h"
 #include <stdlib.h>
 #include <string.h>
 
-IpcHost::IpcHost(const Path& rootDir, const Path& configPath, uint32_t maxBufferSize)
-		: mRootDir(rootDir), mConfigPath(configPath), mMaxBufferSize(maxBufferSize) {
+IpcHost::IpcHost(const Path& rootDir, const Path& configPath, uint32_t maxBufferSize, uint32_t ringSize,
+                 bool serverResponses, bool completions)
+		: mRootDir(rootDir), mConfigPath(configPath), mMaxBufferSize(maxBufferSize),
+		  mRingSize(ringSize > 0 ? std::max(ringSize, 2 * (maxBufferSize + (uint32_t) sizeof(ESHeader))) : 0),
+		  mServerResponses(serverResponses), mCompletions(serverResponses || completions) {
 }
 
 void IpcHost::close() {
 	ESHeader header;
 	header.type = REQ_SHUTDOWN;
 
+	// The clients are already disconnected, so the responses are not needed while the workers are shutting down
+	for (auto reader : mReaders) {
+		if (reader != nullptr) {
+			reader->stop();
+		}
+	}
+
 	// Send a shutdown message to all worker processes
-	for (auto process : mProcesses) {
-		process->sendTo(&header);
+	for (auto writer : mWriters) {
+		writer->send((const char*) &header, sizeof(header));
 	}
 
-	// Wait for the process to shutdown and then close all host handles
-	for (auto client : mProcesses) {
-		delete client;
+	// Wait for the process to shutdown and then close all host handles. The writers send the queued messages first
+	for (uint32_t i = 0; i < mProcesses.size(); ++i) {
+		destroyWorker(i);
 	}
 	mProcesses.clear();
+	mWriters.clear();
+	mReaders.clear();
 }
 
 ESErrorCode IpcHost::send(const ESHeader* message) {
@@ -32,15 +45,15 @@ ESErrorCode IpcHost::send(const ESHeader* message) {
 	const uint32_t numProcesses = mProcesses.size() + 1;
 	for (uint32_t i = 1u; i < numProcesses; ++i) {
 		const ProcessID id(i);
-		auto process = mProcesses[id.AsIndex()];
-		err = process->sendTo(message);
+		auto process = mWriters[id.AsIndex()];
+		err = process->send((const char*) message, sizeof(ESHeader));
 		if (isError(err)) {
 			Log::Write(Log::Error,
 			           "An error occurred while sending data to client %d. Trying to restart the process. Reason: %s (%d)",
 			           id, parseErrorCode(err), err);
 			process = tryRestartWorker(id);
 			if (process) {
-				err = process->sendTo(message);
+				err = process->send((const char*) message, sizeof(ESHeader));
 			}
 		}
 	}
@@ -55,15 +68,16 @@ ESErrorCode IpcHost::send(const ProcessID id, const ByteBuffer* bytes) {
 	if (!workerExists(id))
 		return ESERR_WORKER_UNKNOWN;
 
-	auto process = mProcesses[id.AsIndex()];
-	ESErrorCode err = process->sendTo(bytes);
+	// The bytes are copied, so the memory can be reused as soon as this returns
+	auto process = mWriters[id.AsIndex()];
+	ESErrorCode err = process->send(bytes->ptr(), bytes->offset());
 	if (isError(err)) {
 		Log::Write(Log::Error,
 		           "An error occurred while sending data to client %d. Trying to restart the process. Reason: %s (%d)",
 		           id, parseErrorCode(err), err);
 		process = tryRestartWorker(id);
 		if (process) {
-			err = process->sendTo(bytes);
+			err = process->send(bytes->ptr(), bytes->offset());
 		}
 	}
 	return err;
@@ -77,23 +91,35 @@ ESErrorCode IpcHost::addWorker() {
 	return ESERR_NO_ERROR;
 }
 
-ESErrorCode IpcHost::onClientConnected(Socket* socket, Mutex* lock) {
-	if (socket == nullptr || lock == nullptr) {
+ESErrorCode IpcHost::onClientConnected(StoreClient* storeClient) {
+	if (storeClient == nullptr) {
 		return ESERR_INVALID_ARGUMENT;
 	}
-
-	ActiveSocket activeSocket;
-	activeSocket.socket = socket;
-	activeSocket.m = lock;
-	mActiveSockets.push_back(activeSocket);
+	const int32_t client = storeClient->id();
+	Socket* const socket = storeClient->handle();
+	Mutex* const lock = storeClient->clientLock();
+
+	// The workers only need to know about the client if the responses are sent back to the host
+	if (mServerResponses) {
+		Log::Write(Log::Info, "Notifying all child-processes that SOCKET(%p) has connected", socket);
+		ESHeader header;
+		header.type = REQ_NEW_CONNECTION;
+		header.client = client;
+		const ESErrorCode err = sendToAll(&header);
+		if (isError(err)) {
+			return err;
+		}
+		mActiveSockets.add(storeClient);
+		return ESERR_NO_ERROR;
+	}
 
 	const uint32_t numProcesses = mProcesses.size() + 1;
 	Log::Write(Log::Info, "Notifying %d child-processes that SOCKET(%p) has connected", numProcesses, socket);
 	for (uint32_t i = 1u; i < numProcesses; ++i) {
-		auto process = mProcesses[i - 1u];
+		auto process = mWriters[i - 1u];
 
 		// Start by sharing the socket and the mutex with the current child-process
-		ESErrorCode err = ShareSocketAndMutex(socket, lock, process->process());
+		ESErrorCode err = process->share(client, socket, lock);
 
 		// If sharing did not work then try to restart the process and try again
 		if (isError(err)) {
@@ -103,35 +129,25 @@ ESErrorCode IpcHost::onClientConnected(Socket* socket, Mutex* lock) {
 			}
 
 			// Start by sharing the socket and the mutex with the current child-process
-			err = ShareSocketAndMutex(socket, lock, process->process());
+			err = process->share(client, socket, lock);
 			if (isError(err)) {
 				return err;
 			}
 		}
 	}
 
+	mActiveSockets.add(storeClient);
 	return ESERR_NO_ERROR;
 }
 
-ESErrorCode IpcHost::onClientDisconnected(Socket* socket) {
-	if (socket == nullptr) {
-		return ESERR_INVALID_ARGUMENT;
-	}
-
-	Log::Write(Log::Info, "Notifying all child-processes that SOCKET(%p) has disconnected", socket);
-	auto it = mActiveSockets.begin();
-	const auto end = mActiveSockets.end();
-	for (; it != end; ++it) {
-		if (it->socket == socket) {
-			mActiveSockets.erase(it);
-			break;
-		}
-	}
+ESErrorCode IpcHost::onClientDisconnected(int32_t client) {
+	Log::Write(Log::Info, "Notifying all child-processes that client %d has disconnected", client);
+	mActiveSockets.remove(client);
 
 	// Message header for new connections
 	ESHeader header;
 	header.type = REQ_CLOSED_CONNECTION;
-	header.client = socket->GetHandle();
+	header.client = client;
 	sendToAll(&header);
 	return ESERR_NO_ERROR;
 }
@@ -144,15 +160,17 @@ ProcessID IpcHost::workerId(const char* str, uint32_t length) const {
 	return ProcessID((uint32_t) (hash % mProcesses.size()) + 1);
 }
 
-IpcChild* IpcHost::tryRestartWorker(ProcessID id) {
+IpcWriter* IpcHost::tryRestartWorker(ProcessID id) {
 	if (!workerExists(id))
 		return nullptr;
 
 	// Destroy the worker process
-	const auto idx = id.AsIndex();
-	auto process = mProcesses[idx];
-	delete process;
-	mProcesses[idx] = nullptr;
+	destroyWorker(id.AsIndex());
+
+	// The requests that were sent to the worker are lost, and the clients might be waiting for them to complete
+	if (mCompletions) {
+		mActiveSockets.forgetRequests();
+	}
 
 	// Create it again
 	return createProcess(id);
@@ -161,8 +179,8 @@ IpcChild* IpcHost::tryRestartWorker(ProcessID id) {
 ESErrorCode IpcHost::sendToAll(const ESHeader* header) {
 	ESErrorCode error = ESERR_NO_ERROR;
 	// Send message to all processes
-	for (auto process : mProcesses) {
-		error = process->sendTo(header);
+	for (auto writer : mWriters) {
+		error = writer->send((const char*) header, sizeof(ESHeader));
 		if (isError(error)) {
 			return error;
 		}
@@ -170,12 +188,32 @@ ESErrorCode IpcHost::sendToAll(const ESHeader* header) {
 	return error;
 }
 
-IpcChild* IpcHost::createProcess() {
+void IpcHost::destroyWorker(uint32_t index) {
+	auto writer = mWriters[index];
+	if (writer != nullptr) {
+		writer->stop();
+		delete writer;
+		mWriters[index] = nullptr;
+	}
+
+	auto reader = mReaders[index];
+	if (reader != nullptr) {
+		reader->stop();
+		delete reader;
+		mReaders[index] = nullptr;
+	}
+
+	auto process = mProcesses[index];
+	delete process;
+	mProcesses[index] = nullptr;
+}
+
+IpcWriter* IpcHost::createProcess() {
 	const auto id = ProcessID(mProcesses.size() + 1);
 	return createProcess(id);
 }
 
-IpcChild* IpcHost::createProcess(ProcessID id) {
+IpcWriter* IpcHost::createProcess(ProcessID id) {
 	static const Path command = Path::GetWorkingDirectory() + Path(string("everstore-worker"));
 
 	// Start the worker process
@@ -190,12 +228,33 @@ IpcChild* IpcHost::createProcess(ProcessID id) {
 		return nullptr;
 	}
 	auto const child = new IpcChild(id, process);
-	if (mProcesses.size() < id.AsIndex()) {
+	if (isError(child->createRing(mRingSize))) {
+		Log::Write(Log::Error, "Failed to send the shared memory ring to child process");
+		delete child;
+		return nullptr;
+	}
+	IpcReader* reader = nullptr;
+	if (mCompletions) {
+		if (isError(child->createResponseRing(mRingSize))) {
+			Log::Write(Log::Error, "Failed to send the shared memory ring for responses to child process");
+			delete child;
+			return nullptr;
+		}
+		reader = new IpcReader(child, &mActiveSockets);
+		reader->start();
+	}
+	auto const writer = new IpcWriter(child);
+	writer->start();
+	if (mProcesses.size() > id.AsIndex()) {
 		mProcesses[id.AsIndex()] = child;
+		mWriters[id.AsIndex()] = writer;
+		mReaders[id.AsIndex()] = reader;
 	} else {
 		mProcesses.push_back(child);
+		mWriters.push_back(writer);
+		mReaders.push_back(reader);
 	}
-	return child;
+	return writer;
 }
 
 bool IpcHost::workerExists(ProcessID id) {
@@ -206,34 +265,3 @@ bool IpcHost::workerExists(ProcessID id) {
 	auto processes = mProcesses.size();
 	return processes > worker;
 }
-
-ESErrorCode IpcHost::ShareSocketAndMutex(Socket* socket, Mutex* lock, Process* process) {
-	if (socket == nullptr || lock == nullptr || process == nullptr) {
-		return ESERR_INVALID_ARGUMENT;
-	}
-
-	ESHeader header;
-	header.type = REQ_NEW_CONNECTION;
-	header.client = socket->GetHandle();
-	if (process->Write((char*) &header, sizeof(header)) == 0)
-		return ESERR_PIPE_WRITE;
-
-	// Start by sharing the socket and the mutex with the current child-process
-	ESErrorCode err = socket->ShareWithProcess(process);
-	if (isError(err)) {
-		Log::Write(Log::Error,
-		           "An error occurred when sharing socket with client %d. Trying to restart the process. Reason: %s (%d)",
-		           process->GetID(), parseErrorCode(err), err);
-		return err;
-	} else {
-		err = lock->ShareWith(process);
-		if (isError(err)) {
-			Log::Write(Log::Error,
-			           "An error occurred when sharing mutex with client %d. Trying to restart the process. Reason: %s (%d)",
-			           process->GetID(), parseErrorCode(err), err);
-			return err;
-		}
-	}
-
-	return ESERR_NO_ERROR;
-}
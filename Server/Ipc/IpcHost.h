@@ -3,18 +3,18 @@
 
 #include "../../Shared/Config.h"
 #include "../../Shared/Ipc/IpcChild.h"
+#include "IpcWriter.h"
+#include "IpcReader.h"
+#include "ActiveSockets.h"
 #include "../../Shared/File/Path.hpp"
 
-struct ActiveSocket
-{
-	Socket* socket;
-	Mutex* m;
-};
+class StoreClient;
 
 class IpcHost
 {
 public:
-	IpcHost(const Path& rootDir, const Path& configPath, uint32_t maxBufferSize);
+	IpcHost(const Path& rootDir, const Path& configPath, uint32_t maxBufferSize, uint32_t ringSize,
+	        bool serverResponses, bool completions);
 
 	~IpcHost() = default;
 
@@ -30,24 +30,24 @@ public:
 	// Add a new worker managed by this host
 	ESErrorCode addWorker();
 
-	// Method called when a client is connected 
-	ESErrorCode onClientConnected(Socket* socket, Mutex* lock);
+	// Method called when a client is connected. The id of the client is never reused by another client
+	ESErrorCode onClientConnected(StoreClient* client);
 
-	// Method called when a client is disconnected 
-	ESErrorCode onClientDisconnected(Socket* socket);
+	// Method called when a client is disconnected. The socket can be deleted as soon as this returns
+	ESErrorCode onClientDisconnected(int32_t client);
 
 	// Retrieves a child-process id based on a string with a given length
 	ProcessID workerId(const char* str, uint32_t length) const;
 
 private:
 	// Try to restart the IPC client
-	IpcChild* tryRestartWorker(ProcessID id);
+	IpcWriter* tryRestartWorker(ProcessID id);
 
 	// Create a new process instance
-	IpcChild* createProcess();
+	IpcWriter* createProcess();
 
 	// Create a new process instance
-	IpcChild* createProcess(ProcessID id);
+	IpcWriter* createProcess(ProcessID id);
 
 	// Check to see if the supplied worker exists
 	bool workerExists(ProcessID id);
@@ -55,15 +55,32 @@ private:
 	// Send a message over the IPC pipe
 	ESErrorCode sendToAll(const ESHeader* header);
 
-	ESErrorCode ShareSocketAndMutex(Socket* socket, Mutex* lock, Process* process);
+	// Stop and delete the worker with the supplied index
+	void destroyWorker(uint32_t index);
 
 private:
 	const Path mRootDir;
 	const Path mConfigPath;
 	const uint32_t mMaxBufferSize;
 
+	// The size of the shared memory ring used for sending requests to each worker (0 = disabled)
+	const uint32_t mRingSize;
+
+	// Are the responses sent back to the host, instead of sharing the client sockets with the workers
+	const bool mServerResponses;
+
+	// Are the workers telling the host when the requests are completed, even if the responses are not sent back
+	const bool mCompletions;
+
 	vector<IpcChild*> mProcesses;
-	vector<ActiveSocket> mActiveSockets;
+
+	// The thread sending the messages for each worker. Same index as the process
+	vector<IpcWriter*> mWriters;
+
+	// The thread writing the responses from each worker to the clients, if the responses or the completed requests
+	// are sent back to the host. Same index as the process
+	vector<IpcReader*> mReaders;
+	ActiveSockets mActiveSockets;
 };
 
 #endif
@@ -0,0 +1,112 @@
+#include "IpcReader.h"
+#include "../../Shared/Log/Log.hpp"
+
+constexpr uint32_t IpcReader::MaxBatchSize;
+constexpr uint32_t IpcReader::MaxBatchBytes;
+constexpr uint32_t IpcReader::WaitTimeoutMicros;
+
+IpcReader::IpcReader(IpcChild* child, ActiveSockets* sockets)
+		: mChild(child), mSockets(sockets), mRunning(false), mResponsesSent(0), mWrites(0) {
+	mResponses.reserve(MaxBatchSize);
+	mParts.reserve(MaxBatchSize);
+}
+
+IpcReader::~IpcReader() {
+	stop();
+}
+
+void IpcReader::start() {
+	mRunning = true;
+	mThread = thread(&IpcReader::run, this);
+}
+
+void IpcReader::stop() {
+	if (mRunning.exchange(false)) {
+		mThread.join();
+		Log::Write(Log::Info, "IpcReader(%p) | Sent %llu responses from worker %d with %llu writes", this,
+		           (unsigned long long) mResponsesSent, mChild->id().value, (unsigned long long) mWrites);
+	}
+}
+
+void IpcReader::run() {
+	Log::Write(Log::Info, "IpcReader(%p) | Starting up thread for worker %d", this, mChild->id().value);
+
+	while (mRunning.load()) {
+		if (!mChild->waitForResponse(WaitTimeoutMicros)) {
+			continue;
+		}
+
+		const bool connected = readBatch();
+		writeBatch();
+		if (!connected) {
+			// The server restarts the worker when it's noticed
+			Log::Write(Log::Error, "IpcReader(%p) | Worker %d is gone", this, mChild->id().value);
+			break;
+		}
+	}
+
+	Log::Write(Log::Info, "IpcReader(%p) | Shutting down thread for worker %d", this, mChild->id().value);
+}
+
+bool IpcReader::readBatch() {
+	mResponses.clear();
+	mBytes.clear();
+	bool last = true;
+	do {
+		IpcResponse header;
+		if (mChild->readResponse((char*) &header, sizeof(header)) != sizeof(header)) {
+			return false;
+		}
+
+		Response response;
+		response.client = header.client;
+		response.offset = mBytes.size();
+		response.size = header.size;
+		response.completed = header.completed;
+		mBytes.resize(mBytes.size() + header.size);
+		if (header.size > 0 && mChild->readResponse(&mBytes[response.offset], header.size) != (int32_t) header.size) {
+			return false;
+		}
+		mResponses.push_back(response);
+		last = header.last != 0;
+
+		// The rest of a response is always read, so that no other response is written to the client in between
+	} while (!last ||
+	         (mResponses.size() < MaxBatchSize && mBytes.size() < MaxBatchBytes && mChild->waitForResponse(0)));
+	return true;
+}
+
+void IpcReader::writeBatch() {
+	// Send the responses to each client, in the order they were read, with one write
+	const uint32_t count = mResponses.size();
+	for (uint32_t i = 0; i < count; ++i) {
+		const int32_t client = mResponses[i].client;
+		if (mResponses[i].size == UINT32_MAX) {
+			continue;
+		}
+
+		mParts.clear();
+		uint32_t completed = 0;
+		for (uint32_t j = i; j < count; ++j) {
+			Response& response = mResponses[j];
+			if (response.client == client && response.size != UINT32_MAX) {
+				if (response.size > 0) {
+					mParts.push_back({mBytes.data() + response.offset, response.size});
+				}
+				completed += response.completed;
+				response.size = UINT32_MAX;
+			}
+		}
+
+		// The client might have disconnected after the worker sent the response
+		const ESErrorCode err = mSockets->send(client, mParts.data(), mParts.size(), completed);
+		if (err == ESERR_SOCKET_SEND) {
+			Log::Write(Log::Warn, "IpcReader(%p) | Failed to send %d responses to client %d", this,
+			           (uint32_t) mParts.size(), client);
+		}
+		if (!mParts.empty()) {
+			mResponsesSent += mParts.size();
+			mWrites++;
+		}
+	}
+}
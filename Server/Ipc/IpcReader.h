@@ -0,0 +1,71 @@
+#ifndef _EVERSTORE_IPC_READER_H_
+#define _EVERSTORE_IPC_READER_H_
+
+#include "../../Shared/Ipc/IpcChild.h"
+#include "ActiveSockets.h"
+
+//
+// Reads the responses sent back by a worker from a thread of its own and writes them to the clients. All responses
+// that have arrived are read at once, and the responses to the same client are written with one system call. The
+// clients are told how many of their requests are completed after the responses are written
+class IpcReader
+{
+public:
+	// The maximum number of responses read before they are written to the clients. A response that's split up into
+	// many parts is always read completely
+	static constexpr uint32_t MaxBatchSize = 64;
+
+	// The responses are written to the clients when this many bytes are read, even if more responses have arrived
+	static constexpr uint32_t MaxBatchBytes = 256 * 1024;
+
+	// How long the thread waits for responses before it checks if it's stopped
+	static constexpr uint32_t WaitTimeoutMicros = 100000;
+
+	IpcReader(IpcChild* child, ActiveSockets* sockets);
+
+	~IpcReader();
+
+	// Start the thread
+	void start();
+
+	// Stop the thread. Responses that are not read yet are never sent
+	void stop();
+
+private:
+	struct Response
+	{
+		int32_t client;
+		uint32_t offset;
+		uint32_t size;
+		uint32_t completed;
+	};
+
+	// Read and send the responses until the thread is stopped or the worker is gone
+	void run();
+
+	//
+	// Read the responses that have arrived
+	//
+	// \return false if the worker is gone
+	bool readBatch();
+
+	// Send the responses that are read to the clients
+	void writeBatch();
+
+private:
+	IpcChild* const mChild;
+	ActiveSockets* const mSockets;
+	atomic_bool mRunning;
+	thread mThread;
+
+	// The responses in the current batch. The bytes of all responses are put after each other
+	vector<Response> mResponses;
+	vector<char> mBytes;
+	vector<SocketPart> mParts;
+
+	// Statistics
+	uint64_t mResponsesSent;
+	uint64_t mWrites;
+};
+
+#endif
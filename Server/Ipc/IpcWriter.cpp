@@ -0,0 +1,186 @@
+#include "IpcWriter.h"
+#include "../../Shared/Log/Log.hpp"
+
+constexpr uint32_t IpcWriter::MaxBatchSize;
+constexpr uint32_t IpcWriter::WaitTimeoutMillis;
+
+IpcWriter::IpcWriter(IpcChild* child)
+		: mChild(child), mRunning(false), mFailed(false), mSleeping(false), mSharedMessage(nullptr),
+		  mShareResult(ESERR_NO_ERROR), mMessages(0), mWrites(0) {
+	mBatch.reserve(MaxBatchSize);
+	mParts.reserve(MaxBatchSize);
+}
+
+IpcWriter::~IpcWriter() {
+	stop();
+
+	// Messages queued after the thread is stopped are never sent
+	IpcMessage* message;
+	while ((message = mQueue.pop()) != nullptr) {
+		if (message->socket == nullptr) {
+			free(message);
+		}
+	}
+}
+
+void IpcWriter::start() {
+	mRunning = true;
+	mThread = thread(&IpcWriter::run, this);
+}
+
+void IpcWriter::stop() {
+	if (mRunning.exchange(false)) {
+		wakeUp();
+		mThread.join();
+		Log::Write(Log::Info, "IpcWriter(%p) | Sent %llu messages to worker %d with %llu writes", this,
+		           (unsigned long long) mMessages, mChild->id().value, (unsigned long long) mWrites);
+	}
+}
+
+ESErrorCode IpcWriter::send(const char* bytes, uint32_t size) {
+	if (mFailed.load()) {
+		return ESERR_PIPE_WRITE;
+	}
+
+	auto const message = (IpcMessage*) malloc(sizeof(IpcMessage) + size);
+	message->socket = nullptr;
+	message->lock = nullptr;
+	message->client = 0;
+	message->size = size;
+	memcpy(message->bytes(), bytes, size);
+	mQueue.push(message);
+	wakeUp();
+	return ESERR_NO_ERROR;
+}
+
+ESErrorCode IpcWriter::share(int32_t client, Socket* socket, Mutex* lock) {
+	if (mFailed.load() || !mRunning.load()) {
+		return ESERR_PIPE_WRITE;
+	}
+
+	// The message is owned by this thread, so it's not deleted by the writer. The writer sends all queued messages
+	// before it's stopped, so the message is always sent
+	IpcMessage message;
+	message.socket = socket;
+	message.lock = lock;
+	message.client = client;
+	message.size = 0;
+	mQueue.push(&message);
+	wakeUp();
+
+	unique_lock<mutex> l(mShareLock);
+	mShared.wait(l, [this, &message]() { return mSharedMessage == &message; });
+	mSharedMessage = nullptr;
+	return mShareResult;
+}
+
+void IpcWriter::wakeUp() {
+	if (mSleeping.load()) {
+		lock_guard<mutex> l(mWakeLock);
+		mWakeUp.notify_one();
+	}
+}
+
+void IpcWriter::run() {
+	Log::Write(Log::Info, "IpcWriter(%p) | Starting up thread for worker %d", this, mChild->id().value);
+
+	while (true) {
+		// Check if stopped before the queue, so that messages queued before stop was called are sent
+		const bool running = mRunning.load();
+		if (writeBatch() > 0) {
+			continue;
+		}
+		if (!running) {
+			break;
+		}
+
+		// The queue is checked again after going to sleep, so that a message queued in between is not missed
+		unique_lock<mutex> l(mWakeLock);
+		mSleeping = true;
+		if (mQueue.empty() && mRunning.load()) {
+			mWakeUp.wait_for(l, chrono::milliseconds(WaitTimeoutMillis));
+		}
+		mSleeping = false;
+	}
+
+	Log::Write(Log::Info, "IpcWriter(%p) | Shutting down thread for worker %d", this, mChild->id().value);
+}
+
+uint32_t IpcWriter::writeBatch() {
+	uint32_t count = 0;
+	IpcMessage* message;
+	while (count < MaxBatchSize && (message = mQueue.pop()) != nullptr) {
+		count++;
+		if (message->socket == nullptr) {
+			mBatch.push_back(message);
+			mParts.push_back({message->bytes(), message->size});
+			continue;
+		}
+
+		// The messages before the socket must be sent first
+		flush();
+		const ESErrorCode err = mFailed.load() ? ESERR_PIPE_WRITE : shareSocketAndMutex(message);
+		lock_guard<mutex> l(mShareLock);
+		mShareResult = err;
+		mSharedMessage = message;
+		mShared.notify_all();
+	}
+	flush();
+	return count;
+}
+
+void IpcWriter::flush() {
+	if (mBatch.empty()) {
+		return;
+	}
+
+	// The messages are dropped if the worker has failed. The server restarts the worker when it's noticed
+	if (!mFailed.load()) {
+		const ESErrorCode err = mChild->sendTo(mParts.data(), mParts.size());
+		if (isError(err)) {
+			Log::Write(Log::Error, "IpcWriter(%p) | Failed to send %d messages to worker %d. Reason: %s (%d)", this,
+			           (uint32_t) mParts.size(), mChild->id().value, parseErrorCode(err), err);
+			mFailed = true;
+		} else {
+			mMessages += mBatch.size();
+			mWrites++;
+		}
+	}
+
+	for (auto message : mBatch) {
+		free(message);
+	}
+	mBatch.clear();
+	mParts.clear();
+}
+
+ESErrorCode IpcWriter::shareSocketAndMutex(IpcMessage* message) {
+	Socket* const socket = message->socket;
+	Mutex* const lock = message->lock;
+
+	// The header is sent the same way as the requests, so that the worker attaches the socket before the requests
+	// from the client are read. The socket and the mutex are always sent over the pipe
+	ESHeader header;
+	header.type = REQ_NEW_CONNECTION;
+	header.client = message->client;
+	if (isError(mChild->sendTo(&header)))
+		return ESERR_PIPE_WRITE;
+
+	Process* const process = mChild->process();
+	ESErrorCode err = socket->ShareWithProcess(process);
+	if (isError(err)) {
+		Log::Write(Log::Error,
+		           "An error occurred when sharing socket with client %d. Trying to restart the process. Reason: %s (%d)",
+		           process->GetID(), parseErrorCode(err), err);
+		return err;
+	}
+
+	err = lock->ShareWith(process);
+	if (isError(err)) {
+		Log::Write(Log::Error,
+		           "An error occurred when sharing mutex with client %d. Trying to restart the process. Reason: %s (%d)",
+		           process->GetID(), parseErrorCode(err), err);
+		return err;
+	}
+	return ESERR_NO_ERROR;
+}
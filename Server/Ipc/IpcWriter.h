@@ -0,0 +1,106 @@
+#ifndef _EVERSTORE_IPC_WRITER_H_
+#define _EVERSTORE_IPC_WRITER_H_
+
+#include "../../Shared/Ipc/IpcChild.h"
+#include "../../Shared/MpscQueue.h"
+#include "../../Shared/Socket/Socket.hpp"
+#include <condition_variable>
+
+//
+// A message waiting to be sent to a worker. The bytes are stored directly after the message
+struct IpcMessage : MpscNode
+{
+	// Set if the message shares a client socket and its mutex with the worker
+	Socket* socket;
+	Mutex* lock;
+	int32_t client;
+
+	// The size of the bytes
+	uint32_t size;
+
+	inline char* bytes() { return (char*) (this + 1); }
+};
+
+//
+// Sends the messages for a worker from a thread of its own. The server threads put the messages in a lock-free queue
+// and the writer sends all messages that have been queued up with one write
+class IpcWriter
+{
+public:
+	// The maximum number of messages sent with one write
+	static constexpr uint32_t MaxBatchSize = 64;
+
+	// How long the thread waits for messages before it checks if it's stopped
+	static constexpr uint32_t WaitTimeoutMillis = 100;
+
+	explicit IpcWriter(IpcChild* child);
+
+	~IpcWriter();
+
+	// Start the thread
+	void start();
+
+	// Stop the thread after all queued messages are sent
+	void stop();
+
+	//
+	// Queue a copy of the supplied bytes. Can be called by any thread
+	//
+	// \return ESERR_PIPE_WRITE if a previous message could not be sent to the worker
+	ESErrorCode send(const char* bytes, uint32_t size);
+
+	//
+	// Share the socket and mutex of the supplied client with the worker. They are sent in order with the other
+	// messages, so the requests from the client are never sent before the socket. Waits until they are sent
+	ESErrorCode share(int32_t client, Socket* socket, Mutex* lock);
+
+	// Has a message failed to be sent to the worker
+	inline bool failed() const { return mFailed.load(); }
+
+private:
+	// Send the messages until the thread is stopped
+	void run();
+
+	//
+	// Send the messages that are queued up
+	//
+	// \return How many messages were sent
+	uint32_t writeBatch();
+
+	// Send the messages collected for the current batch
+	void flush();
+
+	// Send the socket and the mutex in the supplied message
+	ESErrorCode shareSocketAndMutex(IpcMessage* message);
+
+	// Wake up the thread if it's waiting for messages
+	void wakeUp();
+
+private:
+	IpcChild* const mChild;
+	MpscQueue<IpcMessage> mQueue;
+	atomic_bool mRunning;
+	atomic_bool mFailed;
+	thread mThread;
+
+	// Used when the thread waits for messages
+	mutex mWakeLock;
+	condition_variable mWakeUp;
+	atomic_bool mSleeping;
+
+	// Used when waiting for a socket to be shared
+	mutex mShareLock;
+	condition_variable mShared;
+	IpcMessage* mSharedMessage;
+	ESErrorCode mShareResult;
+
+	// The messages in the current batch
+	vector<IpcMessage*> mBatch;
+	vector<SharedRing::Part> mParts;
+
+	// Statistics
+	uint64_t mMessages;
+	uint64_t mWrites;
+};
+
+#endif
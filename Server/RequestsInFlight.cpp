@@ -0,0 +1,46 @@
+#include "RequestsInFlight.h"
+
+RequestsInFlight::RequestsInFlight(uint32_t max)
+		: mMax(max), mInFlight(0), mPaused(false) {
+}
+
+bool RequestsInFlight::add(const ESHeader* header) {
+	if (mMax == 0 || (header->properties & ESPROP_MULTIPART) != 0) {
+		return false;
+	}
+	mInFlight++;
+	return true;
+}
+
+bool RequestsInFlight::full() const {
+	return mMax > 0 && mInFlight.load() >= (int32_t) mMax;
+}
+
+bool RequestsInFlight::pause() {
+	mPaused = true;
+
+	// A request might have completed before the client was marked as paused
+	if (!full() && mPaused.exchange(false)) {
+		return false;
+	}
+	return true;
+}
+
+bool RequestsInFlight::complete(uint32_t count) {
+	// Never below zero, since the requests are forgotten when a worker is restarted
+	int32_t inFlight = mInFlight.load();
+	int32_t next;
+	do {
+		next = inFlight > (int32_t) count ? inFlight - (int32_t) count : 0;
+	} while (!mInFlight.compare_exchange_weak(inFlight, next));
+	return resume();
+}
+
+bool RequestsInFlight::lose() {
+	mInFlight = 0;
+	return resume();
+}
+
+bool RequestsInFlight::resume() {
+	return mPaused.load() && !full() && mPaused.exchange(false);
+}
@@ -0,0 +1,59 @@
+#ifndef _EVERSTORE_REQUESTS_IN_FLIGHT_H_
+#define _EVERSTORE_REQUESTS_IN_FLIGHT_H_
+
+#include "../Shared/everstore.h"
+
+//
+// The requests from a client that are sent to the workers without a response yet. The client waits for some of them
+// to complete when there are too many. Requests are added by the I/O thread and completed by any thread
+class RequestsInFlight
+{
+public:
+	// \param max How many requests that can be in flight at the same time (0 = no limit, nothing is counted)
+	explicit RequestsInFlight(uint32_t max);
+
+	//
+	// Count the supplied request before it's sent, since the worker might complete it before the send returns. A
+	// request that's sent in many parts is counted once, when the last part is sent
+	//
+	// \return true if the request is counted
+	bool add(const ESHeader* header);
+
+	// Are as many requests in flight as allowed
+	bool full() const;
+
+	//
+	// Mark the client as waiting for its requests to complete
+	//
+	// \return false if enough requests were completed in the meantime, so that the client can continue right away
+	bool pause();
+
+	// Is the client waiting for its requests to complete
+	inline bool paused() const { return mPaused.load(); }
+
+	//
+	// Called when the supplied number of requests are completed
+	//
+	// \return true if the client was paused and can continue now. Only returned once for each pause
+	bool complete(uint32_t count);
+
+	//
+	// Called when the requests in flight will never complete
+	//
+	// \return true if the client was paused and can continue now
+	bool lose();
+
+	// The number of requests in flight
+	inline int32_t size() const { return mInFlight.load(); }
+
+private:
+	// Stop waiting if enough requests are completed
+	bool resume();
+
+private:
+	const uint32_t mMax;
+	atomic<int32_t> mInFlight;
+	atomic_bool mPaused;
+};
+
+#endif
@@ -2,6 +2,13 @@
 #include "Auth/FixedUserAuthenticator.hpp"
 #include "../Shared/File/Path.hpp"
 #include "../Shared/Socket/Socket.hpp"
+#include "../Shared/Database/JournalConverter.hpp"
+
+namespace
+{
+	// Exists while a store is using the journals
+	const char* const ApplicationLockPath = "everstore.lock";
+}
 
 Store::Store(const Config& config)
 		: mConfig(config), mRunning(false), mHost(nullptr), mServer(nullptr), mAuthenticator(nullptr) {
@@ -28,8 +35,7 @@ ESErrorCode Store::start() {
 	prepareDirectories();
 
 	// Make sure that we are not already running the everstore
-	const auto applicationLockPath = "everstore.lock";
-	if (FileLock::exists(applicationLockPath)) {
+	if (FileLock::exists(ApplicationLockPath)) {
 		return ESERR_STORE_ALREADY_RUNNING;
 	}
 
@@ -45,7 +51,7 @@ ESErrorCode Store::start() {
 	}
 
 	// Lock the application
-	FileLock lock(applicationLockPath);
+	FileLock lock(ApplicationLockPath);
 	lock.addRef();
 
 	// Listen for any incomming connections
@@ -80,7 +86,8 @@ ESErrorCode Store::initialize() {
 	mAuthenticator = new FixedUserAuthenticator(string("admin"), string("passwd"));
 
 	// Create host
-	mHost = new IpcHost(mConfig.rootDir, mConfig.configPath, mConfig.maxBufferSize);
+	mHost = new IpcHost(mConfig.rootDir, mConfig.configPath, mConfig.maxBufferSize, mConfig.ipcRingSize,
+	                    mConfig.serverResponses != 0, mConfig.maxPipelinedRequests > 0);
 
 	// Create worker processes
 	ESErrorCode err;
@@ -90,7 +97,8 @@ ESErrorCode Store::initialize() {
 	}
 
 	// Listen for incoming database connections
-	mServer = new StoreServer(mConfig.port, mConfig.maxConnections, mConfig.maxBufferSize, mHost, mAuthenticator);
+	mServer = new StoreServer(mConfig.port, mConfig.maxConnections, mConfig.maxBufferSize, mConfig.ioThreads,
+	                          mConfig.maxPipelinedRequests, mHost, mAuthenticator);
 	err = mServer->listen();
 	if (isError(err))
 		return err;
@@ -115,23 +123,69 @@ void Store::release() {
 }
 
 bool Store::performConsistencyCheck() {
+	const Path journalDir = mConfig.rootDir + mConfig.journalDir;
+
+	// Replay the recovery logs left behind by the workers
+	auto logs = FileUtils::findFilesEndingWith(journalDir.value, RecoveryLog::Suffix);
+	for (auto& log : logs) {
+		if (!RecoveryLog::replay(Path(log), journalDir)) {
+			return false;
+		}
+	}
+
+	// Lock files are left behind by older versions of the server. They are named "<journal>.log.lock" or
+	// "<journal>.log.<worker>.lock"
 	const string lockSuffix(".lock");
-	auto files = FileUtils::findFilesEndingWith((mConfig.rootDir + mConfig.journalDir).value, lockSuffix);
+	const string logSuffix(".log");
+	auto files = FileUtils::findFilesEndingWith(journalDir.value, lockSuffix);
 	for (auto& file : files) {
-		const uint32_t del = file.find_last_of('.');
-		const uint32_t del2 = file.find_last_of('.', del - 1);
-		const Path journalFile(file.substr(0, del2));
+		string journalFile = file.substr(0, file.length() - lockSuffix.length());
+		if (!StringUtils::endsWith(journalFile, logSuffix)) {
+			journalFile = journalFile.substr(0, journalFile.find_last_of('.'));
+		}
 
-		Log::Write(Log::Error, "Validating consistency for journal: %s", journalFile.value.c_str());
-		Journal j(journalFile);
+		Log::Write(Log::Info, "Validating consistency for journal: %s", journalFile.c_str());
+		Journal j((Path(journalFile)));
 		if (!j.performConsistencyCheck()) {
-			Log::Write(Log::Error, "Consistency check failed for journal: %s", journalFile.value.c_str());
+			Log::Write(Log::Error, "Consistency check failed for journal: %s", journalFile.c_str());
 			return false;
 		}
+		remove(file.c_str());
 	}
 	return true;
 }
 
+ESErrorCode Store::convertJournals() {
+	// The journals are replaced when converted, which is not allowed while a store has them open
+	if (FileLock::exists(ApplicationLockPath)) {
+		return ESERR_STORE_ALREADY_RUNNING;
+	}
+
+	// Prevent a store from starting until all journals are converted
+	FileLock lock(ApplicationLockPath);
+	lock.addRef();
+
+	// Only consistent journals can be converted
+	ESErrorCode err = ESERR_NO_ERROR;
+	if (!performConsistencyCheck()) {
+		err = ESERR_STORE_CONSISTENCY_CHECK_FAILED;
+	} else {
+		const Path journalDir = mConfig.rootDir + mConfig.journalDir;
+		auto files = FileUtils::findFilesEndingWith(journalDir.value, string(".log"));
+		for (auto& file : files) {
+			Log::Write(Log::Info, "Converting journal: %s", file.c_str());
+			err = JournalConverter::convert(Path(file));
+			if (isError(err)) {
+				Log::Write(Log::Error, "Failed to convert journal: %s", file.c_str());
+				break;
+			}
+		}
+	}
+
+	lock.release();
+	return err;
+}
+
 void Store::prepareDirectories() {
 	FileUtils::createFolder((mConfig.rootDir + mConfig.journalDir).value);
 	FileUtils::createFolder(FileUtils::getTempDirectory());
@@ -19,6 +19,10 @@ public:
 	// Stop the event store
 	void stop();
 
+	//
+	// Convert all version 1 journals into the version 2 format. Must not be done while the event store is running
+	ESErrorCode convertJournals();
+
 private:
 	//
 	// Initialize the event store
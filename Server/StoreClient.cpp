@@ -1,90 +1,153 @@
 #include "StoreClient.h"
+#include "IoThread.h"
 
-StoreClient::StoreClient(Socket* client, IpcHost* host, uint32_t maxBufferSize)
-		: mClientSocket(client), mIpcHost(host), mMaxBufferSize(maxBufferSize), mClientLock(nullptr),
-		  mRunning(true) {
+constexpr uint32_t StoreClient::IdleBufferSize;
+constexpr uint32_t StoreClient::MaxIdleBufferSize;
+
+StoreClient::StoreClient(Socket* client, int32_t id, IpcHost* host, uint32_t maxBufferSize, uint32_t maxInFlight)
+		: mClientSocket(client), mId(id), mIpcHost(host), mMaxBufferSize(maxBufferSize), mClientLock(nullptr),
+		  mBuffer(new ByteBuffer(IdleBufferSize)), mReceived(0), mRequests(maxInFlight),
+		  mIoThread(nullptr) {
 	const string mutexName = string("everstore_mutex_") + StringUtils::toString((int) mClientSocket->GetHandle());
 	mClientLock = Mutex::Create(mutexName);
 }
 
 StoreClient::~StoreClient() {
-	if (mClientSocket != nullptr) {
-		delete mClientSocket;
-		mClientSocket = nullptr;
-	}
-
+	// The mutex is named after the socket handle, so it must be removed before the handle can be reused by a new client
 	if (mClientLock != nullptr) {
 		delete mClientLock;
 		mClientLock = nullptr;
 	}
 
-	mThread.join();
+	if (mClientSocket != nullptr) {
+		delete mClientSocket;
+		mClientSocket = nullptr;
+	}
+
+	delete mBuffer;
+	mBuffer = nullptr;
 }
 
-ESErrorCode StoreClient::start() {
+ESErrorCode StoreClient::initialize() {
 	if (mClientLock == nullptr) {
 		return ESERR_CLIENT_MUTEX_FAILED;
 	}
-	mThread = thread(&StoreClient::run, this);
 	return ESERR_NO_ERROR;
 }
 
-void StoreClient::run() {
-	Log::Write(Log::Info, "StoreClient(%p) | Starting up thread", this);
+ESErrorCode StoreClient::receive() {
+	// Make room for the next header, or for the rest of the request if the header is already received. A client that
+	// waits for its requests to complete might already have complete requests in the buffer
+	uint32_t required = sizeof(ESHeader);
+	if (mReceived >= sizeof(ESHeader)) {
+		const auto header = (const ESHeader*) mBuffer->ptr();
+		required += header->size > 0 ? header->size : 0;
+	}
+	if (required <= mReceived) {
+		required = mReceived + IdleBufferSize;
+	}
+	mBuffer->reset();
+	mBuffer->ensureCapacity(required);
+
+	const auto recvBytes = mClientSocket->Receive(mBuffer->ptr() + mReceived, mBuffer->capacity() - mReceived);
+	if (recvBytes <= 0) {
+		return ESERR_SOCKET_DISCONNECTED;
+	}
+	mReceived += recvBytes;
+	return handleFrames();
+}
 
-	// Client loop. Keep running as long as the client is alive and no fatal errors has occurred.
-	ByteBuffer memory(mMaxBufferSize);
+ESErrorCode StoreClient::handleFrames() {
+	// Handle all requests that are completely received. The client might send more than one request at a time
 	ESErrorCode err = ESERR_NO_ERROR;
-	while (mRunning && !isErrorCodeFatal(err)) {
-		// Read message header. If the request header turns out to be invalid, then that means 
-		// that:
-		// 1. The client is in a bad state. Force a disconnect on the client.
-		// 2. The client has disconnected in a nice way and is marked to be stopped.
-		ESHeader* header = loadHeaderFromClient(&memory);
-		Log::Write(Log::Debug2, "StoreClient(%p) | Received message %s (%d)", this,
-		           parseRequestType(header->type), header->type, header->client);
-		if (header->type == REQ_INVALID || isInternalRequestType(header->type)) {
-			mRunning = false;
+	while (mReceived >= sizeof(ESHeader) && !isErrorCodeFatal(err) && !full()) {
+		const auto header = (const ESHeader*) mBuffer->ptr();
+
+		// Validate request. Each part of a request that's sent in many parts must fit in the buffer
+		if (header->size > (int32_t) mMaxBufferSize || !isRequestPropertiesValid(header)) {
+			return ESERR_SOCKET_DISCONNECTED;
+		}
+
+		const uint32_t frameSize = sizeof(ESHeader) + (header->size > 0 ? header->size : 0);
+		if (mReceived < frameSize) {
 			break;
 		}
 
-		// Prepare the request header and put it into the memory buffer
-		const auto workerId = header->workerId;
-		const auto requestUID = header->requestUID;
-		header->client = mClientSocket->GetHandle();
-
-		// If no worker is specified then let the host figure it out. Otherwise redirect directly to it
-		if (isRequestTypeInitiallyForHost(header->type)) {
-			Log::Write(Log::Debug, "StoreClient(%p) | Handling internal message", this);
-			err = handleRequest(header, &memory);
-		} else {
-			Log::Write(Log::Debug, "StoreClient(%p) | Sending request to ProcessID(%d)", this, workerId);
-			err = mIpcHost->send(workerId, &memory);
+		err = handleFrame(frameSize);
+		if (err == ESERR_SOCKET_DISCONNECTED) {
+			return err;
 		}
 
-		// Notify the client if the supplied request failed
-		if (IsErrorButNotFatal(err)) {
-			Log::Write(Log::Error, "StoreClient(%p) | Error occurred: %s (%d)", this, parseErrorCode(err), err);
-			err = ESERR_NO_ERROR;
+		// Move the bytes that belong to the next request to the beginning of the buffer
+		mReceived -= frameSize;
+		if (mReceived > 0) {
+			memmove(mBuffer->ptr(), mBuffer->ptr() + frameSize, mReceived);
+		}
+	}
 
-			// Reset memory
-			memory.reset();
+	// Don't keep the memory of a large request while the client is idle
+	if (mReceived == 0 && mBuffer->capacity() > MaxIdleBufferSize) {
+		delete mBuffer;
+		mBuffer = new ByteBuffer(IdleBufferSize);
+	}
+	return err;
+}
 
-			// Put the response into the memory block
-			const RequestError::Header responseHeader(requestUID, workerId);
-			const RequestError::Response response(err);
-			memory.write(&responseHeader);
-			memory.write(&response);
+ESErrorCode StoreClient::handleFrame(uint32_t frameSize) {
+	// The offset of the memory represents the size of the request when it's sent to a worker
+	mBuffer->reset();
+	mBuffer->moveForward(frameSize);
+
+	// If the request header turns out to be invalid, then that means that the client is in a bad state or that it
+	// has disconnected in a nice way. Force a disconnect on the client
+	auto const header = (ESHeader*) mBuffer->ptr();
+	Log::Write(Log::Debug2, "StoreClient(%p) | Received message %s (%d)", this, parseRequestType(header->type),
+	           header->type);
+	if (header->type == REQ_INVALID || isInternalRequestType(header->type)) {
+		return ESERR_SOCKET_DISCONNECTED;
+	}
 
-			// Send the data to the client
-			err = sendBytesToClient(&memory);
-		}
+	// Prepare the request header and put it into the memory buffer
+	const auto workerId = header->workerId;
+	const auto requestUID = header->requestUID;
+	header->client = mId;
+
+	// The request is counted before it's sent, since the worker might complete it before the send returns
+	const bool counted = mRequests.add(header);
+
+	// If no worker is specified then let the host figure it out. Otherwise redirect directly to it
+	ESErrorCode err;
+	if (isRequestTypeInitiallyForHost(header->type)) {
+		Log::Write(Log::Debug, "StoreClient(%p) | Handling internal message", this);
+		err = handleRequest(header, mBuffer);
+	} else {
+		Log::Write(Log::Debug, "StoreClient(%p) | Sending request to ProcessID(%d)", this, workerId);
+		err = mIpcHost->send(workerId, mBuffer);
 	}
 
-	Log::Write(Log::Info, "StoreClient(%p) | Shutting down thread", this);
+	// The request never reached a worker
+	if (counted && isError(err)) {
+		onRequestsCompleted(1);
+	}
+
+	// Notify the client if the supplied request failed
+	if (IsErrorButNotFatal(err)) {
+		Log::Write(Log::Error, "StoreClient(%p) | Error occurred: %s (%d)", this, parseErrorCode(err), err);
+
+		// Put the response into its own memory block, since the read buffer might contain the next request
+		ByteBuffer memory(sizeof(RequestError::Header) + sizeof(RequestError::Response));
+		const RequestError::Header responseHeader(requestUID, workerId);
+		const RequestError::Response response(err);
+		memory.write(&responseHeader);
+		memory.write(&response);
+
+		// Send the data to the client
+		err = sendBytesToClient(&memory);
+	}
 	if (isError(err)) {
 		Log::Write(Log::Error, "StoreClient(%p) | Unhandled error occurred: %s (%d)", this, parseErrorCode(err), err);
 	}
+	return err;
 }
 
 ESErrorCode StoreClient::handleRequest(const ESHeader* header, ByteBuffer* bytes) {
@@ -128,36 +191,6 @@ ESErrorCode StoreClient::handleRequest(const ESHeader* header, ByteBuffer* bytes
 	return err;
 }
 
-ESHeader* StoreClient::loadHeaderFromClient(ByteBuffer* memory) {
-	// Reset the position of the memory
-	memory->reset();
-
-	// Get a memory block for the header
-	auto const header = memory->allocate<ESHeader>();
-
-	// Read the header from client socket stream
-	if (mClientSocket->ReceiveAll((char*) header, sizeof(ESHeader)) != sizeof(ESHeader))
-		return &INVALID_HEADER;
-
-	// Validate request
-	if (header->size > (int32_t) mMaxBufferSize) {
-		return &INVALID_HEADER;
-	}
-
-	// Load the request body
-	if (header->size > 0) {
-		if (mClientSocket->ReceiveAll(memory->allocate(header->size), header->size) != header->size) {
-			return &INVALID_HEADER;
-		}
-	}
-
-	// Do not allow multipart requests yet!
-	if (header->properties != ESPROP_NONE) {
-		return &INVALID_HEADER;
-	}
-	return header;
-}
-
 ESErrorCode StoreClient::sendBytesToClient(const ByteBuffer* memory) {
 	// The current offset indicates how much memory we've written to the memory
 	const uint32_t size = memory->offset();
@@ -175,6 +208,26 @@ ESErrorCode StoreClient::sendBytesToClient(const ByteBuffer* memory) {
 	return ESERR_NO_ERROR;
 }
 
-void StoreClient::stop() {
-	mRunning = false;
+bool StoreClient::full() const {
+	return mRequests.full();
+}
+
+bool StoreClient::pause() {
+	if (!mRequests.pause()) {
+		return false;
+	}
+	Log::Write(Log::Debug, "StoreClient(%p) | Waiting for %d requests to complete", this, mRequests.size());
+	return true;
+}
+
+void StoreClient::onRequestsCompleted(uint32_t count) {
+	if (mRequests.complete(count)) {
+		mIoThread->resume(mId);
+	}
+}
+
+void StoreClient::onRequestsLost() {
+	if (mRequests.lose()) {
+		mIoThread->resume(mId);
+	}
 }
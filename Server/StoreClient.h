@@ -3,53 +3,99 @@
 
 #include "../Shared/everstore.h"
 #include "Ipc/IpcHost.h"
+#include "RequestsInFlight.h"
 
+class IoThread;
+
+//
+// A connected client. The requests are read by one of the server's I/O threads, which calls receive when bytes have
+// arrived on the socket. The client can send new requests before the responses to the previous ones have arrived. The
+// responses are matched to the requests by their requestUID, since requests sent to different workers might complete
+// in any order
 class StoreClient
 {
 public:
-	StoreClient(Socket* client, IpcHost* host, uint32_t maxBufferSize);
+	// The size of the read buffer for a client that's idle. The buffer grows when a larger request arrives
+	static constexpr uint32_t IdleBufferSize = 256;
+
+	// The read buffer is shrunk back to the idle size when it's larger than this and all requests are handled
+	static constexpr uint32_t MaxIdleBufferSize = 64 * 1024;
+
+	StoreClient(Socket* client, int32_t id, IpcHost* host, uint32_t maxBufferSize, uint32_t maxInFlight);
 
 	~StoreClient();
 
-	// Disconnect the client and stop this client thread
-	void stop();
+	// Verify that the client can be served
+	ESErrorCode initialize();
+
+	//
+	// Read the bytes that have arrived on the socket and handle every complete request. Does not block if called
+	// when the socket is readable
+	//
+	// \return ESERR_SOCKET_DISCONNECTED if the client has disconnected or sent an invalid request
+	ESErrorCode receive();
+
+	//
+	// Handle the complete requests that are already received, until the client has too many requests in flight
+	//
+	// \return ESERR_SOCKET_DISCONNECTED if the client has sent an invalid request
+	ESErrorCode handleFrames();
+
+	// Does the client have as many requests in flight as it's allowed to
+	bool full() const;
 
-	// Start the client thread
-	ESErrorCode start();
+	//
+	// Stop handling requests from the client until enough of its requests are completed. The I/O thread is asked to
+	// resume the client when that happens
+	//
+	// \return false if enough requests were completed in the meantime, so that the client can continue right away
+	bool pause();
+
+	// Is the client waiting for its requests to complete
+	inline bool paused() const { return mRequests.paused(); }
+
+	// Called when responses to the client have been sent. Can be called by any thread
+	void onRequestsCompleted(uint32_t count);
+
+	// Called when the requests in flight will never complete. Can be called by any thread
+	void onRequestsLost();
 
-	/**
-	 * Is the client running or not?
-	 *
-	 * @return <code>true</code> if this client is running
-	 */
-	inline bool running() const { return mRunning; }
+	// Set the I/O thread that serves this client
+	inline void setIoThread(IoThread* ioThread) { mIoThread = ioThread; }
 
 	inline Socket* handle() const { return mClientSocket; }
 
+	// The id that the workers know the client by. Never reused by another client, unlike the socket handle
+	inline int32_t id() const { return mId; }
+
 	inline Mutex* clientLock() const { return mClientLock; }
 
 private:
-	// 
-	// Run method
-	void run();
+	//
+	// Handle the request found at the beginning of the read buffer
+	ESErrorCode handleFrame(uint32_t frameSize);
 
 	//
 	// Handle a request that must be handled by this store client
 	ESErrorCode handleRequest(const ESHeader* header, ByteBuffer* memory);
 
-	// Load the next header form the stream - with the associated request data
-	ESHeader* loadHeaderFromClient(ByteBuffer* memory);
-
 	// Send the supplied memory block to the client.
 	ESErrorCode sendBytesToClient(const ByteBuffer* memory);
 
 private:
 	Socket* mClientSocket;
+	const int32_t mId;
 	IpcHost* mIpcHost;
 	uint32_t mMaxBufferSize;
 	Mutex* mClientLock;
-	atomic_bool mRunning;
-	thread mThread;
+
+	// Bytes received from the client, starting with the next request to be handled
+	ByteBuffer* mBuffer;
+	uint32_t mReceived;
+
+	// The requests sent to the workers without a response yet. Only counted if there's a limit
+	RequestsInFlight mRequests;
+	IoThread* mIoThread;
 };
 
 #endif
@@ -1,12 +1,15 @@
 #include "StoreServer.h"
 
-StoreServer::StoreServer(uint16_t port, uint32_t maxConnections, uint32_t maxBufferSize, IpcHost* host,
-                         Authenticator* authenticator)
-		: mPort(port), mMaxConnections(maxConnections), mMaxBufferSize(maxBufferSize), mServerSocket(nullptr),
-		  mIpcHost(host), mAuthenticator(authenticator) {
+StoreServer::StoreServer(uint16_t port, uint32_t maxConnections, uint32_t maxBufferSize, uint32_t ioThreads,
+                         uint32_t maxPipelinedRequests, IpcHost* host, Authenticator* authenticator)
+		: mPort(port), mMaxConnections(maxConnections), mMaxBufferSize(maxBufferSize),
+		  mNumIoThreads(ioThreads > 0 ? ioThreads : 1), mMaxPipelinedRequests(maxPipelinedRequests),
+		  mServerSocket(nullptr), mIpcHost(host),
+		  mAuthenticator(authenticator), mNextClientId(1) {
 }
 
 StoreServer::~StoreServer() {
+	disconnectAllClients();
 	if (mServerSocket != nullptr) {
 		delete mServerSocket;
 		mServerSocket = nullptr;
@@ -18,12 +21,22 @@ ESErrorCode StoreServer::listen() {
 	if (mServerSocket == nullptr)
 		return ESERR_SOCKET_CONFIGURE;
 
-	const auto err = mServerSocket->Listen(Port(mPort), mMaxConnections);
+	auto err = mServerSocket->Listen(Port(mPort), mMaxConnections);
 	if (isError(err)) {
 		delete mServerSocket;
 		mServerSocket = nullptr;
 		return err;
 	}
+
+	Log::Write(Log::Info, "StoreServer(%p) | Starting %d I/O threads", this, mNumIoThreads);
+	for (uint32_t i = 0; i < mNumIoThreads; ++i) {
+		auto const ioThread = new IoThread(this);
+		mIoThreads.push_back(ioThread);
+		err = ioThread->start();
+		if (isError(err)) {
+			return err;
+		}
+	}
 	return ESERR_NO_ERROR;
 }
 
@@ -56,24 +69,40 @@ ESErrorCode StoreServer::acceptClient() {
 		return err;
 	}
 
-	// Garbage collect any client processes that's closed but not removed
-	garbageCollect();
-
-	auto const client = new StoreClient(newSocket, mIpcHost, mMaxBufferSize);
-	err = mIpcHost->onClientConnected(newSocket, client->clientLock());
+	// The id wraps around long after a client with the same id has disconnected
+	auto const client = new StoreClient(newSocket, mNextClientId, mIpcHost, mMaxBufferSize, mMaxPipelinedRequests);
+	mNextClientId = mNextClientId == INT32_MAX ? 1 : mNextClientId + 1;
+	err = client->initialize();
 	if (isError(err)) {
-		delete newSocket;
+		delete client;
 		return err;
 	}
 
-	err = client->start();
-	if (err != ESERR_NO_ERROR) {
+	{
+		lock_guard<mutex> l(mHostLock);
+		err = mIpcHost->onClientConnected(client);
+	}
+	if (isError(err)) {
 		delete client;
-		delete newSocket;
 		return err;
 	}
 
-	mClients.push_back(client);
+	// Let the thread with the fewest clients serve the new client
+	IoThread* ioThread = mIoThreads[0];
+	uint32_t fewest = ioThread->size();
+	for (auto candidate : mIoThreads) {
+		const auto size = candidate->size();
+		if (size < fewest) {
+			ioThread = candidate;
+			fewest = size;
+		}
+	}
+	err = ioThread->add(client);
+	if (isError(err)) {
+		onClientDisconnected(client);
+		delete client;
+		return err;
+	}
 	return ESERR_NO_ERROR;
 }
 
@@ -130,31 +159,14 @@ void StoreServer::close() {
 }
 
 void StoreServer::disconnectAllClients() {
-	for (auto client : mClients) {
-		client->stop();
-		delete client;
+	for (auto ioThread : mIoThreads) {
+		ioThread->stop();
+		delete ioThread;
 	}
-	mClients.clear();
+	mIoThreads.clear();
 }
 
-void StoreServer::garbageCollect() {
-	Log::Write(Log::Debug, "Trying to garbage collect closed connections");
-	// Find all clients that we can remove
-	list<list<StoreClient*>::iterator> removables;
-	auto it = mClients.begin();
-	const auto e = mClients.end();
-	for (; it != e; ++it) {
-		auto client = *it;
-		if (!client->running()) {
-			Log::Write(Log::Info, "Client %d is no longer running", client->handle()->GetHandle());
-			mIpcHost->onClientDisconnected(client->handle());
-			removables.push_back(it);
-		}
-	}
-
-	// Delete any removable clients
-	for (auto removable : removables) {
-		delete *removable;
-		mClients.erase(removable);
-	}
+void StoreServer::onClientDisconnected(StoreClient* client) {
+	lock_guard<mutex> l(mHostLock);
+	mIpcHost->onClientDisconnected(client->id());
 }
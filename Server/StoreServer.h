@@ -3,6 +3,7 @@
 
 #include "../Shared/everstore.h"
 #include "StoreClient.h"
+#include "IoThread.h"
 #include "Auth/Authenticator.h"
 #include "Ipc/IpcHost.h"
 
@@ -30,8 +31,8 @@ static_assert(sizeof(ServerConfiguration) == 3, "Expected the server configurati
 class StoreServer
 {
 public:
-	StoreServer(uint16_t port, uint32_t maxConnections, uint32_t maxBufferSize, IpcHost* host,
-	            Authenticator* authenticator);
+	StoreServer(uint16_t port, uint32_t maxConnections, uint32_t maxBufferSize, uint32_t ioThreads,
+	            uint32_t maxPipelinedRequests, IpcHost* host, Authenticator* authenticator);
 
 	~StoreServer();
 
@@ -43,26 +44,36 @@ public:
 
 	ESErrorCode authenticate(Socket* newSocket);
 
-private:
 	/**
-	 * Gracefully disconnect all clients
+	 * Notify the workers that the supplied client has disconnected. Called by the I/O thread serving the client
 	 */
-	void disconnectAllClients();
+	void onClientDisconnected(StoreClient* client);
 
+private:
 	/**
-	 * Garbage collect any running client processes. This is a controlled way to remove already closed clients
+	 * Gracefully disconnect all clients
 	 */
-	void garbageCollect();
+	void disconnectAllClients();
 
 private:
 	const uint16_t mPort;
 	const uint32_t mMaxConnections;
 	const uint32_t mMaxBufferSize;
+	const uint32_t mNumIoThreads;
+	const uint32_t mMaxPipelinedRequests;
 
 	Socket* mServerSocket;
 	IpcHost* mIpcHost;
 	Authenticator* mAuthenticator;
-	list<StoreClient*> mClients;
+
+	// The threads serving the clients. A new client is served by the thread with the fewest clients
+	vector<IoThread*> mIoThreads;
+
+	// The host is notified about connected and disconnected clients by more than one thread
+	mutex mHostLock;
+
+	// The id given to the next client
+	int32_t mNextClientId;
 };
 
 #endif
@@ -54,6 +54,22 @@ void DisplayStartupConfig(const Config& config) {
 	Log::Write(Log::Info, "port = %d", config.port);
 	Log::Write(Log::Info, "maxBufferSize = %d", config.maxBufferSize);
 	Log::Write(Log::Info, "logLevel = %d", config.logLevel);
+	Log::Write(Log::Info, "groupCommitMicros = %d", config.groupCommitMicros);
+	Log::Write(Log::Info, "groupCommitMaxBytes = %d", config.groupCommitMaxBytes);
+	Log::Write(Log::Info, "durability = %s", Durability::toString(config.durability));
+	Log::Write(Log::Info, "durabilityIntervalMillis = %d", config.durabilityIntervalMillis);
+	Log::Write(Log::Info, "journalFormat = %d", config.journalFormat);
+	Log::Write(Log::Info, "mmapReadMinBytes = %d", config.mmapReadMinBytes);
+	Log::Write(Log::Info, "maxOpenJournals = %d", config.maxOpenJournals);
+	Log::Write(Log::Info, "readerThreads = %d", config.readerThreads);
+	Log::Write(Log::Info, "ioUringEntries = %d", config.ioUringEntries);
+	Log::Write(Log::Info, "ioThreads = %d", config.ioThreads);
+	Log::Write(Log::Info, "ipcRingSize = %d", config.ipcRingSize);
+	Log::Write(Log::Info, "serverResponses = %d", config.serverResponses);
+	Log::Write(Log::Info, "maxPipelinedRequests = %d", config.maxPipelinedRequests);
+	Log::Write(Log::Info, "maxCommitSize = %d", config.maxCommitSize);
+	Log::Write(Log::Info, "transactionTimeoutMillis = %d", config.transactionTimeoutMillis);
+	Log::Write(Log::Info, "statsIntervalMillis = %d", config.statsIntervalMillis);
 }
 
 int Start(const Config& config) {
@@ -89,6 +105,27 @@ int Start(const Config& config) {
 	return 0;
 }
 
+int ConvertJournals(const Config& config) {
+	Store store(config);
+	const auto err = store.convertJournals();
+	if (isError(err)) {
+		Log::Write(Log::Error, "Failed to convert the journals: %s (%d)", parseErrorCode(err), err);
+		return 1;
+	}
+
+	Log::Write(Log::Info, "All journals are converted");
+	return 0;
+}
+
+bool HasArgument(const char* argument, int argc, char** argv) {
+	for (int i = 0; i < argc; ++i) {
+		if (strcmp(argument, argv[i]) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
 int main(int argc, char** argv) {
 	const auto rootPath = Config::getWorkingDirectory(argv[0]);
 	const auto configPath = GetConfigPath(rootPath, argc, argv);
@@ -97,6 +134,11 @@ int main(int argc, char** argv) {
 	Log::SetLogLevel(config.logLevel);
 	DisplayStartupConfig(config);
 
+	// Convert the journals instead of starting the server
+	if (HasArgument("--convert-journals", argc, argv)) {
+		return ConvertJournals(config);
+	}
+
 	// Start the server
 	const auto ret = Start(config);
 	std::flush(std::cout);
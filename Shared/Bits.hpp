@@ -25,11 +25,6 @@ struct Bits
 		 * The key used that represents for when a journal is created
 		 */
 		static const string NewJournalKey;
-
-		/**
-		 *
-		 */
-		static constexpr Type NewJournalBit = 1u;
 	};
 
 	inline static Type Set(Type value, Type bits) noexcept {
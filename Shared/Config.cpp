@@ -21,6 +21,22 @@ Config Config::readFromConfigFile(const Path& rootDir, const Path& configPath) {
 	uint32_t maxJournalLifeTime = DEFAULT_JOURNAL_GC_SECONDS;
 	uint32_t maxBufferSize = DEFAULT_MAX_DATA_SEND_SIZE;
 	uint32_t logLevel = DEFAULT_LOG_LEVEL;
+	uint32_t groupCommitMicros = DEFAULT_GROUP_COMMIT_MICROS;
+	uint32_t groupCommitMaxBytes = DEFAULT_GROUP_COMMIT_MAX_BYTES;
+	Durability::Mode durability = DEFAULT_DURABILITY;
+	uint32_t durabilityIntervalMillis = DEFAULT_DURABILITY_INTERVAL_MILLIS;
+	JournalFormat::Version journalFormat = DEFAULT_JOURNAL_FORMAT;
+	uint32_t mmapReadMinBytes = DEFAULT_MMAP_READ_MIN_BYTES;
+	uint32_t maxOpenJournals = DEFAULT_MAX_OPEN_JOURNALS;
+	uint32_t readerThreads = DEFAULT_READER_THREADS;
+	uint32_t ioUringEntries = DEFAULT_IO_URING_ENTRIES;
+	uint32_t ioThreads = DEFAULT_IO_THREADS;
+	uint32_t ipcRingSize = DEFAULT_IPC_RING_SIZE;
+	uint32_t serverResponses = DEFAULT_SERVER_RESPONSES;
+	uint32_t maxPipelinedRequests = DEFAULT_MAX_PIPELINED_REQUESTS;
+	uint32_t maxCommitSize = DEFAULT_MAX_COMMIT_SIZE;
+	uint32_t transactionTimeoutMillis = DEFAULT_TRANSACTION_TIMEOUT_MILLIS;
+	uint32_t statsIntervalMillis = DEFAULT_STATS_INTERVAL_MILLIS;
 
 	ifstream file = configPath.OpenStream();
 	if (file.is_open()) {
@@ -48,6 +64,45 @@ Config Config::readFromConfigFile(const Path& rootDir, const Path& configPath) {
 					maxBufferSize = StringUtils::toUint32(value);
 				} else if (key == string("logLevel")) {
 					logLevel = StringUtils::toUint32(value);
+				} else if (key == string("groupCommitMicros")) {
+					groupCommitMicros = StringUtils::toUint32(value);
+				} else if (key == string("groupCommitMaxBytes")) {
+					groupCommitMaxBytes = StringUtils::toUint32(value);
+				} else if (key == string("durability")) {
+					if (!Durability::parse(value, &durability)) {
+						Log::Write(Log::Warn, "Unknown durability: %s", value.c_str());
+					}
+				} else if (key == string("durabilityIntervalMillis")) {
+					durabilityIntervalMillis = StringUtils::toUint32(value);
+				} else if (key == string("journalFormat")) {
+					const auto version = StringUtils::toUint32(value);
+					if (version == JournalFormat::V1 || version == JournalFormat::V2) {
+						journalFormat = (JournalFormat::Version) version;
+					} else {
+						Log::Write(Log::Warn, "Unknown journal format: %s", value.c_str());
+					}
+				} else if (key == string("mmapReadMinBytes")) {
+					mmapReadMinBytes = StringUtils::toUint32(value);
+				} else if (key == string("maxOpenJournals")) {
+					maxOpenJournals = StringUtils::toUint32(value);
+				} else if (key == string("readerThreads")) {
+					readerThreads = StringUtils::toUint32(value);
+				} else if (key == string("ioUringEntries")) {
+					ioUringEntries = StringUtils::toUint32(value);
+				} else if (key == string("ioThreads")) {
+					ioThreads = StringUtils::toUint32(value);
+				} else if (key == string("ipcRingSize")) {
+					ipcRingSize = StringUtils::toUint32(value);
+				} else if (key == string("serverResponses")) {
+					serverResponses = StringUtils::toUint32(value);
+				} else if (key == string("maxPipelinedRequests")) {
+					maxPipelinedRequests = StringUtils::toUint32(value);
+				} else if (key == string("maxCommitSize")) {
+					maxCommitSize = StringUtils::toUint32(value);
+				} else if (key == string("transactionTimeoutMillis")) {
+					transactionTimeoutMillis = StringUtils::toUint32(value);
+				} else if (key == string("statsIntervalMillis")) {
+					statsIntervalMillis = StringUtils::toUint32(value);
 				}
 			}
 		}
@@ -55,5 +110,8 @@ Config Config::readFromConfigFile(const Path& rootDir, const Path& configPath) {
 	}
 
 	return Config(rootDir, configPath, journalDir, numWorkers, maxConnections, port, maxJournalLifeTime,
-	              maxBufferSize, logLevel);
+	              maxBufferSize, logLevel, groupCommitMicros, groupCommitMaxBytes, durability,
+	              durabilityIntervalMillis, journalFormat, mmapReadMinBytes, maxOpenJournals, readerThreads, ioUringEntries,
+	              ioThreads, ipcRingSize, serverResponses, maxPipelinedRequests, maxCommitSize,
+	              transactionTimeoutMillis, statsIntervalMillis);
 }
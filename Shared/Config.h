@@ -5,6 +5,8 @@
 #include <cinttypes>
 #include "Log/Log.hpp"
 #include "File/Path.hpp"
+#include "Database/Durability.hpp"
+#include "Database/JournalFormat.hpp"
 
 using std::string;
 
@@ -35,6 +37,63 @@ using std::string;
 // The default log level used by the server
 #define DEFAULT_LOG_LEVEL Log::Debug2
 
+// How many microseconds a worker waits for more commits before writing them to the journals (0 = disabled)
+#define DEFAULT_GROUP_COMMIT_MICROS 0
+
+// How many bytes of commits a worker can collect before the group is written to the journals (1 MB)
+#define DEFAULT_GROUP_COMMIT_MAX_BYTES 1048576
+
+// How the journals are made durable after each commit
+#define DEFAULT_DURABILITY Durability::Flush
+
+// How many milliseconds between each synchronization with the disk when using the "fdatasync-interval-ms" durability
+#define DEFAULT_DURABILITY_INTERVAL_MILLIS 1000
+
+// The group-commit window used by the "group" durability if groupCommitMicros is not set
+#define DEFAULT_DURABILITY_GROUP_MICROS 1000
+
+// The format used when new journals are created. Existing journals are always written in their own format
+#define DEFAULT_JOURNAL_FORMAT JournalFormat::V1
+
+// Journals of at least this size are memory mapped when they are read (1 MB). 0 disables memory mapping
+#define DEFAULT_MMAP_READ_MIN_BYTES 1048576
+
+// How many journals each worker keeps open. Every open journal uses up to two file handles (0 = unlimited)
+#define DEFAULT_MAX_OPEN_JOURNALS 500
+
+// How many threads each worker uses for reading large journals. Reads are done by the worker itself if 0
+#define DEFAULT_READER_THREADS 2
+
+// How many journal writes and synchronizations each worker can submit to the kernel at the same time using io_uring.
+// The journals are written one at a time if 0, or if io_uring is not supported
+#define DEFAULT_IO_URING_ENTRIES 0
+
+// How many threads the server uses for reading requests from the clients. Each thread serves many connections
+#define DEFAULT_IO_THREADS 2
+
+// How many bytes the server can queue up in shared memory for each worker (1 MB). Never less than two of the largest
+// requests. The requests are sent over the pipe if 0
+#define DEFAULT_IPC_RING_SIZE 1048576
+
+// Let the workers send the responses back to the server, which writes them to the clients, instead of sharing every
+// client socket and its mutex with the workers (1 == true)
+#define DEFAULT_SERVER_RESPONSES 0
+
+// How many requests a client can have in flight at the same time. The server stops reading from a client that has this
+// many requests without a response, until responses have been sent. There's no limit if 0
+#define DEFAULT_MAX_PIPELINED_REQUESTS 0
+
+// The largest commit that can be sent in many parts (16 MB). The events are kept by the worker until the last part
+// has arrived, and the unfinished commits from one connection can't use more than this together
+#define DEFAULT_MAX_COMMIT_SIZE 16777216
+
+// How long a transaction can be open before it expires (milliseconds). 0 means that transactions never expire
+#define DEFAULT_TRANSACTION_TIMEOUT_MILLIS 0
+
+// How often each worker logs its statistics, such as synchronizations, waiting reads, open journals and expired
+// transactions (milliseconds). The statistics are only logged when the worker stops if 0
+#define DEFAULT_STATS_INTERVAL_MILLIS 60000
+
 struct Config
 {
 	const Path rootDir;
@@ -46,13 +105,41 @@ struct Config
 	const uint32_t maxJournalLifeTime;
 	const uint32_t maxBufferSize;
 	const uint32_t logLevel;
+	const uint32_t groupCommitMicros;
+	const uint32_t groupCommitMaxBytes;
+	const Durability::Mode durability;
+	const uint32_t durabilityIntervalMillis;
+	const JournalFormat::Version journalFormat;
+	const uint32_t mmapReadMinBytes;
+	const uint32_t maxOpenJournals;
+	const uint32_t readerThreads;
+	const uint32_t ioUringEntries;
+	const uint32_t ioThreads;
+	const uint32_t ipcRingSize;
+	const uint32_t serverResponses;
+	const uint32_t maxPipelinedRequests;
+	const uint32_t maxCommitSize;
+	const uint32_t transactionTimeoutMillis;
+	const uint32_t statsIntervalMillis;
 
 	Config(const Path& rootDir, const Path& configPath, const Path& journalDir, const uint32_t numWorkers,
 	       const uint32_t maxConnections,
-	       const uint16_t port, const uint32_t maxJournalLifeTime, uint32_t maxBufferSize, uint32_t logLevel) :
+	       const uint16_t port, const uint32_t maxJournalLifeTime, uint32_t maxBufferSize, uint32_t logLevel,
+	       uint32_t groupCommitMicros, uint32_t groupCommitMaxBytes, Durability::Mode durability,
+	       uint32_t durabilityIntervalMillis, JournalFormat::Version journalFormat, uint32_t mmapReadMinBytes,
+	       uint32_t maxOpenJournals, uint32_t readerThreads, uint32_t ioUringEntries, uint32_t ioThreads,
+	       uint32_t ipcRingSize, uint32_t serverResponses, uint32_t maxPipelinedRequests,
+	       uint32_t maxCommitSize, uint32_t transactionTimeoutMillis, uint32_t statsIntervalMillis) :
 			rootDir(rootDir), configPath(configPath), journalDir(journalDir), numWorkers(numWorkers),
 			maxConnections(maxConnections), port(port), maxJournalLifeTime(maxJournalLifeTime),
-			maxBufferSize(maxBufferSize), logLevel(logLevel) {}
+			maxBufferSize(maxBufferSize), logLevel(logLevel), groupCommitMicros(groupCommitMicros),
+			groupCommitMaxBytes(groupCommitMaxBytes), durability(durability),
+			durabilityIntervalMillis(durabilityIntervalMillis), journalFormat(journalFormat),
+			mmapReadMinBytes(mmapReadMinBytes), maxOpenJournals(maxOpenJournals), readerThreads(readerThreads),
+			ioUringEntries(ioUringEntries), ioThreads(ioThreads), ipcRingSize(ipcRingSize),
+			serverResponses(serverResponses), maxPipelinedRequests(maxPipelinedRequests),
+			maxCommitSize(maxCommitSize), transactionTimeoutMillis(transactionTimeoutMillis),
+			statsIntervalMillis(statsIntervalMillis) {}
 
 	// Converts the supplied command string into a currently-working directory string
 	static Path getWorkingDirectory(char* command);
@@ -0,0 +1,37 @@
+//
+// Copyright (c) 2019 West Coast Code AB. All rights reserved.
+//
+
+#include "Crc32c.hpp"
+
+namespace
+{
+	// Reversed Castagnoli polynomial
+	const uint32_t Polynomial = 0x82F63B78u;
+
+	struct Table
+	{
+		uint32_t values[256];
+
+		Table() {
+			for (uint32_t i = 0; i < 256; ++i) {
+				uint32_t crc = i;
+				for (int j = 0; j < 8; ++j) {
+					crc = (crc >> 1u) ^ ((crc & 1u) ? Polynomial : 0u);
+				}
+				values[i] = crc;
+			}
+		}
+	};
+
+	const Table gTable;
+}
+
+uint32_t Crc32c::update(uint32_t crc, const void* data, size_t length) {
+	auto ptr = (const uint8_t*) data;
+	crc = ~crc;
+	for (size_t i = 0; i < length; ++i) {
+		crc = gTable.values[(crc ^ ptr[i]) & 0xFFu] ^ (crc >> 8u);
+	}
+	return ~crc;
+}
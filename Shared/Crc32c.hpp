@@ -0,0 +1,34 @@
+//
+// Copyright (c) 2019 West Coast Code AB. All rights reserved.
+//
+
+#ifndef EVERSTORE_CRC32C_HPP
+#define EVERSTORE_CRC32C_HPP
+
+#include <cinttypes>
+#include <cstddef>
+
+/**
+ * CRC-32C (Castagnoli) checksum, used to validate the records in the journals
+ */
+struct Crc32c
+{
+	/**
+	 * Continue calculating the checksum with more data
+	 *
+	 * @param crc The checksum calculated so far. Use 0 for the first block
+	 * @param data The data
+	 * @param length The number of bytes
+	 * @return The new checksum
+	 */
+	static uint32_t update(uint32_t crc, const void* data, size_t length);
+
+	/**
+	 * @return The checksum for the supplied data
+	 */
+	inline static uint32_t compute(const void* data, size_t length) {
+		return update(0u, data, length);
+	}
+};
+
+#endif //EVERSTORE_CRC32C_HPP
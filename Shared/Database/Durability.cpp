@@ -0,0 +1,167 @@
+//
+// Copyright (c) 2019 West Coast Code AB. All rights reserved.
+//
+
+#include "Durability.hpp"
+#include "Journal.h"
+#include "../File/IoRing.h"
+
+#ifdef _WIN32
+#include <io.h>
+#endif
+
+namespace
+{
+	const char* const ModeNames[] = {"none", "flush", "fdatasync-per-commit", "fdatasync-interval-ms", "group"};
+	const uint32_t NumModes = sizeof(ModeNames) / sizeof(ModeNames[0]);
+}
+
+Durability::Durability(Mode mode, uint32_t intervalMillis, IoRing* ring)
+		: mMode(mode), mIntervalMillis(intervalMillis), mRing(ring != nullptr && ring->available() ? ring : nullptr),
+		  mWrittenJournals(&Journal::durabilityLink),
+		  mLastIntervalSync(chrono::steady_clock::now()), mSyncs(0), mSyncMicros(0) {
+}
+
+Durability::~Durability() {
+	// Make sure that nothing written is left behind in the OS cache
+	Journal* journal = mWrittenJournals.first();
+	while (journal != nullptr) {
+		Journal* next = journal->durabilityLink.tail;
+		sync(journal->file());
+		journal->durabilityLink.unlink();
+		journal = next;
+	}
+}
+
+bool Durability::persist(FILE* file) {
+	switch (mMode) {
+		case None:
+			return true;
+		case FDataSync:
+		case Group:
+			return sync(file);
+		default:
+			return fflush(file) == 0;
+	}
+}
+
+void Durability::onJournalWritten(Journal* journal) {
+	if (mMode == FDataSyncInterval && !journal->durabilityLink.isLinked()) {
+		mWrittenJournals.addLast(journal);
+	}
+}
+
+void Durability::syncWrittenJournals() {
+	if (mWrittenJournals.empty() || remainingMicros() > 0) {
+		return;
+	}
+
+	// The journals are synchronized at the same time if a ring is available
+	if (mRing != nullptr && mRing->available()) {
+		syncWithRing();
+	}
+
+	Journal* journal = mWrittenJournals.first();
+	while (journal != nullptr) {
+		Journal* next = journal->durabilityLink.tail;
+		sync(journal->file());
+		journal->durabilityLink.unlink();
+		journal = next;
+	}
+	mLastIntervalSync = chrono::steady_clock::now();
+}
+
+void Durability::syncWithRing() {
+	vector<IoRing::Completion> completions;
+	while (!mWrittenJournals.empty()) {
+		// Submit as many synchronizations as the ring can take. The journals are flushed first, same as sync does
+		const auto start = chrono::steady_clock::now();
+		uint32_t count = 0;
+		for (Journal* journal = mWrittenJournals.first(); journal != nullptr && mRing->space() > 0;
+		     journal = journal->durabilityLink.tail) {
+			fflush(journal->file());
+			mRing->sync(fileno(journal->file()), (uint64_t) (uintptr_t) journal, false);
+			count++;
+		}
+
+		completions.clear();
+		if (count == 0 || !mRing->submitAndWait(&completions)) {
+			return;
+		}
+		addSyncs(count, chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count());
+
+		// Journals that failed to synchronize are left for the regular synchronization
+		bool failed = false;
+		for (auto& completion : completions) {
+			auto const journal = (Journal*) (uintptr_t) completion.userData;
+			if (completion.result == 0) {
+				journal->durabilityLink.unlink();
+			} else {
+				failed = true;
+			}
+		}
+		if (failed) {
+			return;
+		}
+	}
+}
+
+bool Durability::sync(FILE* file) {
+	const auto start = chrono::steady_clock::now();
+	if (fflush(file) != 0) {
+		return false;
+	}
+
+#if defined(_WIN32)
+	const bool result = _commit(_fileno(file)) == 0;
+#elif defined(__APPLE__)
+	const bool result = fsync(fileno(file)) == 0;
+#else
+	const bool result = fdatasync(fileno(file)) == 0;
+#endif
+
+	mSyncs++;
+	mSyncMicros += chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+	return result;
+}
+
+void Durability::addSyncs(uint32_t count, uint64_t micros) {
+	mSyncs += count;
+	mSyncMicros += micros;
+}
+
+uint32_t Durability::remainingMicros() const {
+	if (mWrittenJournals.empty()) {
+		return UINT32_MAX;
+	}
+
+	const uint64_t interval = mIntervalMillis * 1000ULL;
+	const uint64_t elapsed = chrono::duration_cast<chrono::microseconds>(
+			chrono::steady_clock::now() - mLastIntervalSync).count();
+	if (elapsed >= interval) {
+		return 0u;
+	}
+	return (uint32_t) (interval - elapsed);
+}
+
+bool Durability::parse(const string& value, Mode* result) {
+	for (uint32_t i = 0; i < NumModes; ++i) {
+		if (value == ModeNames[i]) {
+			*result = (Mode) i;
+			return true;
+		}
+	}
+	return false;
+}
+
+const char* Durability::toString(Mode mode) {
+	if (mode >= NumModes) {
+		return "unknown";
+	}
+	return ModeNames[mode];
+}
+
+Durability* Durability::getDefault() {
+	static Durability durability(Flush, 0);
+	return &durability;
+}
@@ -0,0 +1,136 @@
+//
+// Copyright (c) 2019 West Coast Code AB. All rights reserved.
+//
+
+#ifndef EVERSTORE_DURABILITY_HPP
+#define EVERSTORE_DURABILITY_HPP
+
+#include "../es_config.h"
+#include "../LinkedList.h"
+
+class Journal;
+class IoRing;
+
+/**
+ * Decides how hard the journal files are pushed towards the disk after a commit is written to them
+ */
+class Durability
+{
+public:
+	enum Mode : uint32_t
+	{
+		// Nothing is done after the data is handed over to the OS. The OS decides when it's written to the disk
+		None = 0,
+
+		// Flush any application file buffers to the OS after each commit
+		Flush,
+
+		// Synchronize the journal with the disk after each commit (or after each group of commits)
+		FDataSync,
+
+		// Flush after each commit and synchronize the written journals with the disk once every interval
+		FDataSyncInterval,
+
+		// Synchronize the journal with the disk once for every group of commits
+		Group
+	};
+
+	/**
+	 * @param mode How hard the journal files are pushed towards the disk
+	 * @param intervalMillis The interval used by the "fdatasync-interval-ms" mode
+	 * @param ring Used to synchronize many journals at the same time, if available
+	 */
+	Durability(Mode mode, uint32_t intervalMillis, IoRing* ring = nullptr);
+
+	// Synchronizes all journals that are still waiting for the next interval
+	~Durability();
+
+	/**
+	 * Make the data written to the file as durable as this mode requires
+	 *
+	 * @param file The journal file
+	 * @return <code>true</code> if successful
+	 */
+	bool persist(FILE* file);
+
+	/**
+	 * Method called after commits are written to a journal
+	 *
+	 * @param journal The journal
+	 */
+	void onJournalWritten(Journal* journal);
+
+	/**
+	 * Synchronize all journals written since the last interval with the disk, if the interval has passed
+	 */
+	void syncWrittenJournals();
+
+	/**
+	 * Flush the file and synchronize its data with the disk
+	 *
+	 * @param file The file
+	 * @return <code>true</code> if successful
+	 */
+	bool sync(FILE* file);
+
+	/**
+	 * Count synchronizations that are done by someone else, such as a batch of writes submitted to a ring
+	 *
+	 * @param count The number of files synchronized
+	 * @param micros The time spent waiting for the synchronizations
+	 */
+	void addSyncs(uint32_t count, uint64_t micros);
+
+	/**
+	 * @return How many microseconds that are left until the written journals must be synchronized with the disk
+	 */
+	uint32_t remainingMicros() const;
+
+	inline Mode mode() const { return mMode; }
+
+	// Is the journal file synchronized with the disk every time it's persisted
+	inline bool syncsOnPersist() const { return mMode == FDataSync || mMode == Group; }
+
+	// The ring used to synchronize many journals at the same time. Null if not available
+	inline IoRing* ring() const { return mRing; }
+
+	// Retrieves how many times a file has been synchronized with the disk
+	inline uint64_t syncs() const { return mSyncs; }
+
+	// Retrieves the total time spent synchronizing files with the disk
+	inline uint64_t syncMicros() const { return mSyncMicros; }
+
+	/**
+	 * Parse the supplied durability mode
+	 *
+	 * @param value The string value, for example "fdatasync-per-commit"
+	 * @param result Where the mode is put if the value is valid
+	 * @return <code>true</code> if the value is a known mode
+	 */
+	static bool parse(const string& value, Mode* result);
+
+	/**
+	 * @return A string representation of the supplied mode
+	 */
+	static const char* toString(Mode mode);
+
+	/**
+	 * @return A durability used by journals that are not managed by a worker
+	 */
+	static Durability* getDefault();
+
+private:
+	// Synchronize the written journals by submitting them to the ring, as many at a time as the ring can take
+	void syncWithRing();
+
+private:
+	const Mode mMode;
+	const uint32_t mIntervalMillis;
+	IoRing* const mRing;
+	LinkedList<Journal> mWrittenJournals;
+	chrono::steady_clock::time_point mLastIntervalSync;
+	uint64_t mSyncs;
+	uint64_t mSyncMicros;
+};
+
+#endif //EVERSTORE_DURABILITY_HPP
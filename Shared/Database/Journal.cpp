@@ -4,45 +4,73 @@
 #include "Transaction.h"
 #include "../Memory/ByteBufferInputStream.h"
 #include "../AutoClosable.h"
+#include "../File/JournalWriter.h"
 
 // constexpr char when using C++11 on GCC will require us to define the actual type.
 // Only "int" is supported as constexpr.
 constexpr char Journal::JournalEof;
+constexpr uint32_t Journal::FindRecordBlockSize;
 
-Journal::Journal(const Path& path)
+Journal::Journal(const Path& path, const JournalOptions& options)
 		: mPath(path),
 		  mFile(path.OpenOrCreate("r+b")),
-		  mFileLock(path.value + string(".lock")),
+		  mRecoveryLog(options.recoveryLog),
 		  mTimeSinceLastUsed(chrono::system_clock::now()),
-		  mJournalSize(0) {
-	// The journal size is assumed to be the file size. Only one journal instance can exists for the same file and
-	// since the consistency check is done before, then the file size is the same as the journal size
-	mJournalSize = FileUtils::getFileSize(mFile);
-}
+		  mJournalSize(0),
+		  mDurability(options.durability != nullptr ? options.durability : Durability::getDefault()),
+		  mStagedEvents(nullptr),
+		  mFormat(options.format),
+		  mStagedEventCount(0),
+		  mIndexLoaded(false),
+		  mEventCount(0),
+		  mMmapReadMinBytes(options.mmapReadMinBytes),
+		  mReaders(0) {
+	// Commits are written with positional writes on the file descriptor, so stdio is not allowed to buffer anything
+	if (mFile) {
+		setvbuf(mFile, nullptr, _IONBF, 0);
+	}
 
-Journal::Journal(const Path& path, ProcessID workerId) :
-		mPath(path),
-		mFile(path.OpenOrCreate("r+b")),
-		mFileLock(path.value + string(".") + workerId.ToString() + string(".lock")),
-		mTimeSinceLastUsed(chrono::system_clock::now()),
-		mJournalSize(0) {
 	// The journal size is assumed to be the file size. Only one journal instance can exists for the same file and
 	// since the consistency check is done before, then the file size is the same as the journal size
 	mJournalSize = FileUtils::getFileSize(mFile);
+
+	// Journals that already exists keeps their format. A journal that's smaller than the file header keeps the format
+	// of new journals, since it's a version 2 header that was never completely written if new journals are written as
+	// version 2. The consistency check then removes it
+	JournalFormat::FileHeader header;
+	if (mJournalSize >= sizeof(header)) {
+		const bool v2 = readAt(0, &header, sizeof(header)) &&
+		                JournalFormat::isFileHeader((const char*) &header, sizeof(header));
+		mFormat = v2 ? JournalFormat::V2 : JournalFormat::V1;
+	}
 }
 
 Journal::~Journal() {
+	if (mStagedEvents != nullptr) {
+		delete mStagedEvents;
+		mStagedEvents = nullptr;
+	}
+
 	if (mFile) {
+		// Do not leave anything written behind in the OS cache
+		if (durabilityLink.isLinked()) {
+			mDurability->sync(mFile);
+		}
 		fclose(mFile);
 	}
 }
 
 bool Journal::performConsistencyCheck() {
-	// Ignore if no lock file exists
-	if (!exists() || !mFileLock.exists()) {
+	// Ignore if the journal is empty
+	if (!exists()) {
 		return true;
 	}
 
+	// Only the last record can be unfinished
+	if (mFormat == JournalFormat::V2) {
+		return validateRecords(findLastRecord());
+	}
+
 	// Open and read the journal file into memory
 	ByteBuffer buffer(mJournalSize);
 	std::shared_ptr<FileInputStream> inputStream(Journal::inputStream(0u));
@@ -71,10 +99,9 @@ bool Journal::performConsistencyCheck() {
 		// Find where the EOF-marker might be
 		const auto potentialNextEof = stream.lastIndexOf(Journal::JournalEof);
 
-		// No EOF marker found then the journal is safe. The only thing that was missing was to remove the lock file
+		// No EOF marker found then the journal is safe
 		if (potentialNextEof == -1) {
-			auto result = remove(mFileLock.path().c_str());
-			return result == 0;
+			return true;
 		}
 
 		// Another EOF marker was found, then all the necessary data was saved in the journal, but the removal of the
@@ -87,9 +114,47 @@ bool Journal::performConsistencyCheck() {
 		mJournalSize = (uint32_t) eof + 1;
 	}
 
-	// Remove the file lock when we are done
-	auto result = remove(mFileLock.path().c_str());
-	return result == 0;
+	return true;
+}
+
+bool Journal::performConsistencyCheck(uint32_t sizeBeforeCommit) {
+	// Validate the records written by the commit
+	if (mFormat == JournalFormat::V2) {
+		return validateRecords(sizeBeforeCommit);
+	}
+
+	// The journal is smaller than expected. Fallback to searching for the last EOF-marker
+	if (mJournalSize < sizeBeforeCommit) {
+		return performConsistencyCheck();
+	}
+
+	// Nothing was written. The previous EOF-marker is only replaced after the commit is written
+	if (mJournalSize == sizeBeforeCommit) {
+		return true;
+	}
+
+	// Read the data written after the journal size that's recorded before the commit
+	const auto bytes = mJournalSize - sizeBeforeCommit;
+	ByteBuffer buffer(bytes);
+	auto err = AutoClosable<FileInputStream>(inputStream(sizeBeforeCommit))->readBytes(&buffer, bytes);
+	if (err != ESERR_NO_ERROR) {
+		return false;
+	}
+
+	// The commit is completely written if it ends with the only EOF-marker. Then the only thing that might be missing
+	// is to replace the previous EOF-marker
+	const char* ptr = buffer.ptr();
+	if (ptr[bytes - 1] == JournalEof && memchr(ptr, JournalEof, bytes - 1) == nullptr) {
+		if (sizeBeforeCommit > 0) {
+			std::unique_ptr<FileOutputStream>(outputStream())->replaceWithNL(sizeBeforeCommit - 1);
+		}
+		return true;
+	}
+
+	// Remove the unfinished commit and restore the previous EOF-marker
+	std::unique_ptr<FileOutputStream>(outputStream(sizeBeforeCommit))->rollback();
+	mJournalSize = sizeBeforeCommit;
+	return true;
 }
 
 void Journal::refresh() {
@@ -104,24 +169,207 @@ void Journal::rollback(TransactionID id) {
 	mTransactions.close(id);
 }
 
-ESErrorCode Journal::tryCommit(TransactionID id, Bits::Type types, MutableString eventsString) {
+void Journal::expire(TransactionID id) {
+	mTransactions.expire(id);
+}
+
+ESErrorCode Journal::tryCommit(TransactionID id, const TypeSet& types, MutableString eventsString) {
+	// Commits that are already staged must be written before this one
+	if (hasStagedEvents()) {
+		const auto err = tryStage(id, types, eventsString);
+		if (err != ESERR_NO_ERROR) {
+			return err;
+		}
+		return flush();
+	}
+
+	const auto err = prepareCommit(id, types);
+	if (err != ESERR_NO_ERROR) {
+		return err;
+	}
+
+	// Ignore if no events are to be committed
+	if (eventsString.length == 0) {
+		return ESERR_NO_ERROR;
+	}
+
+	// Write the events directly from the request memory
+	Timestamp now;
+	JournalWriter writer(mFormat);
+	if (mFormat == JournalFormat::V2) {
+		writer.addRecord(&now, eventsString);
+	} else {
+		writer.addTimedEvents(&now, eventsString);
+	}
+	return write(&writer, JournalFormat::countLines(eventsString), &now);
+}
+
+ESErrorCode Journal::tryStage(TransactionID id, const TypeSet& types, MutableString eventsString) {
+	const auto err = prepareCommit(id, types);
+	if (err != ESERR_NO_ERROR) {
+		return err;
+	}
+
+	stage(eventsString);
+	return ESERR_NO_ERROR;
+}
+
+ESErrorCode Journal::flush() {
+	if (!hasStagedEvents()) {
+		return ESERR_NO_ERROR;
+	}
+
+	JournalWriter writer(mFormat);
+	addStagedEvents(&writer);
+	const auto err = write(&writer, mStagedEventCount, &mStagedTimestamp);
+	clearStagedEvents();
+	return err;
+}
+
+void Journal::flush(const vector<Journal*>& journals, IoRing* ring, vector<ESErrorCode>* errors) {
+	errors->assign(journals.size(), ESERR_NO_ERROR);
+	if (ring == nullptr || !ring->available()) {
+		for (uint32_t i = 0; i < journals.size(); ++i) {
+			(*errors)[i] = journals[i]->flush();
+		}
+		return;
+	}
+
+	// Record the intent for all journals first, and make the records durable once. The journals managed by a worker
+	// share the same recovery log and durability
+	vector<std::unique_ptr<JournalWriter>> writers(journals.size());
+	vector<uint32_t> fileSizes(journals.size());
+	RecoveryLog* recoveryLog = nullptr;
+	Durability* durability = nullptr;
+	for (uint32_t i = 0; i < journals.size(); ++i) {
+		Journal* const journal = journals[i];
+		if (!journal->hasStagedEvents()) {
+			continue;
+		}
+
+		journal->loadIndexBeforeWrite();
+		fileSizes[i] = journal->mJournalSize;
+		if (journal->mRecoveryLog != nullptr) {
+			recoveryLog = journal->mRecoveryLog;
+			(*errors)[i] = recoveryLog->prepare(journal->mPath, fileSizes[i]);
+		}
+		durability = journal->mDurability;
+		if (isError((*errors)[i])) {
+			journal->clearStagedEvents();
+			continue;
+		}
+		writers[i].reset(new JournalWriter(journal->mFormat));
+		journal->addStagedEvents(writers[i].get());
+	}
+	if (recoveryLog != nullptr && isError(recoveryLog->persist(durability))) {
+		for (uint32_t i = 0; i < journals.size(); ++i) {
+			if (writers[i] != nullptr) {
+				(*errors)[i] = ESERR_JOURNAL_WRITE;
+				writers[i].reset();
+				journals[i]->clearStagedEvents();
+				if (journals[i]->mRecoveryLog != nullptr) {
+					journals[i]->mRecoveryLog->end(journals[i]->mPath);
+				}
+			}
+		}
+		return;
+	}
+
+	// Submit as many journals as the ring can take at a time. A journal that doesn't fit in an empty ring is
+	// written directly
+	vector<IoRing::Completion> completions;
+	uint32_t next = 0;
+	while (next < journals.size()) {
+		const auto start = chrono::steady_clock::now();
+		uint32_t syncs = 0;
+		for (; next < journals.size(); ++next) {
+			JournalWriter* const writer = writers[next].get();
+			if (writer == nullptr) {
+				continue;
+			}
+			Journal* const journal = journals[next];
+			const bool sync = journal->mDurability->syncsOnPersist();
+			if (!writer->submit(ring, journal->mFile, fileSizes[next], sync, (uint64_t) next << 2u)) {
+				if (ring->space() < ring->capacity()) {
+					break;
+				}
+				(*errors)[next] = writer->write(journal->mFile, fileSizes[next], journal->mDurability);
+				continue;
+			}
+			if (sync) {
+				syncs += journal->mFormat == JournalFormat::V1 && fileSizes[next] > 0 ? 2 : 1;
+			}
+		}
+
+		completions.clear();
+		if (ring->space() == ring->capacity()) {
+			continue;
+		}
+		if (!ring->submitAndWait(&completions)) {
+			// The ring is closed, so the journals that are not submitted yet are never written. All of them fail
+			// and what's already written is removed. The next group is written without the ring
+			for (uint32_t i = 0; i < journals.size(); ++i) {
+				if (writers[i] != nullptr) {
+					(*errors)[i] = ESERR_JOURNAL_WRITE;
+				}
+			}
+			break;
+		}
+		if (durability != nullptr && syncs > 0) {
+			durability->addSyncs(syncs, chrono::duration_cast<chrono::microseconds>(
+					chrono::steady_clock::now() - start).count());
+		}
+		for (auto& completion : completions) {
+			const uint32_t i = (uint32_t) (completion.userData >> 2u);
+			if (!writers[i]->succeeded(completion)) {
+				(*errors)[i] = ESERR_JOURNAL_WRITE;
+			}
+		}
+	}
+
+	// Update the journals, or remove what's written if the write failed
+	for (uint32_t i = 0; i < journals.size(); ++i) {
+		if (writers[i] == nullptr) {
+			continue;
+		}
+		Journal* const journal = journals[i];
+		journal->completeWrite(writers[i].get(), (*errors)[i], fileSizes[i], journal->mStagedEventCount,
+		                       &journal->mStagedTimestamp);
+		journal->clearStagedEvents();
+	}
+}
+
+void Journal::addStagedEvents(JournalWriter* writer) {
+	// The separator after the last staged commit is replaced by the EOF-marker
+	const auto separator = mFormat == JournalFormat::V2 ? 0 : FileUtils::NL_SIZE;
+	writer->add(mStagedEvents->ptr(), mStagedEvents->offset() - separator);
+}
+
+void Journal::clearStagedEvents() {
+	delete mStagedEvents;
+	mStagedEvents = nullptr;
+	mStagedEventCount = 0;
+}
+
+ESErrorCode Journal::prepareCommit(TransactionID id, const TypeSet& types) {
 	// Retrieve the active transaction
 	auto t = mTransactions.get(id);
-	if (t == nullptr) return ESERR_JOURNAL_TRANSACTION_DOES_NOT_EXIST;
+	if (t == nullptr) {
+		return mTransactions.expired(id) ? ESERR_JOURNAL_TRANSACTION_EXPIRED : ESERR_JOURNAL_TRANSACTION_DOES_NOT_EXIST;
+	}
 
-	// Set necessary bit if the journal is to be created
+	// Make sure that the directory exists if the journal is to be created
 	if (t->createJournal()) {
 		FileUtils::createFullForPath(mPath.value);
-		types = Bits::Set(types, Bits::BuiltIn::NewJournalBit);
 	}
 
-	// Has a conflict occurred?
-	if (t->conflictsWith(types)) {
+	// Has a conflict occurred? Commits of different event types never conflict, not even when they both create the
+	// journal
+	if (mTransactions.conflictsWith(t, types)) {
 		return ESERR_JOURNAL_TRANSACTION_CONFLICT;
 	}
 
-	// Commit the transaction and close it from being open
-	t->save(eventsString);
+	// Close the transaction from being open
 	mTransactions.close(id);
 
 	// Notify all open transactions that another transaction has been committed
@@ -130,18 +378,220 @@ ESErrorCode Journal::tryCommit(TransactionID id, Bits::Type types, MutableString
 	return ESERR_NO_ERROR;
 }
 
-uint32_t Journal::addRef() {
-	mFileLock.addRef();
-	return mJournalSize;
+void Journal::loadIndexBeforeWrite() {
+	// The index is updated with the new events. Commits are still written if the index can't be loaded
+	if (!mIndexLoaded) {
+		const auto err = loadIndex();
+		if (isError(err)) {
+			Log::Write(Log::Warn, "Failed to load the index for journal: %s", mPath.value.c_str());
+		}
+	}
+}
+
+ESErrorCode Journal::write(JournalWriter* writer, uint32_t eventCount, const Timestamp* timestamp) {
+	loadIndexBeforeWrite();
+
+	// Record the intent so that an unfinished write can be removed if the process crashes
+	const auto fileSize = mJournalSize;
+	if (mRecoveryLog != nullptr) {
+		const auto err = mRecoveryLog->begin(mPath, fileSize, mDurability);
+		if (isError(err)) {
+			return err;
+		}
+	}
+
+	// Write all commits in one go and then make them durable
+	const auto err = writer->write(mFile, fileSize, mDurability);
+	completeWrite(writer, err, fileSize, eventCount, timestamp);
+	return err;
+}
+
+void Journal::completeWrite(JournalWriter* writer, ESErrorCode err, uint32_t fileSize, uint32_t eventCount,
+                            const Timestamp* timestamp) {
+	if (isError(err)) {
+		if (mFormat == JournalFormat::V2) {
+			FileUtils::truncate(mFile, fileSize);
+		} else {
+			std::unique_ptr<FileOutputStream>(outputStream(fileSize))->rollback();
+		}
+	} else {
+		mDurability->onJournalWritten(this);
+		mJournalSize += writer->size();
+		if (mIndexLoaded) {
+			const uint32_t firstEventOffset = mFormat == JournalFormat::V2 && fileSize == 0
+			                                  ? sizeof(JournalFormat::FileHeader) : fileSize;
+			mIndex.add(mEventCount, firstEventOffset, timestamp->value);
+			mEventCount += eventCount;
+		}
+	}
+
+	// We are now done with accessing the journal on disk
+	if (mRecoveryLog != nullptr) {
+		mRecoveryLog->end(mPath);
+	}
+}
+
+void Journal::stage(MutableString events) {
+	// Ignore if no events are to be committed
+	if (events.length == 0) {
+		return;
+	}
+
+	Timestamp now;
+	if (mStagedEvents == nullptr) {
+		mStagedEvents = new ByteBuffer(events.length);
+		mStagedTimestamp = now;
+	}
+	mStagedEventCount += JournalFormat::countLines(events);
+
+	if (mFormat == JournalFormat::V2) {
+		JournalFormat::appendRecord(mStagedEvents, &now, events);
+		return;
+	}
+	FileOutputStream::appendTimedEvents(mStagedEvents, &now, events);
+
+	// Separate this commit from the next one. The separator after the last commit is replaced with an EOF-marker
+	mStagedEvents->write(&FileUtils::NL, FileUtils::NL_SIZE);
 }
 
-void Journal::release(uint32_t bytesWritten) {
-	mFileLock.release();
-	mJournalSize += bytesWritten;
+bool Journal::validateRecords(uint32_t offset) {
+	// The file header itself was never completely written
+	if (mJournalSize < sizeof(JournalFormat::FileHeader)) {
+		return truncate(0u);
+	}
+	offset = offset < sizeof(JournalFormat::FileHeader) ? sizeof(JournalFormat::FileHeader) : offset;
+
+	ByteBuffer payload(4096);
+	while (offset < mJournalSize) {
+		JournalFormat::RecordHeader header;
+		const auto bytesLeft = mJournalSize - offset;
+		if (bytesLeft < sizeof(header) || !readAt(offset, &header, sizeof(header)) ||
+		    header.length > bytesLeft - sizeof(header)) {
+			return truncate(offset);
+		}
+
+		payload.reset();
+		if (!readAt(offset + sizeof(header), payload.allocate(header.length), header.length) ||
+		    !JournalFormat::isValid(&header, payload.ptr())) {
+			return truncate(offset);
+		}
+		offset += sizeof(header) + header.length;
+	}
+	return true;
+}
+
+uint32_t Journal::findLastRecord() {
+	// The headers are read from large blocks, and a payload that's larger than a block is skipped without reading it
+	string block;
+	uint32_t blockOffset = 0;
+	uint32_t offset = sizeof(JournalFormat::FileHeader);
+	uint32_t last = offset;
+	while (offset < mJournalSize) {
+		JournalFormat::RecordHeader header;
+		last = offset;
+		const auto bytesLeft = mJournalSize - offset;
+		if (bytesLeft < sizeof(header)) {
+			break;
+		}
+		if (offset < blockOffset || offset + sizeof(header) > blockOffset + block.size()) {
+			block.resize(bytesLeft < FindRecordBlockSize ? bytesLeft : FindRecordBlockSize);
+			blockOffset = offset;
+			if (!readAt(offset, &block[0], (uint32_t) block.size())) {
+				break;
+			}
+		}
+		memcpy(&header, block.c_str() + (offset - blockOffset), sizeof(header));
+		if (header.length > bytesLeft - sizeof(header)) {
+			break;
+		}
+		offset += sizeof(header) + header.length;
+	}
+	return last;
+}
+
+bool Journal::readAt(uint32_t offset, void* dest, uint32_t size) {
+	if (fseek(mFile, offset, SEEK_SET) != 0) {
+		return false;
+	}
+	return size == 0 || fread(dest, size, 1, mFile) == 1;
+}
+
+bool Journal::truncate(uint32_t size) {
+	if (!FileUtils::truncate(mFile, size)) {
+		return false;
+	}
+	mJournalSize = size;
+	return true;
+}
+
+ESErrorCode Journal::loadIndex() {
+	if (mIndexLoaded) {
+		return ESERR_NO_ERROR;
+	}
+
+	if (!mIndex.open(mPath + JournalIndex::Suffix, mJournalSize)) {
+		return ESERR_JOURNAL_READ;
+	}
+
+	// Count the events after the last entry and add entries for them
+	JournalIndex::Entry start = {0u, 0u};
+	if (mIndex.last() != nullptr) {
+		start = *mIndex.last();
+	}
+	JournalCursor cursor(mFile, mJournalSize, mFormat, start.byteOffset, start.eventNumber);
+	while (cursor.next()) {
+		if (cursor.isEntryPoint()) {
+			mIndex.add(cursor.eventNumber(), cursor.entryOffset(), cursor.timestamp());
+		}
+	}
+	if (isError(cursor.error())) {
+		mIndex.close();
+		return cursor.error();
+	}
+
+	mEventCount = cursor.nextEventNumber();
+	mIndexLoaded = true;
+	return ESERR_NO_ERROR;
+}
+
+JournalCursor* Journal::cursor(uint32_t eventNumber) {
+	// The entire journal is scanned if the index can't be loaded
+	JournalIndex::Entry start = {0u, 0u};
+	if (loadIndex() == ESERR_NO_ERROR) {
+		start = mIndex.find(eventNumber, start);
+	}
+
+	auto cursor = new JournalCursor(mFile, mJournalSize, mFormat, start.byteOffset, start.eventNumber);
+	cursor->skipTo(eventNumber);
+	return cursor;
+}
+
+JournalCursor* Journal::cursor(const char* timestamp, uint32_t length) {
+	// The entire journal is scanned if the index can't be loaded
+	JournalIndex::Entry start = {0u, 0u};
+	if (loadIndex() == ESERR_NO_ERROR) {
+		start = mIndex.find(timestamp, length, start);
+	}
+
+	auto cursor = new JournalCursor(mFile, mJournalSize, mFormat, start.byteOffset, start.eventNumber);
+	cursor->skipBefore(timestamp, length);
+	return cursor;
+}
+
+MemoryMappedFile::Memory Journal::mapForReading(uint32_t size) {
+	if (mMmapReadMinBytes == 0 || size < mMmapReadMinBytes) {
+		return nullptr;
+	}
+	return mMapping.map(mFile, size);
 }
 
 FileInputStream* Journal::inputStream(uint32_t bytesOffset) {
-	return new FileInputStream(mFile, mJournalSize, bytesOffset);
+	return new FileInputStream(mFile, mJournalSize, bytesOffset, mFormat, mapForReading(mJournalSize));
+}
+
+FileInputStream* Journal::inputStream(uint32_t bytesOffset, uint32_t journalSize) {
+	journalSize = journalSize > mJournalSize ? mJournalSize : journalSize;
+	return new FileInputStream(mFile, journalSize, bytesOffset, mFormat, mapForReading(journalSize));
 }
 
 FileOutputStream* Journal::outputStream() {
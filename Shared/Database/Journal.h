@@ -3,13 +3,39 @@
 
 #include "../es_config.h"
 #include "../Message/ESHeader.h"
-#include "../File/FileLock.h"
 #include "Transaction.h"
 #include "../LinkedList.h"
 #include "../File/FileInputStream.h"
 #include "../File/FileOutputStream.h"
+#include "../File/MemoryMappedFile.h"
 #include "OpenTransactions.hpp"
 #include "../File/Path.hpp"
+#include "Durability.hpp"
+#include "RecoveryLog.hpp"
+#include "JournalFormat.hpp"
+#include "JournalIndex.hpp"
+#include "JournalCursor.hpp"
+
+class JournalWriter;
+class IoRing;
+
+// Settings shared by the journals managed by a worker
+struct JournalOptions
+{
+	// Where the intent of each write is recorded. Nothing is recorded if null
+	RecoveryLog* recoveryLog;
+
+	// How the journal file is made durable after each write. The default durability is used if null
+	Durability* durability;
+
+	// The format used when a new journal is created
+	JournalFormat::Version format;
+
+	// Journals of at least this size are memory mapped when they are read (0 = never)
+	uint32_t mmapReadMinBytes;
+
+	JournalOptions() : recoveryLog(nullptr), durability(nullptr), format(JournalFormat::V1), mmapReadMinBytes(0) {}
+};
 
 class Journal
 {
@@ -22,15 +48,19 @@ public:
 
 	LinkedListLink<Journal> link;
 
-	Journal(const Path& path);
+	// Linked while the journal is written to, but not yet synchronized with the disk
+	LinkedListLink<Journal> durabilityLink;
 
-	Journal(const Path& path, ProcessID childProcessId);
+	Journal(const Path& path, const JournalOptions& options = JournalOptions());
 
 	~Journal();
 
-	// Perform consistency check on this journal
+	// Perform consistency check on this journal by searching for the last EOF-marker (or validating the last record)
 	bool performConsistencyCheck();
 
+	// Perform consistency check on this journal when a commit was written to it at the supplied journal size
+	bool performConsistencyCheck(uint32_t sizeBeforeCommit);
+
 	// Refresh the life-time timestamp of this object
 	void refresh();
 
@@ -40,18 +70,47 @@ public:
 	// Rollback the supplied transaction
 	void rollback(TransactionID id);
 
-	// Try to commit a transaction
-	ESErrorCode tryCommit(TransactionID id, Bits::Type types, MutableString eventsString);
+	// Retrieve an open transaction. nullptr if the transaction is not open
+	inline Transaction* transaction(TransactionID id) { return mTransactions.get(id); }
 
-	// Increase the reference count of this journal and returns the size of the journal
-	//
-	// \return The size of the journal
-	uint32_t addRef();
+	// Close a transaction that has been open for too long. A commit for the transaction fails with
+	// ESERR_JOURNAL_TRANSACTION_EXPIRED
+	void expire(TransactionID id);
+
+	// Try to commit a transaction and write the events to the journal file
+	ESErrorCode tryCommit(TransactionID id, const TypeSet& types, MutableString eventsString);
+
+	// Try to commit a transaction, but keep the events in memory until the journal is flushed. Open transactions
+	// will see the commit as if it's already written to the journal file
+	ESErrorCode tryStage(TransactionID id, const TypeSet& types, MutableString eventsString);
 
-	// Release a reference counter
+	// Write all staged commits to the journal file as one append
+	ESErrorCode flush();
+
+	// Write the staged commits of all the supplied journals at the same time. The writes, and the synchronizations
+	// with the disk, are submitted to the ring together so that the disk can work on all of them at once. Each
+	// journal is flushed one at a time if the ring is not available
 	//
-	// \param bytesWritten The amount of bytes written to the journal
-	void release(uint32_t bytesWritten);
+	// \param errors Where the result for each journal is put
+	static void flush(const vector<Journal*>& journals, IoRing* ring, vector<ESErrorCode>* errors);
+
+	// Retrieves the amount of bytes that are staged, but not yet written, to the journal file
+	inline uint32_t stagedBytes() const { return mStagedEvents == nullptr ? 0u : mStagedEvents->offset(); }
+
+	// Are there any commits waiting to be written to the journal file
+	inline bool hasStagedEvents() const { return stagedBytes() > 0; }
+
+	// Are there any transactions that's not yet committed or rolled back
+	inline bool hasOpenTransactions() const { return !mTransactions.empty(); }
+
+	// Mark that the journal file is read by another thread. The journal must not be closed until the read is done
+	inline void addReader() { mReaders++; }
+
+	// Mark that a read started with addReader is done
+	inline void removeReader() { mReaders--; }
+
+	// Is the journal file read by another thread
+	inline bool hasReaders() const { return mReaders.load() > 0; }
 
 	// Retrieves the size of this journal in bytes. The size of the journal might or might not be the same size as the journal file's size
 	inline uint32_t journalSize() const { return mJournalSize; }
@@ -67,18 +126,79 @@ public:
 
 	inline FILE* file() const { return mFile; }
 
+	// The format this journal is stored in
+	inline JournalFormat::Version format() const { return mFormat; }
+
 	// When was the journal used last?
 	inline const chrono::system_clock::time_point& timeSinceLastUsed() const { return mTimeSinceLastUsed; }
 
 	// Open a file input stream to the journal
 	FileInputStream* inputStream(uint32_t bytesOffset);
 
+	// Open a file input stream to the journal that stops at the supplied journal size
+	FileInputStream* inputStream(uint32_t bytesOffset, uint32_t journalSize);
+
+	// Open a cursor where the next event is the supplied event. The index is loaded if it's not already
+	JournalCursor* cursor(uint32_t eventNumber);
+
+	// Open a cursor where the next event is the first event written at, or after, the supplied timestamp. The
+	// timestamp can be shortened, such as "2019-10-01T00:00"
+	JournalCursor* cursor(const char* timestamp, uint32_t length);
+
+	// Load the index and count the events in the journal. The index is rebuilt from the journal if it's missing
+	ESErrorCode loadIndex();
+
+	// Retrieves the number of events in this journal. Only known when the index is loaded
+	inline uint32_t eventCount() const { return mEventCount; }
+
 	// Open a file output stream
 	FileOutputStream* outputStream();
 
 	// Open a file output stream
 	FileOutputStream* outputStream(uint32_t bytesOffset);
 
+private:
+	// Verify that the transaction can be committed and close it. Open transactions are notified about the commit
+	ESErrorCode prepareCommit(TransactionID id, const TypeSet& types);
+
+	// Format the supplied events and put them in the staging memory
+	void stage(MutableString events);
+
+	// Write the commits onto the journal file
+	ESErrorCode write(JournalWriter* writer, uint32_t eventCount, const Timestamp* timestamp);
+
+	// Update the journal after the commits are written at the supplied file size, or remove what's written if
+	// the write failed
+	void completeWrite(JournalWriter* writer, ESErrorCode err, uint32_t fileSize, uint32_t eventCount,
+	                   const Timestamp* timestamp);
+
+	// Load the index, if it's not already loaded, so that it can be updated with the written events
+	void loadIndexBeforeWrite();
+
+	// Add the staged commits to the supplied writer
+	void addStagedEvents(JournalWriter* writer);
+
+	// Remove the staged commits
+	void clearStagedEvents();
+
+	// Validate all records from the supplied offset and remove the first invalid record and everything after it
+	bool validateRecords(uint32_t offset);
+
+	// Find the offset of the last record by only reading the record headers
+	uint32_t findLastRecord();
+
+	// The number of bytes read at a time when the record headers are searched
+	static constexpr uint32_t FindRecordBlockSize = 64u * 1024u;
+
+	// Read bytes from the supplied position in the journal file
+	bool readAt(uint32_t offset, void* dest, uint32_t size);
+
+	// Remove everything after the supplied size from the journal file
+	bool truncate(uint32_t size);
+
+	// Map the journal file into memory if it's large enough
+	MemoryMappedFile::Memory mapForReading(uint32_t size);
+
 private:
 	// The path to this journal
 	const Path mPath;
@@ -86,12 +206,37 @@ private:
 	// Points to the actual file on the hdd
 	FILE* const mFile;
 
-	FileLock mFileLock;
+	// Where the intent of each write is recorded
+	RecoveryLog* const mRecoveryLog;
+
 	chrono::system_clock::time_point mTimeSinceLastUsed;
 	uint32_t mJournalSize;
 	OpenTransactions mTransactions;
 
+	// How the journal file is made durable after each write
+	Durability* const mDurability;
+
+	// Commits waiting to be written to the journal file
+	ByteBuffer* mStagedEvents;
+
+	// The format this journal is stored in
+	JournalFormat::Version mFormat;
+
+	// Number of events in the staged commits and when the first one was staged
+	uint32_t mStagedEventCount;
+	Timestamp mStagedTimestamp;
+
+	// Where the events are found in the journal
+	JournalIndex mIndex;
+	bool mIndexLoaded;
+	uint32_t mEventCount;
+
+	// The journal file mapped into memory when it's read
+	MemoryMappedFile mMapping;
+	const uint32_t mMmapReadMinBytes;
 
+	// Number of reads done by other threads
+	atomic<uint32_t> mReaders;
 };
 
 
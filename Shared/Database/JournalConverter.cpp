@@ -0,0 +1,181 @@
+//
+// Copyright (c) 2019 West Coast Code AB. All rights reserved.
+//
+
+#include "JournalConverter.hpp"
+#include "JournalFormat.hpp"
+#include "Journal.h"
+#include "Durability.hpp"
+#include "JournalIndex.hpp"
+#include "../File/FileUtils.h"
+
+const string JournalConverter::Suffix(".converting");
+
+namespace
+{
+	const uint32_t TimestampAndSpaceLength = Timestamp::BytesLength + 1;
+
+	// Check to see if the line starts with a timestamp, such as "2015-07-06T18:26:59.483 "
+	bool hasTimestamp(const char* line, uint32_t length) {
+		return length >= TimestampAndSpaceLength && line[4] == '-' && line[10] == 'T' &&
+		       line[Timestamp::BytesLength] == FileUtils::SPACE;
+	}
+
+	// How much of the original journal is read at a time
+	const uint32_t ReadBlockSize = 64 * 1024;
+
+	/**
+	 * Turns the lines of a version 1 journal into records that are written to the converted journal as soon as
+	 * they are complete
+	 */
+	class RecordConverter
+	{
+	public:
+		explicit RecordConverter(FILE* file) : mFile(file), mMemory(ReadBlockSize), mHasRecord(false),
+		                                       mWritten(true) {}
+
+		// Convert the next line in the journal
+		void line(const char* line, uint32_t length) {
+			// Every line in a commit is prefixed with the timestamp. A line without it is the end of a commit that's
+			// terminated by a new-line character
+			if (hasTimestamp(line, length)) {
+				if (!mHasRecord || memcmp(mTimestamp.value, line, Timestamp::BytesLength) != 0) {
+					if (mHasRecord) {
+						write();
+					}
+					memcpy(mTimestamp.value, line, Timestamp::BytesLength);
+					mEvents.assign(line + TimestampAndSpaceLength, length - TimestampAndSpaceLength);
+					mHasRecord = true;
+				} else {
+					mEvents.push_back(FileUtils::NL);
+					mEvents.append(line + TimestampAndSpaceLength, length - TimestampAndSpaceLength);
+				}
+			} else {
+				if (mHasRecord) {
+					mEvents.push_back(FileUtils::NL);
+				} else {
+					mEvents.clear();
+				}
+				mEvents.append(line, length);
+				write();
+				mHasRecord = false;
+			}
+		}
+
+		// Write the last record
+		bool finish() {
+			if (mHasRecord) {
+				write();
+				mHasRecord = false;
+			}
+			return mWritten;
+		}
+
+	private:
+		// Write the events as one record
+		void write() {
+			ByteBuffer bytes(mEvents.length() + 1);
+			memcpy(bytes.allocate(mEvents.length()), mEvents.c_str(), mEvents.length());
+			bytes.reset();
+
+			mMemory.reset();
+			JournalFormat::appendRecord(&mMemory, &mTimestamp, MutableString(mEvents.length(), &bytes));
+			if (mWritten && fwrite(mMemory.ptr(), mMemory.offset(), 1, mFile) != 1) {
+				mWritten = false;
+			}
+		}
+
+	private:
+		FILE* const mFile;
+		ByteBuffer mMemory;
+		Timestamp mTimestamp;
+		string mEvents;
+		bool mHasRecord;
+		bool mWritten;
+	};
+
+	// Read the journal one block at a time and convert each line, including the (possibly empty) text after the
+	// last new-line character
+	bool convertLines(FILE* file, uint32_t size, RecordConverter* converter) {
+		string buffer;
+		uint32_t offset = 0;
+		while (offset < size) {
+			const auto bytes = size - offset > ReadBlockSize ? ReadBlockSize : size - offset;
+			const auto scanFrom = buffer.length();
+			buffer.resize(scanFrom + bytes);
+			if (!FileUtils::readAt(file, offset, &buffer[scanFrom], bytes)) {
+				return false;
+			}
+			offset += bytes;
+
+			// Only the new bytes have to be searched, since the bytes before them are part of an unfinished line
+			const char* line = buffer.c_str();
+			const char* const end = line + buffer.length();
+			const char* nl = (const char*) memchr(buffer.c_str() + scanFrom, FileUtils::NL, bytes);
+			while (nl != nullptr) {
+				converter->line(line, nl - line);
+				line = nl + 1;
+				nl = (const char*) memchr(line, FileUtils::NL, end - line);
+			}
+			buffer.erase(0, line - buffer.c_str());
+		}
+		converter->line(buffer.c_str(), buffer.length());
+		return true;
+	}
+}
+
+ESErrorCode JournalConverter::convert(const Path& journalPath) {
+	FILE* file = journalPath.Open("rb");
+	if (file == nullptr) {
+		return ESERR_JOURNAL_READ;
+	}
+
+	// Nothing to convert
+	const auto size = FileUtils::getFileSize(file);
+	JournalFormat::FileHeader existingHeader;
+	if (size == 0 || (size >= sizeof(existingHeader) &&
+	                  FileUtils::readAt(file, 0, &existingHeader, sizeof(existingHeader)) &&
+	                  JournalFormat::isFileHeader((const char*) &existingHeader, sizeof(existingHeader)))) {
+		fclose(file);
+		return ESERR_NO_ERROR;
+	}
+
+	// The EOF-marker is not part of the events
+	char last;
+	if (!FileUtils::readAt(file, size - 1, &last, 1)) {
+		fclose(file);
+		return ESERR_JOURNAL_READ;
+	}
+	const uint32_t eventsSize = last == Journal::JournalEof ? size - 1 : size;
+
+	// The records are written to a separate file as the journal is read
+	const Path tempPath = journalPath + Suffix;
+	FILE* converted = tempPath.OpenOrCreate("wb");
+	if (converted == nullptr) {
+		fclose(file);
+		return ESERR_JOURNAL_WRITE;
+	}
+	const auto header = JournalFormat::fileHeader();
+	bool written = fwrite(&header, sizeof(header), 1, converted) == 1;
+
+	RecordConverter converter(converted);
+	const auto read = convertLines(file, eventsSize, &converter);
+	fclose(file);
+	written = converter.finish() && written;
+
+	// Make sure that the converted journal is on the disk before it replaces the original journal, and that the
+	// rename itself is on the disk before the index is removed
+	Durability durability(Durability::FDataSync, 0);
+	written = written && read && durability.persist(converted);
+	fclose(converted);
+	if (!written || rename(tempPath.value.c_str(), journalPath.value.c_str()) != 0) {
+		FileUtils::remove(tempPath.value);
+		return read ? ESERR_JOURNAL_WRITE : ESERR_JOURNAL_READ;
+	}
+	FileUtils::syncDirectory(journalPath.GetDirectory());
+
+	// The events are found at other offsets in the converted journal
+	FileUtils::remove((journalPath + JournalIndex::Suffix).value);
+
+	return ESERR_NO_ERROR;
+}
@@ -0,0 +1,34 @@
+//
+// Copyright (c) 2019 West Coast Code AB. All rights reserved.
+//
+
+#ifndef EVERSTORE_JOURNALCONVERTER_HPP
+#define EVERSTORE_JOURNALCONVERTER_HPP
+
+#include "../es_config.h"
+#include "../ESErrorCodes.h"
+#include "../File/Path.hpp"
+
+/**
+ * Converts a version 1 journal into a version 2 journal.
+ * <p />
+ * Consecutive lines with the same timestamp are written as one record. Commits written within the same millisecond
+ * can therefore end up in the same record, which is read back as the exact same events. The journal must be consistent,
+ * i.e. end with an EOF-marker, before it's converted.
+ */
+struct JournalConverter
+{
+	// The file extension used for the journal while it's being converted
+	static const string Suffix;
+
+	/**
+	 * Convert the supplied journal. The converted journal is written to a separate file which then replaces the
+	 * original journal. Journals that already are in the version 2 format are left as they are.
+	 *
+	 * @param journalPath The path to the journal
+	 * @return ESERR_NO_ERROR if the journal is converted
+	 */
+	static ESErrorCode convert(const Path& journalPath);
+};
+
+#endif //EVERSTORE_JOURNALCONVERTER_HPP
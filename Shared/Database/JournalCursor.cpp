@@ -0,0 +1,174 @@
+//
+// Copyright (c) 2019 West Coast Code AB. All rights reserved.
+//
+
+#include "JournalCursor.hpp"
+#include "../File/FileUtils.h"
+#include "Journal.h"
+
+namespace
+{
+	// How many bytes are read from the journal at a time
+	const uint32_t BlockSize = 65536;
+
+	const uint32_t TimestampAndSpaceLength = Timestamp::BytesLength + 1;
+}
+
+JournalCursor::JournalCursor(FILE* file, uint32_t journalSize, JournalFormat::Version format, uint32_t byteOffset,
+                             uint32_t eventNumber)
+		: mFile(file), mFormat(format), mEnd(journalSize), mOffset(byteOffset), mRecordEnd(0),
+		  mNextEventNumber(eventNumber), mEntryOffset(byteOffset), mEntryPoint(false), mTimestamp(nullptr),
+		  mEvent(nullptr), mEventLength(0), mError(ESERR_NO_ERROR), mHold(false), mBufferOffset(0), mBufferSize(0) {
+	assert(file != nullptr);
+
+	if (format == JournalFormat::V2) {
+		if (mOffset < sizeof(JournalFormat::FileHeader)) {
+			mOffset = sizeof(JournalFormat::FileHeader);
+		}
+	} else if (mEnd > 0) {
+		// The EOF-marker is not part of the events
+		mEnd -= Journal::JournalEofLen;
+	}
+	if (mOffset > mEnd) {
+		mOffset = mEnd;
+	}
+	mRecordEnd = mOffset;
+}
+
+bool JournalCursor::next() {
+	if (mError != ESERR_NO_ERROR) {
+		return false;
+	}
+
+	if (mHold) {
+		mHold = false;
+		mNextEventNumber++;
+		return true;
+	}
+
+	const auto found = mFormat == JournalFormat::V2 ? nextRecordEvent() : nextLine();
+	if (found) {
+		mNextEventNumber++;
+	}
+	return found;
+}
+
+bool JournalCursor::skipTo(uint32_t eventNumber) {
+	while (mNextEventNumber < eventNumber && next()) {
+	}
+	return mError == ESERR_NO_ERROR;
+}
+
+bool JournalCursor::skipBefore(const char* timestamp, uint32_t length) {
+	while (next()) {
+		if (memcmp(mTimestamp, timestamp, length) >= 0) {
+			// The memory is still valid, since nothing more is read until the cursor is moved
+			mHold = true;
+			mNextEventNumber--;
+			break;
+		}
+	}
+	return mError == ESERR_NO_ERROR;
+}
+
+bool JournalCursor::nextLine() {
+	while (mOffset < mEnd) {
+		// Find the end of the line, reading more of the journal if the line is larger than what's read
+		uint32_t size = mEnd - mOffset > BlockSize ? BlockSize : mEnd - mOffset;
+		const char* line;
+		const char* nl;
+		while (true) {
+			line = load(mOffset, size);
+			if (line == nullptr) {
+				return false;
+			}
+			nl = (const char*) memchr(line, FileUtils::NL, size);
+			if (nl != nullptr || mOffset + size == mEnd) {
+				break;
+			}
+			size = mEnd - mOffset > size * 2 ? size * 2 : mEnd - mOffset;
+		}
+
+		const uint32_t length = nl == nullptr ? size : nl - line;
+		const auto lineOffset = mOffset;
+		mOffset += length + (nl == nullptr ? 0 : FileUtils::NL_SIZE);
+
+		// Every event is prefixed with a timestamp. Only the separator after a commit ending with a new-line is not
+		if (length < TimestampAndSpaceLength) {
+			continue;
+		}
+
+		mEntryOffset = lineOffset;
+		mEntryPoint = true;
+		mTimestamp = line;
+		mEvent = line + TimestampAndSpaceLength;
+		mEventLength = length - TimestampAndSpaceLength;
+		return true;
+	}
+	return false;
+}
+
+bool JournalCursor::nextRecordEvent() {
+	// Read the next record when all events in the current record are returned
+	bool first = false;
+	while (mOffset >= mRecordEnd) {
+		if (mEnd - mRecordEnd < sizeof(JournalFormat::RecordHeader)) {
+			return false;
+		}
+
+		const auto header = (const JournalFormat::RecordHeader*) load(mRecordEnd, sizeof(JournalFormat::RecordHeader));
+		if (header == nullptr) {
+			return false;
+		}
+		const auto recordOffset = mRecordEnd;
+		const auto payloadOffset = recordOffset + sizeof(JournalFormat::RecordHeader);
+		if (header->length > mEnd - payloadOffset) {
+			return false;
+		}
+
+		// Keep the entire record in memory so that the timestamp is valid for all of its events
+		const auto record = load(recordOffset, sizeof(JournalFormat::RecordHeader) + header->length);
+		if (record == nullptr) {
+			return false;
+		}
+		mTimestamp = ((const JournalFormat::RecordHeader*) record)->timestamp;
+		mEntryOffset = recordOffset;
+		mOffset = payloadOffset;
+		mRecordEnd = payloadOffset + ((const JournalFormat::RecordHeader*) record)->length;
+		first = true;
+	}
+
+	const auto payload = load(mOffset, mRecordEnd - mOffset);
+	if (payload == nullptr) {
+		return false;
+	}
+	const auto nl = (const char*) memchr(payload, FileUtils::NL, mRecordEnd - mOffset);
+	mEvent = payload;
+	mEventLength = nl == nullptr ? mRecordEnd - mOffset : nl - payload;
+	mOffset += mEventLength + (nl == nullptr ? 0 : FileUtils::NL_SIZE);
+	mEntryPoint = first;
+	return true;
+}
+
+const char* JournalCursor::load(uint32_t offset, uint32_t size) {
+	if (offset >= mBufferOffset && offset + size <= mBufferOffset + mBufferSize) {
+		return &mBuffer[offset - mBufferOffset];
+	}
+
+	// Read as much as possible, but never past the end of the journal
+	uint32_t readSize = size > BlockSize ? size : BlockSize;
+	if (readSize > mEnd - offset) {
+		readSize = mEnd - offset;
+	}
+	if (mBuffer.size() < readSize) {
+		mBuffer.resize(readSize);
+	}
+	if (!FileUtils::readAt(mFile, offset, &mBuffer[0], readSize)) {
+		mError = ESERR_JOURNAL_READ;
+		mBufferSize = 0;
+		return nullptr;
+	}
+	mBufferOffset = offset;
+	mBufferSize = readSize;
+	return &mBuffer[0];
+}
@@ -0,0 +1,135 @@
+//
+// Copyright (c) 2019 West Coast Code AB. All rights reserved.
+//
+
+#ifndef EVERSTORE_JOURNALCURSOR_HPP
+#define EVERSTORE_JOURNALCURSOR_HPP
+
+#include "../es_config.h"
+#include "../ESErrorCodes.h"
+#include "JournalFormat.hpp"
+
+/**
+ * Iterates over the events in a journal, one event at a time. Each event is numbered in the order it's written to the
+ * journal, starting with 0.
+ * <p />
+ * The journal is read in large blocks. The memory returned by {@link #event()} and {@link #timestamp()} is only valid
+ * until the cursor is moved.
+ */
+class JournalCursor
+{
+public:
+	/**
+	 * @param file The journal file
+	 * @param journalSize The size of the journal
+	 * @param format The format of the journal
+	 * @param byteOffset Where the cursor starts. Must be the beginning of a line (version 1) or record (version 2)
+	 * @param eventNumber The number of the first event found at the supplied offset
+	 */
+	JournalCursor(FILE* file, uint32_t journalSize, JournalFormat::Version format, uint32_t byteOffset,
+	              uint32_t eventNumber);
+
+	/**
+	 * Move to the next event
+	 *
+	 * @return <code>false</code> if no more events exists or if the journal could not be read
+	 */
+	bool next();
+
+	/**
+	 * Move forward until the next event is the supplied event
+	 *
+	 * @return <code>false</code> if the journal could not be read
+	 */
+	bool skipTo(uint32_t eventNumber);
+
+	/**
+	 * Move forward until the next event is the first event written at, or after, the supplied timestamp
+	 *
+	 * @param timestamp The timestamp, or the beginning of one, such as "2019-10-01T00:00"
+	 * @param length The length of the timestamp
+	 * @return <code>false</code> if the journal could not be read
+	 */
+	bool skipBefore(const char* timestamp, uint32_t length);
+
+	/**
+	 * @return ESERR_JOURNAL_READ if the journal could not be read
+	 */
+	inline ESErrorCode error() const { return mError; }
+
+	/**
+	 * @return The number of the current event
+	 */
+	inline uint32_t eventNumber() const { return mNextEventNumber - 1; }
+
+	/**
+	 * @return The number of the event that's returned when the cursor is moved
+	 */
+	inline uint32_t nextEventNumber() const { return mNextEventNumber; }
+
+	/**
+	 * @return Where the line or record that contains the current event begins
+	 */
+	inline uint32_t entryOffset() const { return mEntryOffset; }
+
+	/**
+	 * @return <code>true</code> if a cursor can be started at the entry offset with the current event number
+	 */
+	inline bool isEntryPoint() const { return mEntryPoint; }
+
+	/**
+	 * @return The timestamp of the current event. Not null-terminated
+	 */
+	inline const char* timestamp() const { return mTimestamp; }
+
+	/**
+	 * @return The current event
+	 */
+	inline const char* event() const { return mEvent; }
+
+	/**
+	 * @return The length of the current event
+	 */
+	inline uint32_t eventLength() const { return mEventLength; }
+
+private:
+	// Move to the next line in a version 1 journal
+	bool nextLine();
+
+	// Move to the next event in a version 2 journal
+	bool nextRecordEvent();
+
+	// Make sure that the supplied bytes are read into memory
+	const char* load(uint32_t offset, uint32_t size);
+
+private:
+	FILE* const mFile;
+	const JournalFormat::Version mFormat;
+
+	// Where the events end in the journal
+	uint32_t mEnd;
+
+	// Where the next line or record is found
+	uint32_t mOffset;
+
+	// Where the payload of the current record ends
+	uint32_t mRecordEnd;
+
+	uint32_t mNextEventNumber;
+	uint32_t mEntryOffset;
+	bool mEntryPoint;
+	const char* mTimestamp;
+	const char* mEvent;
+	uint32_t mEventLength;
+	ESErrorCode mError;
+
+	// Return the current event again when the cursor is moved
+	bool mHold;
+
+	// The part of the journal that's read into memory
+	vector<char> mBuffer;
+	uint32_t mBufferOffset;
+	uint32_t mBufferSize;
+};
+
+#endif //EVERSTORE_JOURNALCURSOR_HPP
@@ -0,0 +1,63 @@
+//
+// Copyright (c) 2019 West Coast Code AB. All rights reserved.
+//
+
+#include "JournalFormat.hpp"
+#include "../Crc32c.hpp"
+#include "../File/FileUtils.h"
+
+const char JournalFormat::Magic[4] = {'E', 'S', 'J', '2'};
+
+JournalFormat::FileHeader JournalFormat::fileHeader() {
+	FileHeader header;
+	memcpy(header.magic, Magic, sizeof(Magic));
+	header.version = V2;
+	return header;
+}
+
+bool JournalFormat::isFileHeader(const char* bytes, uint32_t size) {
+	if (size < sizeof(FileHeader)) {
+		return false;
+	}
+	const auto header = (const FileHeader*) bytes;
+	return memcmp(header->magic, Magic, sizeof(Magic)) == 0 && header->version == V2;
+}
+
+void JournalFormat::fillRecordHeader(RecordHeader* header, const Timestamp* t, MutableString events) {
+	header->length = events.length;
+	header->eventCount = countLines(events);
+	memcpy(header->timestamp, t->value, Timestamp::BytesLength);
+	header->reserved = 0;
+
+	const auto fields = (const char*) header + sizeof(header->crc);
+	header->crc = Crc32c::update(Crc32c::compute(fields, sizeof(RecordHeader) - sizeof(header->crc)),
+	                             events.str, events.length);
+}
+
+bool JournalFormat::isValid(const RecordHeader* header, const char* payload) {
+	const auto fields = (const char*) header + sizeof(header->crc);
+	const auto crc = Crc32c::update(Crc32c::compute(fields, sizeof(RecordHeader) - sizeof(header->crc)),
+	                                payload, header->length);
+	return crc == header->crc;
+}
+
+uint32_t JournalFormat::appendRecord(ByteBuffer* memory, const Timestamp* t, MutableString events) {
+	RecordHeader header;
+	fillRecordHeader(&header, t, events);
+
+	const uint32_t bytes = sizeof(RecordHeader) + events.length;
+	memory->ensureCapacity(bytes);
+	memory->write(&header, sizeof(RecordHeader));
+	memory->write(events.str, events.length);
+	return bytes;
+}
+
+uint32_t JournalFormat::countLines(MutableString events) {
+	uint32_t lines = 0;
+	const char* end = events.str + events.length;
+	for (const char* str = events.str; str != end; ++lines) {
+		const auto nl = (const char*) memchr(str, FileUtils::NL, end - str);
+		str = nl == nullptr ? end : nl + 1;
+	}
+	return lines;
+}
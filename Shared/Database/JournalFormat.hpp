@@ -0,0 +1,102 @@
+//
+// Copyright (c) 2019 West Coast Code AB. All rights reserved.
+//
+
+#ifndef EVERSTORE_JOURNALFORMAT_HPP
+#define EVERSTORE_JOURNALFORMAT_HPP
+
+#include "../es_config.h"
+#include "../Memory/ByteBuffer.h"
+#include "../Memory/MutableString.hpp"
+#include "Timestamp.h"
+
+/**
+ * The formats the journals can be stored in.
+ * <p />
+ * Version 1 is a text file where each event line is prefixed with the timestamp of the commit. The last commit is
+ * followed by an EOF-marker which is replaced with a new-line character when the next commit is written.
+ * <p />
+ * Version 2 starts with a file header followed by one framed record per commit. A record is never rewritten once
+ * it's appended, which means that only the last record has to be validated if the server crashes.
+ */
+struct JournalFormat
+{
+	enum Version : uint32_t
+	{
+		V1 = 1,
+		V2 = 2
+	};
+
+	/**
+	 * The header at the beginning of a version 2 journal
+	 */
+	struct FileHeader
+	{
+		char magic[4];
+		uint32_t version;
+	};
+
+	/**
+	 * The header in front of each record in a version 2 journal. The record's payload is the events exactly as
+	 * sent by the client.
+	 */
+	struct RecordHeader
+	{
+		// Checksum of the rest of the header and the payload
+		uint32_t crc;
+
+		// The size of the payload in bytes
+		uint32_t length;
+
+		// The number of event lines in the payload
+		uint32_t eventCount;
+
+		// When the commit was written
+		char timestamp[Timestamp::BytesLength];
+		char reserved;
+	};
+
+	// The magic bytes in the file header
+	static const char Magic[4];
+
+	/**
+	 * @return The file header for a version 2 journal
+	 */
+	static FileHeader fileHeader();
+
+	/**
+	 * Check to see if the supplied bytes is a version 2 file header
+	 */
+	static bool isFileHeader(const char* bytes, uint32_t size);
+
+	/**
+	 * Fill in a record header for the supplied events
+	 *
+	 * @param header The header
+	 * @param t Timestamp for the commit
+	 * @param events The payload
+	 */
+	static void fillRecordHeader(RecordHeader* header, const Timestamp* t, MutableString events);
+
+	/**
+	 * @return <code>true</code> if the checksum in the header matches the supplied payload
+	 */
+	static bool isValid(const RecordHeader* header, const char* payload);
+
+	/**
+	 * Format the supplied events as a record into the memory block
+	 *
+	 * @return How many bytes that are appended to the memory block
+	 */
+	static uint32_t appendRecord(ByteBuffer* memory, const Timestamp* t, MutableString events);
+
+	/**
+	 * @return How many event lines there are in the supplied events
+	 */
+	static uint32_t countLines(MutableString events);
+};
+
+static_assert(sizeof(JournalFormat::FileHeader) == 8, "Expected JournalFormat::FileHeader to be 8 byte(s)");
+static_assert(sizeof(JournalFormat::RecordHeader) == 36, "Expected JournalFormat::RecordHeader to be 36 byte(s)");
+
+#endif //EVERSTORE_JOURNALFORMAT_HPP
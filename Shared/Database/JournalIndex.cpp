@@ -0,0 +1,131 @@
+//
+// Copyright (c) 2019 West Coast Code AB. All rights reserved.
+//
+
+#include "JournalIndex.hpp"
+#include "../File/FileUtils.h"
+
+const string JournalIndex::Suffix(".idx");
+
+const char JournalIndex::Magic[4] = {'E', 'S', 'I', 'X'};
+
+JournalIndex::JournalIndex() : mFile(nullptr) {
+}
+
+JournalIndex::~JournalIndex() {
+	close();
+}
+
+bool JournalIndex::open(const Path& path, uint32_t journalSize) {
+	close();
+	mEntries.clear();
+	mFile = path.OpenOrCreate("r+b");
+	if (mFile == nullptr) {
+		return false;
+	}
+
+	// The index is rebuilt if it's written in another layout
+	const auto fileSize = FileUtils::getFileSize(mFile);
+	FileHeader header;
+	if (fileSize < sizeof(FileHeader) || fread(&header, sizeof(FileHeader), 1, mFile) != 1 ||
+	    memcmp(header.magic, Magic, sizeof(Magic)) != 0 || header.version != Version) {
+		reset();
+		return true;
+	}
+
+	// A partially written entry is ignored
+	const auto count = (fileSize - sizeof(FileHeader)) / sizeof(Entry);
+	mEntries.resize(count);
+	if (count > 0 && fread(&mEntries[0], sizeof(Entry), count, mFile) != count) {
+		mEntries.clear();
+	}
+
+	// The index is rebuilt if it's not in order
+	for (size_t i = 1; i < mEntries.size(); ++i) {
+		if (mEntries[i].byteOffset <= mEntries[i - 1].byteOffset ||
+		    mEntries[i].eventNumber < mEntries[i - 1].eventNumber) {
+			mEntries.clear();
+			break;
+		}
+	}
+
+	// Entries are removed if the journal is truncated, for example when an unfinished commit is removed
+	while (!mEntries.empty() && mEntries.back().byteOffset >= journalSize) {
+		mEntries.pop_back();
+	}
+	const auto size = sizeof(FileHeader) + mEntries.size() * sizeof(Entry);
+	if (size != fileSize) {
+		FileUtils::truncate(mFile, size);
+	}
+
+	setvbuf(mFile, nullptr, _IONBF, 0);
+	fseek(mFile, size, SEEK_SET);
+	return true;
+}
+
+void JournalIndex::reset() {
+	mEntries.clear();
+	FileUtils::truncate(mFile, 0);
+	setvbuf(mFile, nullptr, _IONBF, 0);
+	fseek(mFile, 0, SEEK_SET);
+
+	FileHeader header;
+	memcpy(header.magic, Magic, sizeof(Magic));
+	header.version = Version;
+	fwrite(&header, sizeof(header), 1, mFile);
+}
+
+void JournalIndex::close() {
+	if (mFile != nullptr) {
+		fclose(mFile);
+		mFile = nullptr;
+	}
+}
+
+void JournalIndex::add(uint32_t eventNumber, uint32_t byteOffset, const char* timestamp) {
+	if (!mEntries.empty() && byteOffset - mEntries.back().byteOffset < BytesBetweenEntries) {
+		return;
+	}
+
+	Entry entry;
+	entry.eventNumber = eventNumber;
+	entry.byteOffset = byteOffset;
+	memcpy(entry.timestamp, timestamp, Timestamp::BytesLength);
+	entry.timestamp[Timestamp::BytesLength] = 0;
+	mEntries.push_back(entry);
+
+	// The index is rebuilt from the journal if this fails
+	if (mFile != nullptr) {
+		fwrite(&entry, sizeof(entry), 1, mFile);
+	}
+}
+
+JournalIndex::Entry JournalIndex::find(uint32_t eventNumber, Entry first) const {
+	// Binary search for the first entry after the event
+	size_t low = 0;
+	size_t high = mEntries.size();
+	while (low < high) {
+		const auto mid = (low + high) / 2;
+		if (mEntries[mid].eventNumber <= eventNumber) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+	return low == 0 ? first : mEntries[low - 1];
+}
+
+JournalIndex::Entry JournalIndex::find(const char* timestamp, uint32_t length, Entry first) const {
+	// Binary search for the first entry that's not written before the timestamp
+	size_t low = 0;
+	size_t high = mEntries.size();
+	while (low < high) {
+		const auto mid = (low + high) / 2;
+		if (memcmp(mEntries[mid].timestamp, timestamp, length) < 0) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+	return low == 0 ? first : mEntries[low - 1];
+}
@@ -0,0 +1,121 @@
+//
+// Copyright (c) 2019 West Coast Code AB. All rights reserved.
+//
+
+#ifndef EVERSTORE_JOURNALINDEX_HPP
+#define EVERSTORE_JOURNALINDEX_HPP
+
+#include "../es_config.h"
+#include "../File/Path.hpp"
+#include "Timestamp.h"
+
+/**
+ * Sparse index that maps event numbers and timestamps to where they are found in a journal. An entry is added for
+ * roughly every 4 KB of the journal, which means that an event is found by reading at most one block after the entry.
+ * <p />
+ * Events are assumed to be written in timestamp order, which is true as long as the system clock never moves backwards.
+ * <p />
+ * The index is stored next to the journal and is only a cache: entries are appended without being synchronized with
+ * the disk, and entries that point past the end of the journal are removed when the index is opened. An index
+ * file that doesn't start with the expected header, such as one written in an older layout, is discarded.
+ */
+class JournalIndex
+{
+public:
+	/**
+	 * The header at the beginning of the index file
+	 */
+	struct FileHeader
+	{
+		char magic[4];
+		uint32_t version;
+	};
+
+	struct Entry
+	{
+		// The number of the first event at the byte offset
+		uint32_t eventNumber;
+
+		// Where the line (version 1) or record (version 2) begins
+		uint32_t byteOffset;
+
+		// When the first event at the byte offset was written
+		char timestamp[Timestamp::MaxLength];
+	};
+
+	// The file extension used by journal indexes
+	static const string Suffix;
+
+	// The magic bytes in the file header
+	static const char Magic[4];
+
+	// The layout of the entries. Increase this when the entry is changed
+	static const uint32_t Version = 2;
+
+	// How many bytes of the journal there are between each entry
+	static const uint32_t BytesBetweenEntries = 4096;
+
+	JournalIndex();
+
+	~JournalIndex();
+
+	/**
+	 * Open and load the index
+	 *
+	 * @param path Where the index is stored
+	 * @param journalSize The size of the journal the index belongs to
+	 * @return <code>false</code> if the index could not be opened
+	 */
+	bool open(const Path& path, uint32_t journalSize);
+
+	/**
+	 * Close the index file
+	 */
+	void close();
+
+	/**
+	 * Add an entry if the supplied offset is far enough from the previous entry
+	 *
+	 * @param eventNumber The number of the first event at the offset
+	 * @param byteOffset Where the line or record begins
+	 * @param timestamp When the first event was written
+	 */
+	void add(uint32_t eventNumber, uint32_t byteOffset, const char* timestamp);
+
+	/**
+	 * Find the entry closest to, but not after, the supplied event
+	 *
+	 * @param eventNumber The event
+	 * @param first The entry returned if no entry exists before the event
+	 */
+	Entry find(uint32_t eventNumber, Entry first) const;
+
+	/**
+	 * Find the closest entry that's written before the supplied timestamp
+	 *
+	 * @param timestamp The timestamp, or the beginning of one, such as "2019-10-01T00:00"
+	 * @param length The length of the timestamp
+	 * @param first The entry returned if no entry exists before the timestamp
+	 */
+	Entry find(const char* timestamp, uint32_t length, Entry first) const;
+
+	/**
+	 * @return The last entry in the index or <code>nullptr</code> if the index is empty
+	 */
+	inline const Entry* last() const { return mEntries.empty() ? nullptr : &mEntries.back(); }
+
+private:
+	/**
+	 * Remove all entries and write a new file header
+	 */
+	void reset();
+
+private:
+	FILE* mFile;
+	vector<Entry> mEntries;
+};
+
+static_assert(sizeof(JournalIndex::FileHeader) == 8, "Expected JournalIndex::FileHeader to be 8 byte(s)");
+static_assert(sizeof(JournalIndex::Entry) == 32, "Expected JournalIndex::Entry to be 32 byte(s)");
+
+#endif //EVERSTORE_JOURNALINDEX_HPP
@@ -5,11 +5,18 @@
 #include "OpenTransactions.hpp"
 #include "Journal.h"
 
+constexpr uint32_t OpenTransactions::MinCommitsBeforeTrim;
+constexpr uint32_t OpenTransactions::NoSlot;
+
+OpenTransactions::OpenTransactions()
+		: mFreeSlot(NoSlot), mOpenCount(0), mCommitSequence(0), mCommitsAfterTrim(0) {
+}
+
 OpenTransactions::~OpenTransactions() {
-	for (auto t : mTransactions) {
-		delete t;
+	for (auto& slot : mSlots) {
+		delete slot.transaction;
 	}
-	mTransactions.clear();
+	mSlots.clear();
 }
 
 TransactionID OpenTransactions::open(Journal* journal) {
@@ -18,22 +25,22 @@ TransactionID OpenTransactions::open(Journal* journal) {
 		return TransactionID(0);
 	}
 
-	// Try to reuse a transaction id
-	const uint32_t num = mTransactions.size();
-	for (uint32_t i = 0; i < num; ++i) {
-		auto t = mTransactions[i];
-		if (t == nullptr) {
-			const TransactionID id(i + 1u);
-			t = new Transaction(id, file, journal);
-			mTransactions[i] = t;
-			return id;
+	// Reuse the last freed slot, or create a new one
+	uint32_t index = mFreeSlot;
+	if (index != NoSlot) {
+		mFreeSlot = mSlots[index].nextFree;
+	} else {
+		if (mSlots.size() > TransactionID::MaxIndex) {
+			return TransactionID(0);
 		}
+		index = (uint32_t) mSlots.size();
+		mSlots.push_back({nullptr, 0, NoSlot, 0});
 	}
 
-	// Create a new transaction id
-	const TransactionID id(num + 1u);
-	auto const t = new Transaction(id, file, journal);
-	mTransactions.push_back(t);
+	auto& slot = mSlots[index];
+	const TransactionID id(index, slot.generation);
+	slot.transaction = new Transaction(id, file, journal, mCommitSequence);
+	mOpenCount++;
 	return id;
 }
 
@@ -45,38 +52,103 @@ Transaction* OpenTransactions::get(TransactionID id) {
 
 	// Ensure that we do not try to open a non-existing transaction
 	const auto value = id.AsIndex();
-	if (value >= mTransactions.size()) {
+	if (value >= mSlots.size()) {
 		return nullptr;
 	}
 
-	// Make sure that the transaction actually matches what we are requesting
-	return mTransactions[value];
+	// Make sure that the transaction actually matches what we are requesting. The slot might have been reused
+	auto const t = mSlots[value].transaction;
+	if (t == nullptr || t->id() != id) {
+		return nullptr;
+	}
+	return t;
 }
 
 void OpenTransactions::close(TransactionID id) {
-	// Only valid transactions
-	if (id.IsInvalid()) {
+	release(id, false);
+}
+
+void OpenTransactions::expire(TransactionID id) {
+	release(id, true);
+}
+
+bool OpenTransactions::expired(TransactionID id) const {
+	if (id.IsInvalid() || id.AsIndex() >= mSlots.size()) {
+		return false;
+	}
+	return mSlots[id.AsIndex()].expiredId == id.value;
+}
+
+void OpenTransactions::release(TransactionID id, bool expired) {
+	auto const t = get(id);
+	if (t == nullptr) {
 		return;
 	}
 
-	// Ensure that we do not try to close a non-existing transaction
+	// Remove the memory associated with the transaction and put the slot first in the free-list
 	const auto value = id.AsIndex();
-	if (value >= mTransactions.size()) {
+	auto& slot = mSlots[value];
+	delete t;
+	slot.transaction = nullptr;
+	slot.generation++;
+	slot.nextFree = mFreeSlot;
+	if (expired) {
+		slot.expiredId = id.value;
+	}
+	mFreeSlot = value;
+	mOpenCount--;
+
+	// No one can conflict with the logged commits anymore
+	if (mOpenCount == 0) {
+		mCommits.clear();
+		mCommitsAfterTrim = 0;
+	}
+}
+
+bool OpenTransactions::conflictsWith(const Transaction* t, const TypeSet& types) const {
+	if (mCommits.empty()) {
+		return false;
+	}
+
+	// The sequence numbers in the log follow each other, so the first commit after the transaction was opened is
+	// found without searching
+	const uint64_t first = mCommits.front().sequence;
+	const uint64_t start = t->commitSequence() >= first ? t->commitSequence() - first + 1u : 0u;
+	for (uint64_t i = start; i < mCommits.size(); ++i) {
+		if (mCommits[i].types.intersects(types)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void OpenTransactions::onTransactionCommitted(const TypeSet& changes) {
+	mCommitSequence++;
+
+	// The commit is only needed by the transactions that are open now
+	if (mOpenCount == 0) {
 		return;
 	}
+	mCommits.push_back({mCommitSequence, changes});
 
-	// Remove the memory associated with the transaction
-	auto const t = mTransactions[value];
-	if (t) {
-		delete t;
-		mTransactions[value] = nullptr;
+	// Finding the oldest transaction reads all open transactions, so it's only done when the log has grown by at least
+	// as many commits as there are open transactions
+	const uint32_t size = (uint32_t) mCommits.size();
+	if (size >= MinCommitsBeforeTrim && size >= 2u * mCommitsAfterTrim && size >= mOpenCount) {
+		trimCommits();
 	}
 }
 
-void OpenTransactions::onTransactionCommitted(Bits::Type changes) {
-	for (auto trans : mTransactions) {
-		if (trans != nullptr) {
-			trans->onTransactionCommitted(changes);
+void OpenTransactions::trimCommits() {
+	uint64_t oldest = mCommitSequence;
+	for (auto& slot : mSlots) {
+		if (slot.transaction != nullptr && slot.transaction->commitSequence() < oldest) {
+			oldest = slot.transaction->commitSequence();
 		}
 	}
+
+	while (!mCommits.empty() && mCommits.front().sequence <= oldest) {
+		mCommits.pop_front();
+	}
+	mCommitsAfterTrim = (uint32_t) mCommits.size();
 }
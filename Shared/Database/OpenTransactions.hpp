@@ -6,14 +6,23 @@
 #define EVERSTORE_OPENTRANSACTIONS_HPP
 
 #include "Transaction.h"
+#include "TypeSet.hpp"
 
 /**
- * Type that helps us keeping track of all opened transactions
+ * Type that helps us keeping track of all opened transactions. Closed transactions leave their index in a free-list, so
+ * that it can be reused by the next transaction without searching for it.
+ * <p />
+ * Every commit is given a sequence number. The types of the commits are kept in a log for as long as a transaction that
+ * was open before the commit is still open, and a transaction only checks the commits that were made after it was
+ * opened. Committing is therefore not affected by the number of transactions that are open but idle.
  */
 class OpenTransactions
 {
 public:
-	OpenTransactions() = default;
+	// The number of commits that are always kept in the log before the log is trimmed
+	static constexpr uint32_t MinCommitsBeforeTrim = 64u;
+
+	OpenTransactions();
 
 	~OpenTransactions();
 
@@ -40,13 +49,90 @@ public:
 	 */
 	void close(TransactionID id);
 
+	/**
+	 * Close the supplied transaction because it has been open for too long
+	 *
+	 * @param id The transaction ID
+	 */
+	void expire(TransactionID id);
+
+	/**
+	 * @param id The transaction ID
+	 * @return <code>true</code> if the transaction was the last one to expire with its index
+	 */
+	bool expired(TransactionID id) const;
+
+	/**
+	 * Check if any of the supplied types has been committed after the transaction was opened
+	 *
+	 * @param t The transaction
+	 * @param types The types that the transaction wants to commit
+	 * @return <code>true</code> if the transaction can't be committed
+	 */
+	bool conflictsWith(const Transaction* t, const TypeSet& types) const;
+
 	/**
 	 * Method called whenever a new transaction is committed
 	 */
-	void onTransactionCommitted(Bits::Type changes);
+	void onTransactionCommitted(const TypeSet& changes);
+
+	/**
+	 * @return <code>true</code> if no transactions are open
+	 */
+	inline bool empty() const { return mOpenCount == 0; }
+
+	/**
+	 * @return The number of commits that are kept for the open transactions
+	 */
+	inline uint32_t loggedCommits() const { return (uint32_t) mCommits.size(); }
+
+private:
+	/**
+	 * Remove the transaction and put its index first in the free-list
+	 */
+	void release(TransactionID id, bool expired);
+
+	/**
+	 * Remove the commits that were made before all open transactions were opened
+	 */
+	void trimCommits();
 
 private:
-	vector<Transaction*> mTransactions;
+	static constexpr uint32_t NoSlot = UINT32_MAX;
+
+	struct Slot
+	{
+		// The transaction; nullptr if the slot is free
+		Transaction* transaction;
+
+		// Increased every time the slot is freed
+		uint32_t generation;
+
+		// The next free slot, if this slot is free
+		uint32_t nextFree;
+
+		// The id of the last transaction that expired with this slot
+		uint32_t expiredId;
+	};
+
+	struct Commit
+	{
+		uint64_t sequence;
+		TypeSet types;
+	};
+
+	vector<Slot> mSlots;
+	uint32_t mFreeSlot;
+	uint32_t mOpenCount;
+
+	// The sequence number of the last commit
+	uint64_t mCommitSequence;
+
+	// The commits that an open transaction might conflict with, in sequence order
+	deque<Commit> mCommits;
+
+	// The number of logged commits when the log was last trimmed
+	uint32_t mCommitsAfterTrim;
 };
 
 
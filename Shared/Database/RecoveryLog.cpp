@@ -0,0 +1,166 @@
+//
+// Copyright (c) 2019 West Coast Code AB. All rights reserved.
+//
+
+#include "RecoveryLog.hpp"
+#include "Durability.hpp"
+#include "Journal.h"
+#include "../File/FileUtils.h"
+#include <map>
+
+const string RecoveryLog::Suffix(".recovery");
+
+namespace
+{
+	// The log is truncated when it grows larger than this and no journal writes are unfinished
+	const uint32_t MaxLogSize = 1024 * 1024;
+}
+
+RecoveryLog::RecoveryLog() : mFile(nullptr), mSize(0), mUnfinished(0) {
+}
+
+RecoveryLog::~RecoveryLog() {
+	close();
+}
+
+bool RecoveryLog::open(const Path& path) {
+	close();
+	mPath = path;
+	mFile = path.OpenOrCreate("ab");
+	if (mFile == nullptr) {
+		return false;
+	}
+
+	// Each record is written with one write call
+	setvbuf(mFile, nullptr, _IONBF, 0);
+	mSize = FileUtils::getFileSize(mFile);
+	mUnfinished = 0;
+	return true;
+}
+
+void RecoveryLog::close() {
+	if (mFile != nullptr) {
+		fclose(mFile);
+		mFile = nullptr;
+		remove(mPath.value.c_str());
+	}
+}
+
+ESErrorCode RecoveryLog::begin(const Path& journal, uint32_t journalSize, Durability* durability) {
+	if (mFile == nullptr) {
+		return ESERR_NO_ERROR;
+	}
+
+	if (!append(Begin, journal, journalSize)) {
+		return ESERR_JOURNAL_WRITE;
+	}
+	mUnfinished++;
+
+	// The journal is never written, so the write is finished already
+	if (!durability->persist(mFile)) {
+		end(journal);
+		return ESERR_JOURNAL_WRITE;
+	}
+	return ESERR_NO_ERROR;
+}
+
+ESErrorCode RecoveryLog::prepare(const Path& journal, uint32_t journalSize) {
+	if (mFile == nullptr) {
+		return ESERR_NO_ERROR;
+	}
+
+	if (!append(Begin, journal, journalSize)) {
+		return ESERR_JOURNAL_WRITE;
+	}
+	mUnfinished++;
+	return ESERR_NO_ERROR;
+}
+
+ESErrorCode RecoveryLog::persist(Durability* durability) {
+	if (mFile == nullptr) {
+		return ESERR_NO_ERROR;
+	}
+
+	if (!durability->persist(mFile)) {
+		return ESERR_JOURNAL_WRITE;
+	}
+	return ESERR_NO_ERROR;
+}
+
+void RecoveryLog::end(const Path& journal) {
+	if (mFile == nullptr) {
+		return;
+	}
+
+	// The log can be emptied once no journal writes are unfinished, which isn't the case if more journals are written
+	// at the same time
+	if (mUnfinished > 0) {
+		mUnfinished--;
+	}
+	if (mUnfinished == 0 && mSize + sizeof(RecordHeader) + journal.value.length() > MaxLogSize) {
+		if (FileUtils::truncate(mFile, 0)) {
+			mSize = 0;
+			return;
+		}
+	}
+	append(End, journal, 0);
+}
+
+bool RecoveryLog::append(RecordType type, const Path& journal, uint32_t journalSize) {
+	RecordHeader header;
+	header.type = type;
+	header.journalSize = journalSize;
+	header.pathLength = journal.value.length();
+
+	mRecord.assign((const char*) &header, sizeof(header));
+	mRecord.append(journal.value);
+	if (fwrite(mRecord.c_str(), mRecord.length(), 1, mFile) != 1) {
+		return false;
+	}
+	mSize += mRecord.length();
+	return true;
+}
+
+bool RecoveryLog::replay(const Path& path, const Path& journalDir) {
+	FILE* file = path.Open("rb");
+	if (file == nullptr) {
+		return true;
+	}
+
+	// Find the journals where the last write never finished. A record that's only partially written, or that has a
+	// path length that no record is written with, is ignored together with everything after it
+	std::map<string, uint32_t> unfinished;
+	RecordHeader header;
+	while (fread(&header, sizeof(header), 1, file) == 1) {
+		if (header.pathLength == 0 || header.pathLength > MaxPathLength) {
+			break;
+		}
+		string journal(header.pathLength, '\0');
+		if (fread(&journal[0], header.pathLength, 1, file) != 1) {
+			break;
+		}
+
+		if (header.type == Begin) {
+			unfinished[journal] = header.journalSize;
+		} else {
+			unfinished.erase(journal);
+		}
+	}
+	fclose(file);
+
+	for (auto& pair : unfinished) {
+		const Path journalFile = journalDir + Path(pair.first);
+		Log::Write(Log::Info, "Validating consistency for journal: %s", journalFile.value.c_str());
+		Journal j(journalFile);
+		if (!j.performConsistencyCheck(pair.second)) {
+			Log::Write(Log::Error, "Consistency check failed for journal: %s", journalFile.value.c_str());
+			return false;
+		}
+	}
+
+	return remove(path.value.c_str()) == 0;
+}
+
+Path RecoveryLog::forWorker(ProcessID id) {
+	return Path(string("worker.") + id.ToString() + Suffix);
+}
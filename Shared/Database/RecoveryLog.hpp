@@ -0,0 +1,127 @@
+//
+// Copyright (c) 2019 West Coast Code AB. All rights reserved.
+//
+
+#ifndef EVERSTORE_RECOVERYLOG_HPP
+#define EVERSTORE_RECOVERYLOG_HPP
+
+#include "../es_config.h"
+#include "../ESErrorCodes.h"
+#include "../File/Path.hpp"
+#include "../Process/ProcessID.h"
+
+class Durability;
+
+/**
+ * Append-only log where the intent of each journal write is recorded. If the process crashes while a commit is written
+ * then the log tells which journal that has to be repaired and what size the journal had before the commit.
+ * <p />
+ * Each worker has its own log, since a journal is only written to by one worker.
+ */
+class RecoveryLog
+{
+public:
+	// The file extension used by recovery logs
+	static const string Suffix;
+
+	// The longest journal path that a record can have. Same as the longest path a worker accepts
+	static const uint32_t MaxPathLength = 1024;
+
+	RecoveryLog();
+
+	~RecoveryLog();
+
+	/**
+	 * Open the log. Everything already in the log is expected to be replayed
+	 *
+	 * @param path The path to the log file
+	 * @return <code>true</code> if successful
+	 */
+	bool open(const Path& path);
+
+	/**
+	 * Close the log and remove it, since there are no unfinished journal writes
+	 */
+	void close();
+
+	/**
+	 * Record that commits are about to be written to the supplied journal
+	 *
+	 * @param journal The path to the journal
+	 * @param journalSize The size of the journal before the commits are written
+	 * @param durability Decides if the record is flushed or synchronized with the disk before the journal is written
+	 * @return ESERR_NO_ERROR if the record is written
+	 */
+	ESErrorCode begin(const Path& journal, uint32_t journalSize, Durability* durability);
+
+	/**
+	 * Record that commits are about to be written to the supplied journal, without making the record durable. Used
+	 * when many journals are written at the same time, followed by one call to {@link #persist(Durability*)}
+	 *
+	 * @param journal The path to the journal
+	 * @param journalSize The size of the journal before the commits are written
+	 * @return ESERR_NO_ERROR if the record is written
+	 */
+	ESErrorCode prepare(const Path& journal, uint32_t journalSize);
+
+	/**
+	 * Make the records written so far as durable as the supplied durability requires
+	 *
+	 * @param durability Decides if the records are flushed or synchronized with the disk
+	 * @return ESERR_NO_ERROR if successful
+	 */
+	ESErrorCode persist(Durability* durability);
+
+	/**
+	 * Record that the commits are written to the supplied journal, or that they never will be. Must be called once
+	 * for each successful call to {@link #begin(const Path&, uint32_t, Durability*)} or
+	 * {@link #prepare(const Path&, uint32_t)}
+	 *
+	 * @param journal The path to the journal
+	 */
+	void end(const Path& journal);
+
+	/**
+	 * Check that all journals with unfinished writes in the supplied log are consistent. The log is removed if successful
+	 *
+	 * @param path The path to the log file
+	 * @param journalDir The directory the journal paths in the log are relative to
+	 * @return <code>true</code> if successful
+	 */
+	static bool replay(const Path& path, const Path& journalDir);
+
+	/**
+	 * @return The path to the log for the supplied worker, relative to the journal directory
+	 */
+	static Path forWorker(ProcessID id);
+
+private:
+	enum RecordType : uint32_t
+	{
+		Begin = 1,
+		End
+	};
+
+	struct RecordHeader
+	{
+		RecordType type;
+		uint32_t journalSize;
+		uint32_t pathLength;
+	};
+
+	// Append a record to the log file
+	bool append(RecordType type, const Path& journal, uint32_t journalSize);
+
+private:
+	Path mPath;
+	FILE* mFile;
+	uint32_t mSize;
+
+	// The number of Begin records without a matching End record
+	uint32_t mUnfinished;
+
+	// Memory used when a record is appended
+	string mRecord;
+};
+
+#endif //EVERSTORE_RECOVERYLOG_HPP
@@ -1,4 +1,5 @@
 #include "Timestamp.h"
+#include <ctime>
 
 using namespace std;
 using namespace chrono;
@@ -21,23 +22,78 @@ namespace
 
 #endif
 
-	void populateTimestamp(char* _out) {
-		auto now = system_clock::now();
-		auto ms = duration_cast<milliseconds>(now.time_since_epoch());
-		auto fractional_seconds = ms.count() % 1000;
+	// The date and time, up to and including the '.' before the milliseconds, for the last second used by this thread
+	struct SecondCache
+	{
+		int64_t second;
+		char prefix[Timestamp::FractalPos];
+	};
 
-		time_t tt = system_clock::to_time_t(now);
+	thread_local SecondCache gSecondCache = {-1, {0}};
+
+	void formatSeconds(time_t tt, char* _out) {
 		tm utc_tm;
 		gmtime_r(&tt, &utc_tm);
 		strftime(_out, Timestamp::MaxLength, "%Y-%m-%dT%H:%M:%S.000", &utc_tm);
+	}
+
+	void formatMillis(uint32_t millis, char* _out) {
+		_out[Timestamp::FractalPos] = (char) ('0' + millis / 100);
+		_out[Timestamp::FractalPos + 1] = (char) ('0' + (millis / 10) % 10);
+		_out[Timestamp::FractalPos + 2] = (char) ('0' + millis % 10);
+	}
+
+#if defined(CLOCK_REALTIME_COARSE)
 
-		static const char* FRACTAL_FORMAT = "%03d";
-		char fractals[4] = {0};
-		sprintf(fractals, FRACTAL_FORMAT, fractional_seconds);
-		memcpy(&_out[Timestamp::FractalPos], fractals, 3);
+	// The coarse clock avoids reading the hardware clock, but is only used if it's precise enough for milliseconds
+	clockid_t selectClock() {
+		timespec resolution;
+		if (clock_getres(CLOCK_REALTIME_COARSE, &resolution) == 0 && resolution.tv_sec == 0 &&
+		    resolution.tv_nsec <= 1000000) {
+			return CLOCK_REALTIME_COARSE;
+		}
+		return CLOCK_REALTIME;
 	}
+
+	const clockid_t gClock = selectClock();
+
+	void currentTime(int64_t* seconds, uint32_t* millis) {
+		timespec now;
+		clock_gettime(gClock, &now);
+		*seconds = now.tv_sec;
+		*millis = (uint32_t) (now.tv_nsec / 1000000);
+	}
+
+#else
+
+	void currentTime(int64_t* seconds, uint32_t* millis) {
+		const auto ms = duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+		*seconds = ms / 1000;
+		*millis = (uint32_t) (ms % 1000);
+	}
+
+#endif
 }
 
 Timestamp::Timestamp() {
-	populateTimestamp(value);
+	int64_t seconds;
+	uint32_t millis;
+	currentTime(&seconds, &millis);
+
+	SecondCache& cache = gSecondCache;
+	if (cache.second != seconds) {
+		formatSeconds((time_t) seconds, value);
+		memcpy(cache.prefix, value, FractalPos);
+		cache.second = seconds;
+	} else {
+		memcpy(value, cache.prefix, FractalPos);
+	}
+	formatMillis(millis, value);
+	value[BytesLength] = 0;
+}
+
+Timestamp::Timestamp(const system_clock::time_point& time) {
+	const auto ms = duration_cast<milliseconds>(time.time_since_epoch());
+	formatSeconds(system_clock::to_time_t(time), value);
+	formatMillis((uint32_t) (ms.count() % 1000), value);
 }
@@ -2,6 +2,7 @@
 #define _EVERSTORE_TIMESTAMP_H_
 
 #include "../es_config.h"
+#include <chrono>
 
 
 /**
@@ -17,7 +18,16 @@ struct Timestamp
 
 	char value[MaxLength];
 
+	/**
+	 * Create a timestamp for the current time. The date and time, up to the second, is cached per thread so that only
+	 * the milliseconds are formatted when the second is the same as for the previous timestamp
+	 */
 	Timestamp();
+
+	/**
+	 * Create a timestamp for the supplied time. The entire timestamp is formatted without using the cache
+	 */
+	explicit Timestamp(const chrono::system_clock::time_point& time);
 };
 
 #endif
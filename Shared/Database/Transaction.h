@@ -5,8 +5,8 @@
 #include "../Event.h"
 #include "../Memory/ByteBuffer.h"
 #include "TransactionID.h"
-#include "../Bits.hpp"
 #include "../Memory/MutableString.hpp"
+#include "../TimerWheel.h"
 
 class Journal;
 
@@ -17,23 +17,17 @@ class FileOutputStream;
 class Transaction
 {
 public:
-	Transaction(TransactionID id, FILE* file, Journal* journal);
-
-	// Commit this transaction and save it to the HDD in a way that can be fixed if the worker closes ungracefully
-	void save(MutableString events);
+	Transaction(TransactionID id, FILE* file, Journal* journal, uint64_t commitSequence);
 
 	// Retrieves the transaction id
 	inline const TransactionID id() const { return mId; }
 
-	// Check if this transaction conflicts with any of the supplied types
-	inline bool conflictsWith(Bits::Type types) const {
-		return Bits::IsSet(mTransactionTypesBeforeCommit, types);
-	}
+	// The journal that the transaction is opened for
+	inline Journal* journal() const { return mJournal; }
 
-	// Method called when a transaction is committed on the same journal
-	inline void onTransactionCommitted(Bits::Type types) {
-		mTransactionTypesBeforeCommit = Bits::Set(mTransactionTypesBeforeCommit, types);
-	}
+	// The sequence number of the last commit on the journal when this transaction was opened. Only the commits after
+	// it can conflict with this transaction
+	inline uint64_t commitSequence() const { return mCommitSequence; }
 
 	// Retrieves the journal size from this transactions view-point
 	/**
@@ -45,12 +39,16 @@ public:
 	// Does this transaction indicate that the journal will be created on commit
 	inline bool createJournal() const { return mJournalSize == 0; }
 
+public:
+	// Linked while the transaction waits to expire
+	TimerWheelLink<Transaction> expiryLink;
+
 private:
 	const TransactionID mId;
 	FILE* const mFile;
 	Journal* mJournal;
 	uint32_t mJournalSize;
-	Bits::Type mTransactionTypesBeforeCommit;
+	const uint64_t mCommitSequence;
 };
 
 #endif
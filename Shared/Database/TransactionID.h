@@ -4,27 +4,44 @@
 #include <cinttypes>
 
 /**
- * Represents the ID for a specific transaction
+ * Represents the ID for a specific transaction. The lower bits are the index of the transaction plus one, and the upper
+ * bits are the generation of the index. The generation is increased every time an index is reused, so that an id that's
+ * kept after its transaction is closed never finds a newer transaction
  */
 struct TransactionID
 {
+	// The number of bits used by the index
+	static constexpr uint32_t IndexBits = 20u;
+
+	// The largest index that can be represented
+	static constexpr uint32_t MaxIndex = (1u << IndexBits) - 2u;
+
 	const uint32_t value;
 
 	explicit TransactionID(const uint32_t value)
 			: value(value) {
 	}
 
+	TransactionID(uint32_t index, uint32_t generation)
+			: value((generation << IndexBits) | (index + 1u)) {
+	}
+
 	TransactionID(const TransactionID& rhs) = default;
 
-	inline uint32_t AsIndex() const { return value - 1u; }
+	inline uint32_t AsIndex() const { return (value & IndexMask) - 1u; }
+
+	inline uint32_t Generation() const { return value >> IndexBits; }
 
-	inline bool IsValid() const { return value > 0; }
+	inline bool IsValid() const { return (value & IndexMask) > 0; }
 
-	inline bool IsInvalid() const { return value == 0; }
+	inline bool IsInvalid() const { return (value & IndexMask) == 0; }
 
 	inline bool operator!=(const TransactionID& rhs) const { return value != rhs.value; }
 
 	inline bool operator==(const TransactionID& rhs) const { return value == rhs.value; }
+
+private:
+	static constexpr uint32_t IndexMask = (1u << IndexBits) - 1u;
 };
 
 static_assert(sizeof(TransactionID) == 4, "TransactionID is assumed to be 4 bytes in size");
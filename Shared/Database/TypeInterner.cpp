@@ -0,0 +1,85 @@
+//
+// Copyright (c) 2019 West Coast Code AB. All rights reserved.
+//
+
+#include "TypeInterner.hpp"
+
+constexpr uint32_t TypeInterner::EmptyHash;
+constexpr uint32_t TypeInterner::NotFound;
+
+namespace
+{
+	// The number of entries in a new table. Always a power of two
+	const uint32_t InitialEntries = 256u;
+}
+
+TypeInterner::TypeInterner()
+		: mEntries(InitialEntries, {0, NotFound, 0, 0}), mCount(0) {
+}
+
+uint32_t TypeInterner::hash(const char* name, uint32_t length) {
+	uint32_t h = EmptyHash;
+	for (uint32_t i = 0; i < length; ++i) {
+		h = hash(h, name[i]);
+	}
+	return h;
+}
+
+uint32_t TypeInterner::intern(const char* name, uint32_t length, uint32_t hash) {
+	uint32_t index = indexOf(name, length, hash);
+	if (mEntries[index].id != NotFound) {
+		return mEntries[index].id;
+	}
+
+	// Keep the table at most half full, so that a name is found after a few entries
+	if ((mCount + 1) * 2 > mEntries.size()) {
+		grow();
+		index = indexOf(name, length, hash);
+	}
+
+	auto& entry = mEntries[index];
+	entry.hash = hash;
+	entry.id = mCount++;
+	entry.offset = (uint32_t) mNames.size();
+	entry.length = length;
+	mNames.insert(mNames.end(), name, name + length);
+	return entry.id;
+}
+
+uint32_t TypeInterner::find(const char* name, uint32_t length) const {
+	return mEntries[indexOf(name, length, hash(name, length))].id;
+}
+
+uint32_t TypeInterner::indexOf(const char* name, uint32_t length, uint32_t hash) const {
+	const uint32_t mask = (uint32_t) mEntries.size() - 1u;
+	uint32_t index = hash & mask;
+	while (true) {
+		const auto& entry = mEntries[index];
+		if (entry.id == NotFound) {
+			return index;
+		}
+		if (entry.hash == hash && entry.length == length &&
+		    (length == 0 || memcmp(&mNames[entry.offset], name, length) == 0)) {
+			return index;
+		}
+		index = (index + 1u) & mask;
+	}
+}
+
+void TypeInterner::grow() {
+	vector<Entry> entries(mEntries.size() * 2, {0, NotFound, 0, 0});
+	const uint32_t mask = (uint32_t) entries.size() - 1u;
+
+	// The hashes are kept, so the names don't have to be read again
+	for (const auto& entry : mEntries) {
+		if (entry.id == NotFound) {
+			continue;
+		}
+		uint32_t index = entry.hash & mask;
+		while (entries[index].id != NotFound) {
+			index = (index + 1u) & mask;
+		}
+		entries[index] = entry;
+	}
+	mEntries.swap(entries);
+}
@@ -0,0 +1,94 @@
+//
+// Copyright (c) 2019 West Coast Code AB. All rights reserved.
+//
+
+#ifndef EVERSTORE_TYPEINTERNER_HPP
+#define EVERSTORE_TYPEINTERNER_HPP
+
+#include "../es_config.h"
+
+/**
+ * Gives each event type name an id, starting at zero, in the order the names are first seen. The names are looked up
+ * directly from the request memory: the caller supplies a pointer and a length, together with a hash that can be
+ * computed while the names are split, so that a name that's already known is found without allocating any memory.
+ * <p />
+ * The ids are kept in an open-addressing table with linear probing, which stores the hash of each name so that only
+ * names with the same hash are compared. The names are copied into one buffer when they are first seen.
+ */
+class TypeInterner
+{
+public:
+	// The hash of an empty name
+	static constexpr uint32_t EmptyHash = 2166136261u;
+
+	// Returned when a name is not found
+	static constexpr uint32_t NotFound = UINT32_MAX;
+
+	TypeInterner();
+
+	/**
+	 * Add the next character of a name to its hash
+	 *
+	 * @param hash The hash of the characters before
+	 * @param c The next character
+	 * @return The hash including the character
+	 */
+	inline static uint32_t hash(uint32_t hash, char c) { return (hash ^ (uint8_t) c) * 16777619u; }
+
+	/**
+	 * @param name The name
+	 * @param length The length of the name
+	 * @return The hash of the name
+	 */
+	static uint32_t hash(const char* name, uint32_t length);
+
+	/**
+	 * Retrieve the id of a name. The name is given the next id if it's not seen before
+	 *
+	 * @param name The name. Does not have to end with NULL
+	 * @param length The length of the name
+	 * @param hash The hash of the name
+	 * @return The id
+	 */
+	uint32_t intern(const char* name, uint32_t length, uint32_t hash);
+
+	inline uint32_t intern(const char* name, uint32_t length) { return intern(name, length, hash(name, length)); }
+
+	/**
+	 * @param name The name. Does not have to end with NULL
+	 * @param length The length of the name
+	 * @return The id of the name; NotFound if the name is not seen before
+	 */
+	uint32_t find(const char* name, uint32_t length) const;
+
+	/**
+	 * @return The number of names
+	 */
+	inline uint32_t size() const { return mCount; }
+
+private:
+	struct Entry
+	{
+		uint32_t hash;
+
+		// The id of the name; NotFound if the entry is empty
+		uint32_t id;
+
+		// Where the name is found in the names buffer
+		uint32_t offset;
+		uint32_t length;
+	};
+
+	// The index of the entry with the supplied name, or of the empty entry where it should be added
+	uint32_t indexOf(const char* name, uint32_t length, uint32_t hash) const;
+
+	// Double the size of the table
+	void grow();
+
+private:
+	vector<Entry> mEntries;
+	vector<char> mNames;
+	uint32_t mCount;
+};
+
+#endif //EVERSTORE_TYPEINTERNER_HPP
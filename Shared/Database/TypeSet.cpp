@@ -0,0 +1,117 @@
+//
+// Copyright (c) 2019 West Coast Code AB. All rights reserved.
+//
+
+#include "TypeSet.hpp"
+#include <algorithm>
+
+constexpr uint32_t TypeSet::NewJournal;
+constexpr uint32_t TypeSet::InlineTypes;
+constexpr uint32_t TypeSet::InlineLargeTypes;
+
+TypeSet::TypeSet()
+		: mLargeCount(0) {
+	memset(mInline, 0, sizeof(mInline));
+}
+
+TypeSet::TypeSet(std::initializer_list<uint32_t> types)
+		: TypeSet() {
+	for (auto type : types) {
+		add(type);
+	}
+}
+
+void TypeSet::add(uint32_t type) {
+	if (type < InlineTypes) {
+		mInline[type / BitsPerWord] |= 1ull << (type % BitsPerWord);
+		return;
+	}
+
+	const uint32_t* const ids = large();
+	const auto position = (uint32_t) (std::lower_bound(ids, ids + mLargeCount, type) - ids);
+	if (position < mLargeCount && ids[position] == type) {
+		return;
+	}
+
+	// All ids are moved to the vector when the inline array is full
+	if (mLargeCount < InlineLargeTypes) {
+		memmove(mLarge + position + 1, mLarge + position, (mLargeCount - position) * sizeof(uint32_t));
+		mLarge[position] = type;
+	} else {
+		if (mLargeCount == InlineLargeTypes) {
+			mOverflow.assign(mLarge, mLarge + InlineLargeTypes);
+		}
+		mOverflow.insert(mOverflow.begin() + position, type);
+	}
+	mLargeCount++;
+}
+
+void TypeSet::add(const TypeSet& types) {
+	for (uint32_t i = 0; i < InlineWords; ++i) {
+		mInline[i] |= types.mInline[i];
+	}
+
+	const uint32_t* const ids = types.large();
+	for (uint32_t i = 0; i < types.mLargeCount; ++i) {
+		add(ids[i]);
+	}
+}
+
+bool TypeSet::contains(uint32_t type) const {
+	if (type < InlineTypes) {
+		return (mInline[type / BitsPerWord] & (1ull << (type % BitsPerWord))) != 0;
+	}
+	return containsLarge(type);
+}
+
+bool TypeSet::containsLarge(uint32_t type) const {
+	const uint32_t* const ids = large();
+	return std::binary_search(ids, ids + mLargeCount, type);
+}
+
+bool TypeSet::intersects(const TypeSet& types) const {
+	for (uint32_t i = 0; i < InlineWords; ++i) {
+		if ((mInline[i] & types.mInline[i]) != 0) {
+			return true;
+		}
+	}
+
+	// Look for the ids of the smaller set in the larger one
+	const TypeSet& smaller = mLargeCount <= types.mLargeCount ? *this : types;
+	const TypeSet& larger = mLargeCount <= types.mLargeCount ? types : *this;
+	const uint32_t* const ids = smaller.large();
+	for (uint32_t i = 0; i < smaller.mLargeCount; ++i) {
+		if (larger.containsLarge(ids[i])) {
+			return true;
+		}
+	}
+	return false;
+}
+
+uint32_t TypeSet::size() const {
+	uint32_t count = mLargeCount;
+	for (uint32_t i = 0; i < InlineWords; ++i) {
+		for (uint64_t bits = mInline[i]; bits != 0; bits &= bits - 1) {
+			count++;
+		}
+	}
+	return count;
+}
+
+bool TypeSet::empty() const {
+	if (mLargeCount > 0) {
+		return false;
+	}
+	for (uint32_t i = 0; i < InlineWords; ++i) {
+		if (mInline[i] != 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void TypeSet::clear() {
+	memset(mInline, 0, sizeof(mInline));
+	mLargeCount = 0;
+	mOverflow.clear();
+}
@@ -0,0 +1,96 @@
+//
+// Copyright (c) 2019 West Coast Code AB. All rights reserved.
+//
+
+#ifndef EVERSTORE_TYPESET_HPP
+#define EVERSTORE_TYPESET_HPP
+
+#include "../es_config.h"
+#include <initializer_list>
+
+/**
+ * A set of event types. Each type is identified by an id that the worker assigns the first time the type name is
+ * seen, starting at zero. The first InlineTypes ids are stored in a bitmap. Ids above that are kept in a sorted array,
+ * where the first InlineLargeTypes ids are stored in the set itself, so the types of a commit are added, copied and
+ * checked for conflicts without allocating any memory unless the commit has many types with large ids.
+ * <p />
+ * Checking if two sets intersect follows the number of types in the sets and not the largest id that the worker has
+ * given, since the ids are interned for all journals in the worker.
+ */
+class TypeSet
+{
+public:
+	// The id reserved by the worker for the built-in type that represents when a journal is created
+	static constexpr uint32_t NewJournal = 0u;
+
+	// The number of type ids that are stored in the bitmap
+	static constexpr uint32_t InlineTypes = 128u;
+
+	// The number of ids above InlineTypes that are stored without allocating memory
+	static constexpr uint32_t InlineLargeTypes = 6u;
+
+	TypeSet();
+
+	TypeSet(std::initializer_list<uint32_t> types);
+
+	/**
+	 * Add a type to this set
+	 *
+	 * @param type The type id
+	 */
+	void add(uint32_t type);
+
+	/**
+	 * Add all types in the supplied set to this set
+	 *
+	 * @param types
+	 */
+	void add(const TypeSet& types);
+
+	/**
+	 * @param type The type id
+	 * @return <code>true</code> if the type is part of this set
+	 */
+	bool contains(uint32_t type) const;
+
+	/**
+	 * @param types
+	 * @return <code>true</code> if at least one type is part of both sets
+	 */
+	bool intersects(const TypeSet& types) const;
+
+	/**
+	 * @return The number of types in this set
+	 */
+	uint32_t size() const;
+
+	/**
+	 * @return <code>true</code> if this set has no types
+	 */
+	bool empty() const;
+
+	/**
+	 * Remove all types. Memory allocated for large type ids is kept, so that it can be reused
+	 */
+	void clear();
+
+private:
+	static constexpr uint32_t BitsPerWord = 64u;
+	static constexpr uint32_t InlineWords = InlineTypes / BitsPerWord;
+
+	// The sorted ids above InlineTypes
+	inline const uint32_t* large() const { return mLargeCount <= InlineLargeTypes ? mLarge : mOverflow.data(); }
+
+	// Is the id part of the sorted ids
+	bool containsLarge(uint32_t type) const;
+
+private:
+	uint64_t mInline[InlineWords];
+
+	// The number of ids above InlineTypes. They're stored in mLarge until it's full, and then all of them in mOverflow
+	uint32_t mLargeCount;
+	uint32_t mLarge[InlineLargeTypes];
+	vector<uint32_t> mOverflow;
+};
+
+#endif //EVERSTORE_TYPESET_HPP
@@ -33,6 +33,7 @@ const char* _ES_FATAL_ERROR_CODE_STRING[ESERR_FATAL_COUNT - ESERR_FATAL] = {
 
 		// File
 		"Could not create lock file. Make sure that your application has the neccessary system rights to be able to write to the data directory",
+		"Could not open the recovery log. Make sure that your application has the neccessary system rights to be able to write to the journal directory",
 
 		// Mutex
 		"Could not create mutex",
@@ -69,12 +70,23 @@ const char* _ES_ERROR_CODE_STRING[ESERR_COUNT] = {
 		"The supplied transaction does not exist.",
 		"Conflict occured when the transaction was committed",
 		"The supplied journal path is invalid",
+		"Could not write journal data. The disk might be full or the file is not writable.",
 
 		"Could not send data to client",
 		"Socket disconnected",
 		"Socket not attached",
 
 		"Mutex is already destroyed",
+
+		// Commits sent in many parts
+		"The commit is larger than the server allows. The unfinished commits from a connection are limited as well",
+		"The parts of the commit did not add up to the size of its events",
+
+		// Transactions
+		"The transaction was open for too long and has expired",
+
+		// Type ids
+		"The commit refers to a type id that has not been registered with the worker",
 };
 
 const char* _ES_ERROR_CODE_UNKNOWN = "Unknown error code";
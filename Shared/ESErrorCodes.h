@@ -37,6 +37,7 @@ enum ESFatalErrorCodes : ESErrorCode {
 	ESERR_PIPE_CONNECT,
 
 	ESERR_FILE_LOCK_FAILED,
+	ESERR_RECOVERY_LOG_OPEN,
 
 	ESERR_MUTEX_CREATE,
 	ESERR_MUTEX_DESTROYED,
@@ -71,6 +72,7 @@ enum ESErrorCodes : ESErrorCode {
 	ESERR_JOURNAL_TRANSACTION_DOES_NOT_EXIST,
 	ESERR_JOURNAL_TRANSACTION_CONFLICT,
 	ESERR_JOURNAL_PATH_INVALID,
+	ESERR_JOURNAL_WRITE,
 
 	ESERR_SOCKET_SEND,
 	ESERR_SOCKET_DISCONNECTED,
@@ -78,6 +80,11 @@ enum ESErrorCodes : ESErrorCode {
 
 	ESERR_MUTEX_ALREADY_DESTROYED,
 
+	ESERR_JOURNAL_COMMIT_TOO_LARGE,
+	ESERR_JOURNAL_COMMIT_INCOMPLETE,
+	ESERR_JOURNAL_TRANSACTION_EXPIRED,
+	ESERR_JOURNAL_TYPE_NOT_REGISTERED,
+
 	ESERR_COUNT,
 };
 
@@ -1,17 +1,28 @@
 #include "FileInputStream.h"
 #include "FileUtils.h"
+#include "LineScanner.h"
 #include "../Database/Timestamp.h"
 
 static const uint32_t TEMP_READ_BLOCK_SIZE = 4096;
 static const uint32_t TIMESTAMP_AND_SPACE_LEN = Timestamp::BytesLength + 1;
 
-FileInputStream::FileInputStream(FILE* file, uint32_t fileSize, uint32_t byteOffset)
-		: mFile(file), mFileSize(fileSize), mByteOffset(byteOffset), mSeekAfterRead(TIMESTAMP_AND_SPACE_LEN) {
+constexpr uint32_t FileInputStream::BlockSize;
+
+FileInputStream::FileInputStream(FILE* file, uint32_t fileSize, uint32_t byteOffset, JournalFormat::Version format,
+                                 std::shared_ptr<const char> mapping)
+		: mFile(file), mMappedFile(mapping), mMapping(mapping.get()), mFileSize(fileSize), mByteOffset(byteOffset),
+		  mSeekAfterRead(TIMESTAMP_AND_SPACE_LEN),
+		  mPendingOffset(0), mPendingSize(0), mRecordLeft(0), mLineStart(false), mBlockOffset(0), mBlockSize(0),
+		  mFirstRecord(true) {
 	assert(file != nullptr);
+
+	// The file header is never part of the result
+	if (format == JournalFormat::V2 && mByteOffset < sizeof(JournalFormat::FileHeader)) {
+		mByteOffset = sizeof(JournalFormat::FileHeader);
+	}
 	if (mByteOffset > mFileSize) {
 		mByteOffset = mFileSize;
 	}
-	fseek(mFile, mByteOffset, SEEK_SET);
 }
 
 ESErrorCode FileInputStream::readBytes(ByteBuffer* memory, uint32_t size) {
@@ -20,12 +31,20 @@ ESErrorCode FileInputStream::readBytes(ByteBuffer* memory, uint32_t size) {
 		return ESERR_NO_ERROR;
 	}
 
+	// Copy directly from the mapped file
+	if (mMapping != nullptr) {
+		const auto readBytes = size > bytesLeft() ? bytesLeft() : size;
+		memory->write(mMapping + mByteOffset, readBytes);
+		mByteOffset += readBytes;
+		return ESERR_NO_ERROR;
+	}
+
 	// Clamp to file size
 	const auto readBytes = size > mFileSize ? mFileSize : size;
 
 	// Read the file into the supplied memory block
-	const auto ret = fread(memory->allocate(readBytes), readBytes, 1, mFile);
-	if (ret != 1) return ESERR_JOURNAL_READ;
+	if (!readAt(mByteOffset, memory->allocate(readBytes), readBytes)) return ESERR_JOURNAL_READ;
+	mByteOffset += readBytes;
 	return ESERR_NO_ERROR;
 }
 
@@ -47,6 +66,10 @@ ESErrorCode FileInputStream::readJournalBytes(ByteBuffer* memory, uint32_t size,
 		return ESERR_NO_ERROR;
 	}
 
+	if (mMapping != nullptr) {
+		return readMappedJournalBytes(memory, size, journalDataSize);
+	}
+
 	// How many bytes are written to the memory block
 	auto bytesWritten = 0u;
 
@@ -55,9 +78,6 @@ ESErrorCode FileInputStream::readJournalBytes(ByteBuffer* memory, uint32_t size,
 
 		// Ignore bytes if neccessary
 		if (mSeekAfterRead > 0) {
-			if (fseek(mFile, mSeekAfterRead, SEEK_CUR) != 0) {
-				return ESERR_JOURNAL_READ;
-			}
 			mByteOffset += mSeekAfterRead;
 			bytesLeft -= mSeekAfterRead;
 		}
@@ -69,8 +89,7 @@ ESErrorCode FileInputStream::readJournalBytes(ByteBuffer* memory, uint32_t size,
 		// Read the file into the supplied memory block
 		char* current = memory->allocate(clampedReadBytes);
 		const auto end = memory->end();
-		const auto ret = fread(current, 1, clampedReadBytes, mFile);
-		if (ret != clampedReadBytes) {
+		if (!readAt(mByteOffset, current, clampedReadBytes)) {
 			return ESERR_JOURNAL_READ;
 		}
 		mByteOffset += clampedReadBytes;
@@ -80,53 +99,42 @@ ESErrorCode FileInputStream::readJournalBytes(ByteBuffer* memory, uint32_t size,
 		char* moveDataTo = current;
 		mSeekAfterRead = 0;
 
-		// Move the data around up to the maximum size
+		// Move one line at a time, up to the maximum size, and skip the timestamp in front of the next line
 		uint32_t totalBytes = 0;
 		while (current != end) {
-			// Move data if not NL, otherwise make sure to ignore the timestamp
-			if (*current != FileUtils::NL) {
-				*moveDataTo++ = *current++;
-				totalBytes++;
-
-				// If we've read to much data, then stop parsing and make sure to move the file handle to the correct position
-				if ((bytesWritten + totalBytes) == size) {
-					const uint32_t bytesLeftInBuffer = (size_t) (end) - (size_t) (current);
-					const int offset = -(int) bytesLeftInBuffer;
-					if (fseek(mFile, offset, SEEK_CUR) != 0) {
-						return ESERR_JOURNAL_READ;
-					}
-					bytesLeft += bytesLeftInBuffer;
-					mByteOffset -= bytesLeftInBuffer;
-					break;
-				}
-			} else {
-				// Copy NL
-				*moveDataTo++ = *current++;
-				totalBytes++;
-
-				// If we've read to much data, then stop parsing and make sure to move the file handle to the correct position
-				if ((bytesWritten + totalBytes) == size) {
-					const uint32_t bytesLeftInBuffer = (size_t) (end) - (size_t) (current);
-					const int offset = -(int) bytesLeftInBuffer;
-					if (fseek(mFile, offset, SEEK_CUR) != 0) {
-						return ESERR_JOURNAL_READ;
-					}
-					bytesLeft += bytesLeftInBuffer;
-					mByteOffset -= bytesLeftInBuffer;
-
-					// Ignore the upcomming timestamp and whitespace
+			const char* nl = LineScanner::findNewLine(current, end);
+			const char* lineEnd = nl == end ? end : nl + 1;
+			const uint32_t lineBytes = lineEnd - current;
+			const uint32_t bytesAllowed = size - (bytesWritten + totalBytes);
+			const uint32_t moveBytes = lineBytes > bytesAllowed ? bytesAllowed : lineBytes;
+			if (moveDataTo != current) {
+				memmove(moveDataTo, current, moveBytes);
+			}
+			moveDataTo += moveBytes;
+			current += moveBytes;
+			totalBytes += moveBytes;
+
+			// If we've read to much data, then stop parsing and continue from the correct position the next time
+			if ((bytesWritten + totalBytes) == size) {
+				const uint32_t bytesLeftInBuffer = (size_t) (end) - (size_t) (current);
+				bytesLeft += bytesLeftInBuffer;
+				mByteOffset -= bytesLeftInBuffer;
+
+				// Ignore the upcomming timestamp and whitespace
+				if (current == lineEnd && nl != end) {
 					mSeekAfterRead = TIMESTAMP_AND_SPACE_LEN;
-					break;
 				}
+				break;
+			}
 
-				// Ignore timestamp and space
+			// Ignore timestamp and space
+			if (nl != end) {
 				const uint32_t bytesLeftInBuffer = (size_t) (end) - (size_t) (current);
 				const uint32_t seek = TIMESTAMP_AND_SPACE_LEN > bytesLeftInBuffer
 				                      ? bytesLeftInBuffer : TIMESTAMP_AND_SPACE_LEN;
 
 				mSeekAfterRead = TIMESTAMP_AND_SPACE_LEN - seek;
 				current += seek;
-
 			}
 		}
 
@@ -139,6 +147,197 @@ ESErrorCode FileInputStream::readJournalBytes(ByteBuffer* memory, uint32_t size,
 	return ESERR_NO_ERROR;
 }
 
+ESErrorCode FileInputStream::readMappedJournalBytes(ByteBuffer* memory, uint32_t size, uint32_t* journalDataSize) {
+	memory->ensureCapacity(size);
+	const char* current = mMapping + mByteOffset;
+	const char* const end = mMapping + mFileSize;
+
+	// Copy one line at a time and skip the timestamp in front of the next line
+	uint32_t bytesWritten = 0;
+	while (current < end && bytesWritten < size) {
+		if (mSeekAfterRead > 0) {
+			const uint32_t seek = mSeekAfterRead > (uint32_t) (end - current) ? end - current : mSeekAfterRead;
+			current += seek;
+			mSeekAfterRead = 0;
+			continue;
+		}
+
+		const char* nl = LineScanner::findNewLine(current, end);
+		const char* lineEnd = nl == end ? end : nl + 1;
+		const uint32_t lineBytes = lineEnd - current;
+		const uint32_t copyBytes = lineBytes > size - bytesWritten ? size - bytesWritten : lineBytes;
+		memory->write(current, copyBytes);
+		current += copyBytes;
+		bytesWritten += copyBytes;
+		if (current == lineEnd && nl != end) {
+			mSeekAfterRead = TIMESTAMP_AND_SPACE_LEN;
+		}
+	}
+
+	mByteOffset = current - mMapping;
+	*journalDataSize = bytesWritten;
+	return ESERR_NO_ERROR;
+}
+
+ESErrorCode FileInputStream::readRecords(ByteBuffer* memory, uint32_t size, bool includeTimestamp,
+                                         uint32_t* journalDataSize) {
+	assert(memory != nullptr);
+	assert(journalDataSize != nullptr);
+	memory->ensureCapacity(size);
+
+	uint32_t bytesWritten = 0;
+	while (bytesWritten < size) {
+		// Write the separator and the timestamp before the actual events
+		if (mPendingOffset < mPendingSize) {
+			const auto left = mPendingSize - mPendingOffset;
+			const auto bytes = left > size - bytesWritten ? size - bytesWritten : left;
+			memory->write(mPending + mPendingOffset, bytes);
+			mPendingOffset += bytes;
+			bytesWritten += bytes;
+			continue;
+		}
+
+		if (mRecordLeft == 0) {
+			if (mByteOffset >= mFileSize) {
+				break;
+			}
+			const auto err = readRecordHeader();
+			if (isError(err)) return err;
+			continue;
+		}
+
+		// Large payloads that are not read ahead are read directly into the memory
+		auto bytes = mRecordLeft > size - bytesWritten ? size - bytesWritten : mRecordLeft;
+		if (!includeTimestamp && bytes >= BlockSize && !isBuffered(mByteOffset)) {
+			if (!readAt(mByteOffset, memory->allocate(bytes), bytes)) {
+				return ESERR_JOURNAL_READ;
+			}
+			mByteOffset += bytes;
+			mRecordLeft -= bytes;
+			bytesWritten += bytes;
+			continue;
+		}
+
+		uint32_t available;
+		const char* const block = bytesAt(mByteOffset, 1u, &available);
+		if (block == nullptr) {
+			return ESERR_JOURNAL_READ;
+		}
+		bytes = bytes > available ? available : bytes;
+		if (!includeTimestamp) {
+			memory->write(block, bytes);
+			mByteOffset += bytes;
+			mRecordLeft -= bytes;
+			bytesWritten += bytes;
+			continue;
+		}
+
+		// Each line needs its own timestamp, so the payload is copied one line at a time
+		const char* current = block;
+		const char* const end = block + bytes;
+		while (current < end && bytesWritten < size) {
+			if (mLineStart) {
+				memcpy(mPending, mTimestamp, Timestamp::BytesLength);
+				mPending[Timestamp::BytesLength] = FileUtils::SPACE;
+				mPendingOffset = 0;
+				mPendingSize = TIMESTAMP_AND_SPACE_LEN;
+				mLineStart = false;
+			}
+			if (mPendingOffset < mPendingSize) {
+				const auto left = mPendingSize - mPendingOffset;
+				const auto pendingBytes = left > size - bytesWritten ? size - bytesWritten : left;
+				memory->write(mPending + mPendingOffset, pendingBytes);
+				mPendingOffset += pendingBytes;
+				bytesWritten += pendingBytes;
+				continue;
+			}
+
+			const auto nl = (const char*) memchr(current, FileUtils::NL, end - current);
+			const char* lineEnd = nl == nullptr ? end : nl + 1;
+			const uint32_t lineBytes = lineEnd - current;
+			const uint32_t copyBytes = lineBytes > size - bytesWritten ? size - bytesWritten : lineBytes;
+			memory->write(current, copyBytes);
+			current += copyBytes;
+			bytesWritten += copyBytes;
+			if (current == lineEnd && nl != nullptr) {
+				mLineStart = true;
+			}
+		}
+
+		// What's left of the payload is copied the next time
+		const uint32_t consumed = current - block;
+		mByteOffset += consumed;
+		mRecordLeft -= consumed;
+	}
+
+	*journalDataSize = bytesWritten;
+	return ESERR_NO_ERROR;
+}
+
+ESErrorCode FileInputStream::readRecordHeader() {
+	JournalFormat::RecordHeader header;
+	const auto left = mFileSize - mByteOffset;
+	if (left < sizeof(header)) {
+		mByteOffset = mFileSize;
+		return ESERR_NO_ERROR;
+	}
+	uint32_t available;
+	const char* const bytes = bytesAt(mByteOffset, sizeof(header), &available);
+	if (bytes == nullptr) {
+		return ESERR_JOURNAL_READ;
+	}
+	memcpy(&header, bytes, sizeof(header));
+
+	// A record that's not completely written is not yet part of the journal
+	if (header.length > left - sizeof(header)) {
+		mByteOffset = mFileSize;
+		return ESERR_NO_ERROR;
+	}
+
+	mByteOffset += sizeof(header);
+	mRecordLeft = header.length;
+	memcpy(mTimestamp, header.timestamp, Timestamp::BytesLength);
+	mLineStart = true;
+
+	// Records are separated in the same way as the commits in a version 1 journal
+	mPendingOffset = 0;
+	mPendingSize = 0;
+	if (!mFirstRecord) {
+		mPending[mPendingSize++] = FileUtils::NL;
+	}
+	mFirstRecord = false;
+	return ESERR_NO_ERROR;
+}
+
+bool FileInputStream::readAt(uint32_t offset, void* dest, uint32_t size) {
+	if (mMapping != nullptr) {
+		memcpy(dest, mMapping + offset, size);
+		return true;
+	}
+	return FileUtils::readAt(mFile, offset, dest, size);
+}
+
+const char* FileInputStream::bytesAt(uint32_t offset, uint32_t minBytes, uint32_t* available) {
+	if (mMapping != nullptr) {
+		*available = mFileSize - offset;
+		return mMapping + offset;
+	}
+
+	if (!isBuffered(offset) || mBlockOffset + mBlockSize - offset < minBytes) {
+		uint32_t size = minBytes > BlockSize ? minBytes : BlockSize;
+		size = size > mFileSize - offset ? mFileSize - offset : size;
+		mBlock.resize(size);
+		mBlockOffset = offset;
+		mBlockSize = 0;
+		if (!readAt(offset, &mBlock[0], size)) {
+			return nullptr;
+		}
+		mBlockSize = size;
+	}
+	*available = mBlockOffset + mBlockSize - offset;
+	return mBlock.c_str() + (offset - mBlockOffset);
+}
+
 void FileInputStream::close() {
 	delete this;
 }
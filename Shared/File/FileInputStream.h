@@ -9,6 +9,7 @@
 #include "../ESErrorCodes.h"
 #include "../Memory/ByteBuffer.h"
 #include "../Config.h"
+#include "../Database/JournalFormat.hpp"
 
 class FileInputStream
 {
@@ -17,7 +18,13 @@ public:
 	// \param fileName The path to where the file is located
 	// \param fileSize the size of the file
 	// \param bytesOffset Offset, in bytes, where the stream should start read data
-	FileInputStream(FILE* file, uint32_t fileSize, uint32_t byteOffset);
+	// \param format The format of the journal
+	// \param mapping The file mapped into memory, or nullptr if the file is read using positional reads. The file
+	//                position is never used, so multiple streams can read the same file from different threads. The
+	//                stream keeps the memory mapped until it's closed
+	FileInputStream(FILE* file, uint32_t fileSize, uint32_t byteOffset,
+	                JournalFormat::Version format = JournalFormat::V1,
+	                std::shared_ptr<const char> mapping = nullptr);
 
 	// Read the entire bytes into the supplied memory
 	inline ESErrorCode readBytes(ByteBuffer* memory) {
@@ -30,6 +37,10 @@ public:
 	// Read the journal-specific bytes from this file stream. The actual size will be clamped to the file size.
 	ESErrorCode readJournalBytes(ByteBuffer* memory, uint32_t size, uint32_t* journalDataSize);
 
+	// Read the events from a version 2 journal, formatted the same way as a version 1 journal is read. The actual
+	// size will be clamped to the file size. Reading stops at the first record that's not completely written.
+	ESErrorCode readRecords(ByteBuffer* memory, uint32_t size, bool includeTimestamp, uint32_t* journalDataSize);
+
 	// Close the input stream
 	void close();
 
@@ -37,13 +48,57 @@ public:
 	 * @return Number of bytes left until we've reached the end of the journal. Useful when streaming extremely large
 	 *         journals from the HDD.
 	 */
-	const inline uint32_t bytesLeft() const { return mFileSize - mByteOffset; }
+	const inline uint32_t bytesLeft() const { return mFileSize - mByteOffset + mPendingSize - mPendingOffset; }
 
 private:
+	// Start reading the record at the current offset
+	ESErrorCode readRecordHeader();
+
+	// Read the journal-specific bytes directly from the mapped file
+	ESErrorCode readMappedJournalBytes(ByteBuffer* memory, uint32_t size, uint32_t* journalDataSize);
+
+	// Read bytes from the supplied position in the file
+	bool readAt(uint32_t offset, void* dest, uint32_t size);
+
+	// Retrieves the bytes at the supplied position in the file. At least minBytes are read, but more are read ahead in
+	// one block, so that the headers and payloads of small records are parsed from memory. Returns nullptr if the
+	// file can't be read
+	const char* bytesAt(uint32_t offset, uint32_t minBytes, uint32_t* available);
+
+	// Is the supplied position part of the bytes already read ahead
+	inline bool isBuffered(uint32_t offset) const {
+		return mMapping != nullptr || (offset >= mBlockOffset && offset < mBlockOffset + mBlockSize);
+	}
+
+private:
+	// The number of bytes read at a time from a version 2 journal
+	static constexpr uint32_t BlockSize = 64u * 1024u;
+
 	FILE* const mFile;
+	const std::shared_ptr<const char> mMappedFile;
+	const char* const mMapping;
 	uint32_t mFileSize;
 	uint32_t mByteOffset;
 	uint32_t mSeekAfterRead;
+
+	// Bytes from the current version 2 record that's not part of the journal file, such as the separator between
+	// records and the timestamp in front of each line
+	char mPending[Timestamp::BytesLength + 2];
+	uint32_t mPendingOffset;
+	uint32_t mPendingSize;
+
+	// The timestamp of the current record
+	char mTimestamp[Timestamp::BytesLength];
+
+	// Payload bytes left in the current record
+	uint32_t mRecordLeft;
+	bool mLineStart;
+
+	// The bytes read ahead from the file, starting at mBlockOffset
+	string mBlock;
+	uint32_t mBlockOffset;
+	uint32_t mBlockSize;
+	bool mFirstRecord;
 };
 
 
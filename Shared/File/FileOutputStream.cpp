@@ -11,55 +11,39 @@ FileOutputStream::FileOutputStream(FILE* file, uint32_t byteOffset)
 	}
 }
 
-uint32_t FileOutputStream::writeEvents(const Timestamp* t, MutableString events) {
+uint32_t FileOutputStream::appendTimedEvents(ByteBuffer* memory, const Timestamp* t, MutableString events) {
 	const auto offset = Timestamp::BytesLength + FileUtils::SPACE_SIZE;
+	const char* end = events.str + events.length;
 
-	char tmp[1024];
-	strncpy(tmp, t->value, Timestamp::BytesLength);
-	tmp[Timestamp::BytesLength] = FileUtils::SPACE;
-
+	// Count the lines first so that the memory only has to grow once
 	uint32_t newLines = 0;
-	uint32_t writeLen = offset;
-	const char* str = events.str;
-	const char* end = events.str + events.length;
-	for (; str != end; ++str) {
-		tmp[writeLen++] = *str;
-		if (*str == FileUtils::NL) {
-			fwrite(tmp, writeLen, 1, mFileHandle);
-			writeLen = offset;
-			newLines++;
-		}
+	for (const char* str = events.str; str != end; ++newLines) {
+		const auto nl = (const char*) memchr(str, FileUtils::NL, end - str);
+		str = nl == nullptr ? end : nl + 1;
 	}
-
-	// Write the last line (if exists)
-	if (writeLen > offset) {
-		fwrite(tmp, writeLen, 1, mFileHandle);
-		newLines++;
+	const uint32_t bytes = events.length + offset * newLines;
+	memory->ensureCapacity(bytes);
+
+	// Write each line (including it's new-line character) prefixed with the timestamp
+	for (const char* str = events.str; str != end;) {
+		const auto nl = (const char*) memchr(str, FileUtils::NL, end - str);
+		const char* lineEnd = nl == nullptr ? end : nl + 1;
+		memory->write(t->value, Timestamp::BytesLength);
+		memory->write(&FileUtils::SPACE, FileUtils::SPACE_SIZE);
+		memory->write(str, lineEnd - str);
+		str = lineEnd;
 	}
 
-	// Add a EOF-marker
-	fwrite(&Journal::JournalEof, 1, 1, mFileHandle);
-
-	// Flush the data before marking the commit as "committed".
-	fflush(mFileHandle);
+	return bytes;
+}
 
-	// If any bytes where already written then make sure to remove the previous EOF-marker
+void FileOutputStream::rollback() {
+	FileUtils::truncate(mFileHandle, mByteOffset);
 	if (mByteOffset > 0) {
-		replaceWithNL(mByteOffset - 1);
+		fseek(mFileHandle, mByteOffset - 1, SEEK_SET);
+		fwrite(&Journal::JournalEof, Journal::JournalEofLen, 1, mFileHandle);
 	}
-
-	// Flush the data so that the commit is solidified. Please note that flushing do not necessarily mean that
-	// the data is actually written to the HDD. Some HDDs have an internal cache where the OS is writing the data to.
-	// If the power is dropped before the HDD can store it on the actual hard-drive then the data might be lost. This
-	// can be fixed in the OS to NOT internally cache the data before saving it.
 	fflush(mFileHandle);
-
-	return events.length + offset * newLines + Journal::JournalEofLen;
-}
-
-uint32_t FileOutputStream::writeTimedEvents(MutableString events) {
-	Timestamp now;
-	return writeEvents(&now, events);
 }
 
 void FileOutputStream::replaceWithNL(uint32_t pos) {
@@ -7,6 +7,8 @@
 
 #include "../es_config.h"
 #include "../Event.h"
+#include "../ESErrorCodes.h"
+#include "../Memory/ByteBuffer.h"
 #include "../Memory/MutableString.hpp"
 
 class FileOutputStream
@@ -18,19 +20,18 @@ public:
 	FileOutputStream(FILE* file, uint32_t byteOffset);
 
 	//
-	// Write the supplied event to the supplied associated file
+	// Format the supplied events, each line prefixed with the timestamp, into the memory block
 	//
+	// \param memory The memory block the events are appended to
 	// \param t Timestamp for when the event is saved to the HDD
 	// \param events The events we want to save
-	uint32_t writeEvents(const Timestamp* t, MutableString events);
+	// \return How many bytes that are appended to the memory block
+	static uint32_t appendTimedEvents(ByteBuffer* memory, const Timestamp* t, MutableString events);
 
 	/**
-	 * Write events prefixed with a timestamp
-	 *
-	 * @param events
-	 * @return How many bytes that are written to the journal file
+	 * Remove everything written by this stream and restore the EOF-marker where the stream started
 	 */
-	uint32_t writeTimedEvents(MutableString events);
+	void rollback();
 
 	// Replace the character at the given position with a newline
 	void replaceWithNL(uint32_t pos);
@@ -27,6 +27,7 @@ const char FileUtils::PATH_DELIM = '/';
 #else
 
 #include <sys/stat.h>
+#include <fcntl.h>
 
 #endif
 
@@ -48,6 +49,44 @@ bool FileUtils::truncate(FILE* f, long newLength) {
 #endif
 }
 
+bool FileUtils::readAt(FILE* f, uint32_t offset, void* dest, uint32_t size) {
+#ifdef WIN32
+	// There's no positional read for CRT file descriptors
+	return fseek(f, offset, SEEK_SET) == 0 && fread(dest, size, 1, f) == 1;
+#else
+	const int fd = fileno(f);
+	char* ptr = (char*) dest;
+	while (size > 0) {
+		const auto readBytes = pread(fd, ptr, size, offset);
+		if (readBytes < 0 && errno == EINTR) {
+			continue;
+		}
+		if (readBytes <= 0) {
+			return false;
+		}
+		ptr += readBytes;
+		offset += readBytes;
+		size -= readBytes;
+	}
+	return true;
+#endif
+}
+
+bool FileUtils::syncDirectory(const Path& path) {
+#ifdef WIN32
+	// Directory entries are written by the file system when the file is closed
+	return true;
+#else
+	const int fd = open(path.value.c_str(), O_RDONLY | O_DIRECTORY);
+	if (fd < 0) {
+		return false;
+	}
+	const bool result = fsync(fd) == 0;
+	::close(fd);
+	return result;
+#endif
+}
+
 void FileUtils::createFolder(const string& path) {
 #ifdef WIN32
 	CreateDirectory(path.c_str(), NULL);
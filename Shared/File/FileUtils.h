@@ -52,6 +52,14 @@ struct FileUtils
 
 	static bool truncate(FILE* f, long newLength);
 
+	// Read bytes from the supplied position in the file without using, or moving, the file position. The file can
+	// be read by multiple threads at the same time
+	static bool readAt(FILE* f, uint32_t offset, void* dest, uint32_t size);
+
+	// Synchronize the supplied directory with the disk, so that files renamed or created in it are not lost if the
+	// machine crashes
+	static bool syncDirectory(const Path& path);
+
 	// 
 	// Returns the file size for file with the supplied filename
 	static uint32_t getFileSize(const string& fileName) {
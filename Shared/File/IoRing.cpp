@@ -0,0 +1,235 @@
+#include "IoRing.h"
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define IO_RING_SUPPORTED
+#endif
+#endif
+
+#ifdef IO_RING_SUPPORTED
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <cerrno>
+
+IoRing::IoRing(uint32_t entries)
+		: mFd(-1), mEntries(0), mAdded(0), mSqRing(MAP_FAILED), mSqRingSize(0), mCqRing(MAP_FAILED), mCqRingSize(0),
+		  mSqes((io_uring_sqe*) MAP_FAILED), mSqesSize(0), mSqHead(nullptr), mSqTail(nullptr), mSqMask(0),
+		  mSqArray(nullptr), mCqHead(nullptr), mCqTail(nullptr), mCqMask(0), mCqes(nullptr) {
+	if (entries == 0) {
+		return;
+	}
+
+	io_uring_params params;
+	memset(&params, 0, sizeof(params));
+	const int fd = (int) syscall(__NR_io_uring_setup, entries, &params);
+	if (fd < 0) {
+		return;
+	}
+
+	// The submission and completion rings might share the same memory
+	mSqRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+	mCqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+	const bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+	if (singleMap && mCqRingSize > mSqRingSize) {
+		mSqRingSize = mCqRingSize;
+	}
+	mSqRing = mmap(nullptr, mSqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+	if (mSqRing == MAP_FAILED) {
+		close(fd);
+		return;
+	}
+	if (singleMap) {
+		mCqRing = mSqRing;
+		mCqRingSize = 0;
+	} else {
+		mCqRing = mmap(nullptr, mCqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+		               IORING_OFF_CQ_RING);
+		if (mCqRing == MAP_FAILED) {
+			munmap(mSqRing, mSqRingSize);
+			mSqRing = MAP_FAILED;
+			close(fd);
+			return;
+		}
+	}
+	mSqesSize = params.sq_entries * sizeof(io_uring_sqe);
+	mSqes = (io_uring_sqe*) mmap(nullptr, mSqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+	                             IORING_OFF_SQES);
+	if (mSqes == MAP_FAILED) {
+		if (mCqRing != mSqRing) {
+			munmap(mCqRing, mCqRingSize);
+		}
+		munmap(mSqRing, mSqRingSize);
+		mSqRing = mCqRing = MAP_FAILED;
+		close(fd);
+		return;
+	}
+
+	char* const sq = (char*) mSqRing;
+	mSqHead = (uint32_t*) (sq + params.sq_off.head);
+	mSqTail = (uint32_t*) (sq + params.sq_off.tail);
+	mSqMask = *(uint32_t*) (sq + params.sq_off.ring_mask);
+	mSqArray = (uint32_t*) (sq + params.sq_off.array);
+	char* const cq = (char*) mCqRing;
+	mCqHead = (uint32_t*) (cq + params.cq_off.head);
+	mCqTail = (uint32_t*) (cq + params.cq_off.tail);
+	mCqMask = *(uint32_t*) (cq + params.cq_off.ring_mask);
+	mCqes = (io_uring_cqe*) (cq + params.cq_off.cqes);
+
+	// Never submit more than what fits in the completion ring, so that no completion is lost
+	mEntries = params.sq_entries < params.cq_entries ? params.sq_entries : params.cq_entries;
+	mFd = fd;
+}
+
+IoRing::~IoRing() {
+	shutdown();
+}
+
+void IoRing::shutdown() {
+	if (mFd < 0) {
+		return;
+	}
+	munmap(mSqes, mSqesSize);
+	if (mCqRing != mSqRing) {
+		munmap(mCqRing, mCqRingSize);
+	}
+	munmap(mSqRing, mSqRingSize);
+	close(mFd);
+	mFd = -1;
+	mEntries = 0;
+	mAdded = 0;
+}
+
+io_uring_sqe* IoRing::nextEntry() {
+	if (mFd < 0 || mAdded == mEntries) {
+		return nullptr;
+	}
+
+	// Only this thread adds entries, but the kernel moves the head when the entries are consumed
+	const uint32_t tail = *mSqTail;
+	const uint32_t head = __atomic_load_n(mSqHead, __ATOMIC_ACQUIRE);
+	if (tail - head >= mEntries) {
+		return nullptr;
+	}
+	const uint32_t index = tail & mSqMask;
+	io_uring_sqe* const entry = &mSqes[index];
+	memset(entry, 0, sizeof(io_uring_sqe));
+	mSqArray[index] = index;
+	return entry;
+}
+
+bool IoRing::writev(int fd, const iovec* parts, uint32_t count, uint32_t offset, uint64_t userData, bool link) {
+	io_uring_sqe* const entry = nextEntry();
+	if (entry == nullptr) {
+		return false;
+	}
+	entry->opcode = IORING_OP_WRITEV;
+	entry->fd = fd;
+	entry->addr = (uint64_t) (uintptr_t) parts;
+	entry->len = count;
+	entry->off = offset;
+	entry->user_data = userData;
+	entry->flags = link ? IOSQE_IO_LINK : 0;
+	__atomic_store_n(mSqTail, *mSqTail + 1, __ATOMIC_RELEASE);
+	mAdded++;
+	return true;
+}
+
+bool IoRing::sync(int fd, uint64_t userData, bool link) {
+	io_uring_sqe* const entry = nextEntry();
+	if (entry == nullptr) {
+		return false;
+	}
+	entry->opcode = IORING_OP_FSYNC;
+	entry->fd = fd;
+	entry->fsync_flags = IORING_FSYNC_DATASYNC;
+	entry->user_data = userData;
+	entry->flags = link ? IOSQE_IO_LINK : 0;
+	__atomic_store_n(mSqTail, *mSqTail + 1, __ATOMIC_RELEASE);
+	mAdded++;
+	return true;
+}
+
+bool IoRing::submitAndWait(vector<Completion>* completions) {
+	uint32_t unsubmitted = mAdded;
+	uint32_t uncompleted = mAdded;
+	mAdded = 0;
+	while (uncompleted > 0) {
+		const auto submitted = syscall(__NR_io_uring_enter, mFd, unsubmitted, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+		if (submitted < 0) {
+			if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+				continue;
+			}
+
+			// The operations that the kernel already has refer to the caller's memory, so wait for them before the
+			// ring is closed. The entries that were never submitted are thrown away with the ring
+			uint32_t inFlight = uncompleted - unsubmitted;
+			while (inFlight > 0) {
+				if (syscall(__NR_io_uring_enter, mFd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0 &&
+				    errno != EINTR) {
+					break;
+				}
+				inFlight -= takeCompletions(nullptr);
+			}
+			shutdown();
+			return false;
+		}
+		unsubmitted -= (uint32_t) submitted;
+		uncompleted -= takeCompletions(completions);
+	}
+	return true;
+}
+
+uint32_t IoRing::takeCompletions(vector<Completion>* completions) {
+	uint32_t head = *mCqHead;
+	const uint32_t tail = __atomic_load_n(mCqTail, __ATOMIC_ACQUIRE);
+	uint32_t count = 0;
+	while (head != tail) {
+		const io_uring_cqe& cqe = mCqes[head & mCqMask];
+		if (completions != nullptr) {
+			completions->push_back({cqe.user_data, cqe.res});
+		}
+		head++;
+		count++;
+	}
+	__atomic_store_n(mCqHead, head, __ATOMIC_RELEASE);
+	return count;
+}
+
+#else
+
+IoRing::IoRing(uint32_t entries)
+		: mFd(-1), mEntries(0), mAdded(0), mSqRing(nullptr), mSqRingSize(0), mCqRing(nullptr), mCqRingSize(0),
+		  mSqes(nullptr), mSqesSize(0), mSqHead(nullptr), mSqTail(nullptr), mSqMask(0), mSqArray(nullptr),
+		  mCqHead(nullptr), mCqTail(nullptr), mCqMask(0), mCqes(nullptr) {
+}
+
+IoRing::~IoRing() {
+}
+
+void IoRing::shutdown() {
+}
+
+uint32_t IoRing::takeCompletions(vector<Completion>* completions) {
+	return 0;
+}
+
+struct io_uring_sqe* IoRing::nextEntry() {
+	return nullptr;
+}
+
+bool IoRing::writev(int fd, const iovec* parts, uint32_t count, uint32_t offset, uint64_t userData, bool link) {
+	return false;
+}
+
+bool IoRing::sync(int fd, uint64_t userData, bool link) {
+	return false;
+}
+
+bool IoRing::submitAndWait(vector<Completion>* completions) {
+	return false;
+}
+
+#endif
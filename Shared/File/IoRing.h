@@ -0,0 +1,98 @@
+#ifndef _EVERSTORE_IO_RING_H_
+#define _EVERSTORE_IO_RING_H_
+
+#include "../es_config.h"
+
+struct iovec;
+
+//
+// Submits file operations to the kernel in batches using io_uring, so that many writes and synchronizations can be
+// in flight at the same time. Operations can be linked, which means that the next operation is not started until
+// the linked operation is successfully completed. Only available on Linux kernels that support io_uring
+class IoRing
+{
+public:
+	// The result of a completed operation
+	struct Completion
+	{
+		// The value supplied when the operation was added
+		uint64_t userData;
+
+		// Same result as the corresponding system call, or -errno if the operation failed
+		int32_t result;
+	};
+
+	//
+	// \param entries The maximum number of operations that can be submitted at the same time (0 = disabled)
+	explicit IoRing(uint32_t entries);
+
+	~IoRing();
+
+	// Can the ring be used. FALSE if it's disabled or if io_uring is not supported by the kernel
+	inline bool available() const { return mFd >= 0; }
+
+	// Retrieves the maximum number of operations that can be submitted at the same time
+	inline uint32_t capacity() const { return mEntries; }
+
+	// Retrieves how many more operations that can be added before the ring must be submitted
+	inline uint32_t space() const { return mEntries - mAdded; }
+
+	//
+	// Add a vectored positional write. The memory blocks must be kept in memory until the ring is submitted
+	//
+	// \param link Start the next operation when this one is successfully completed
+	bool writev(int fd, const iovec* parts, uint32_t count, uint32_t offset, uint64_t userData, bool link);
+
+	//
+	// Add a synchronization of the file data with the disk, same as fdatasync
+	//
+	// \param link Start the next operation when this one is successfully completed
+	bool sync(int fd, uint64_t userData, bool link);
+
+	//
+	// Submit all added operations and wait until they are completed
+	//
+	// \param completions Where the results are added
+	// \return FALSE if the operations could not be submitted. The ring is then closed and no longer available
+	bool submitAndWait(vector<Completion>* completions);
+
+private:
+	// Retrieve the next free submission entry
+	struct io_uring_sqe* nextEntry();
+
+	// Take all completions that are ready
+	//
+	// \param completions Where the results are added, or nullptr if they're thrown away
+	// \return The number of completions taken
+	uint32_t takeCompletions(vector<Completion>* completions);
+
+	// Release the memory shared with the kernel and close the ring
+	void shutdown();
+
+private:
+	int mFd;
+	uint32_t mEntries;
+
+	// Operations added since the last submit
+	uint32_t mAdded;
+
+	// The memory shared with the kernel
+	void* mSqRing;
+	size_t mSqRingSize;
+	void* mCqRing;
+	size_t mCqRingSize;
+	struct io_uring_sqe* mSqes;
+	size_t mSqesSize;
+
+	// Pointers into the shared memory
+	uint32_t* mSqHead;
+	uint32_t* mSqTail;
+	uint32_t mSqMask;
+	uint32_t* mSqArray;
+	uint32_t* mCqHead;
+	uint32_t* mCqTail;
+	uint32_t mCqMask;
+	struct io_uring_cqe* mCqes;
+};
+
+#endif
@@ -0,0 +1,179 @@
+#include "JournalWriter.h"
+#include "FileUtils.h"
+#include "../Database/Journal.h"
+#include "../Database/Durability.hpp"
+#include <climits>
+
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+JournalWriter::JournalWriter(JournalFormat::Version format) : mFormat(format), mSize(0) {
+}
+
+uint32_t JournalWriter::addTimedEvents(const Timestamp* t, MutableString events) {
+	// All lines in the same commit share the same prefix
+	mPrefixes.emplace_back();
+	Prefix& prefix = mPrefixes.back();
+	memcpy(prefix.value, t->value, Timestamp::BytesLength);
+	prefix.value[Timestamp::BytesLength] = FileUtils::SPACE;
+
+	const uint32_t sizeBefore = mSize;
+	const char* end = events.str + events.length;
+	for (const char* str = events.str; str != end;) {
+		const auto nl = (const char*) memchr(str, FileUtils::NL, end - str);
+		const char* lineEnd = nl == nullptr ? end : nl + 1;
+		add(prefix.value, sizeof(prefix.value));
+		add(str, lineEnd - str);
+		str = lineEnd;
+	}
+	return mSize - sizeBefore;
+}
+
+uint32_t JournalWriter::addRecord(const Timestamp* t, MutableString events) {
+	mRecordHeaders.emplace_back();
+	JournalFormat::RecordHeader& header = mRecordHeaders.back();
+	JournalFormat::fillRecordHeader(&header, t, events);
+
+	add((const char*) &header, sizeof(header));
+	add(events.str, events.length);
+	return sizeof(header) + events.length;
+}
+
+void JournalWriter::add(const char* bytes, uint32_t size) {
+	if (size == 0) {
+		return;
+	}
+
+	iovec part;
+	part.iov_base = (void*) bytes;
+	part.iov_len = size;
+	mParts.push_back(part);
+	mSize += size;
+}
+
+void JournalWriter::prepare(uint32_t byteOffset) {
+	if (mFormat == JournalFormat::V2) {
+		if (byteOffset == 0) {
+			mFileHeader = JournalFormat::fileHeader();
+			iovec header;
+			header.iov_base = &mFileHeader;
+			header.iov_len = sizeof(mFileHeader);
+			mParts.insert(mParts.begin(), header);
+			mSize += sizeof(mFileHeader);
+		}
+		return;
+	}
+
+	add(&Journal::JournalEof, Journal::JournalEofLen);
+	mNewLine.iov_base = (void*) &FileUtils::NL;
+	mNewLine.iov_len = FileUtils::NL_SIZE;
+}
+
+ESErrorCode JournalWriter::write(FILE* file, uint32_t byteOffset, Durability* durability) {
+	prepare(byteOffset);
+
+	// Records are never rewritten in a version 2 journal
+	if (mFormat == JournalFormat::V2) {
+		if (!writeAt(file, mParts.data(), mParts.size(), byteOffset) || !durability->persist(file)) {
+			return ESERR_JOURNAL_WRITE;
+		}
+		return ESERR_NO_ERROR;
+	}
+
+	// Write the data before marking the commit as "committed"
+	if (!writeAt(file, mParts.data(), mParts.size(), byteOffset) || !durability->persist(file)) {
+		return ESERR_JOURNAL_WRITE;
+	}
+
+	// If any bytes where already written then make sure to remove the previous EOF-marker
+	if (byteOffset > 0) {
+		if (!writeAt(file, &mNewLine, 1, byteOffset - 1) || !durability->persist(file)) {
+			return ESERR_JOURNAL_WRITE;
+		}
+	}
+
+	return ESERR_NO_ERROR;
+}
+
+bool JournalWriter::submit(IoRing* ring, FILE* file, uint32_t byteOffset, bool sync, uint64_t tag) {
+	// The file header or the EOF-marker is added to the parts
+	const bool rewriteEof = mFormat == JournalFormat::V1 && byteOffset > 0;
+	const uint32_t numParts = mParts.size() + (mFormat == JournalFormat::V1 || byteOffset == 0 ? 1 : 0);
+	const uint32_t numWrites = rewriteEof ? 2 : 1;
+	if (numParts > IOV_MAX || ring->space() < (sync ? numWrites * 2 : numWrites)) {
+		return false;
+	}
+
+	prepare(byteOffset);
+	const int fd = fileno(file);
+	ring->writev(fd, mParts.data(), mParts.size(), byteOffset, tag | 0u, sync || rewriteEof);
+	if (sync) {
+		ring->sync(fd, tag | 1u, rewriteEof);
+	}
+	if (rewriteEof) {
+		ring->writev(fd, &mNewLine, 1, byteOffset - 1, tag | 2u, sync);
+		if (sync) {
+			ring->sync(fd, tag | 3u, false);
+		}
+	}
+	return true;
+}
+
+bool JournalWriter::succeeded(const IoRing::Completion& completion) const {
+	switch (completion.userData & 3u) {
+		case 0:
+			return completion.result == (int32_t) mSize;
+		case 2:
+			return completion.result == (int32_t) FileUtils::NL_SIZE;
+		default:
+			return completion.result == 0;
+	}
+}
+
+#ifdef _WIN32
+
+bool JournalWriter::writeAt(FILE* file, iovec* parts, size_t count, uint32_t byteOffset) {
+	// No vectored positional write exists, so write the parts one by one. The journal file is unbuffered
+	if (fseek(file, byteOffset, SEEK_SET) != 0) {
+		return false;
+	}
+	for (size_t i = 0; i < count; ++i) {
+		if (fwrite(parts[i].iov_base, parts[i].iov_len, 1, file) != 1) {
+			return false;
+		}
+	}
+	return true;
+}
+
+#else
+
+bool JournalWriter::writeAt(FILE* file, iovec* parts, size_t count, uint32_t byteOffset) {
+	const int fd = fileno(file);
+	off_t offset = byteOffset;
+	while (count > 0) {
+		const int n = count > IOV_MAX ? IOV_MAX : (int) count;
+		auto written = pwritev(fd, parts, n, offset);
+		if (written < 0 && errno == EINTR) {
+			continue;
+		}
+		if (written <= 0) {
+			return false;
+		}
+		offset += written;
+
+		// Skip the parts that are written and continue where a partial write stopped
+		while (count > 0 && (size_t) written >= parts->iov_len) {
+			written -= parts->iov_len;
+			++parts;
+			--count;
+		}
+		if (written > 0) {
+			parts->iov_base = (char*) parts->iov_base + written;
+			parts->iov_len -= written;
+		}
+	}
+	return true;
+}
+
+#endif
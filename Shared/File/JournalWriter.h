@@ -0,0 +1,118 @@
+#ifndef _EVERSTORE_JOURNAL_WRITER_H_
+#define _EVERSTORE_JOURNAL_WRITER_H_
+
+#include "../es_config.h"
+#include "../ESErrorCodes.h"
+#include "../Memory/MutableString.hpp"
+#include "../Database/Timestamp.h"
+#include "../Database/JournalFormat.hpp"
+#include "IoRing.h"
+#include <deque>
+
+#ifdef _WIN32
+struct iovec
+{
+	void* iov_base;
+	size_t iov_len;
+};
+#else
+#include <sys/uio.h>
+#endif
+
+class Durability;
+
+//
+// Assembles one or more commits as a list of memory blocks, without copying the events, and writes them onto the
+// journal file with one positional write
+class JournalWriter
+{
+public:
+	JournalWriter(JournalFormat::Version format);
+
+	//
+	// Add the supplied events, each line prefixed with the timestamp. The events must be kept in memory until the
+	// writer is written
+	//
+	// \param t Timestamp for when the event is saved to the HDD
+	// \param events The events we want to save
+	// \return How many bytes that are added
+	uint32_t addTimedEvents(const Timestamp* t, MutableString events);
+
+	//
+	// Add the supplied events as one record, used by version 2 journals. The events must be kept in memory until the
+	// writer is written
+	//
+	// \param t Timestamp for when the event is saved to the HDD
+	// \param events The events we want to save
+	// \return How many bytes that are added
+	uint32_t addRecord(const Timestamp* t, MutableString events);
+
+	//
+	// Add already formatted bytes. The bytes must be kept in memory until the writer is written
+	void add(const char* bytes, uint32_t size);
+
+	//
+	// Write everything that's added at the supplied offset in the journal file. For version 1 journals the data is
+	// followed by an EOF-marker and the previous EOF-marker is replaced with a new-line character after the data is
+	// persisted. For version 2 journals the file header is written first if the journal is empty
+	//
+	// \param file The journal file
+	// \param byteOffset The size of the journal
+	// \param durability Decides if the data is flushed or synchronized with the disk
+	// \return ESERR_NO_ERROR if all bytes are written and made durable
+	ESErrorCode write(FILE* file, uint32_t byteOffset, Durability* durability);
+
+	//
+	// Add the same writes as write does to the ring, instead of writing them directly. The writes are linked, and
+	// followed by a synchronization with the disk if requested, so that they are done in the same order as write
+	// does them. The writer must be kept in memory until the ring is submitted
+	//
+	// \param ring The ring
+	// \param file The journal file
+	// \param byteOffset The size of the journal
+	// \param sync Synchronize the journal file with the disk after each write
+	// \param tag Identifies the operations when they are completed. The two lowest bits must be zero
+	// \return FALSE if nothing is added, because the ring doesn't have room for all operations
+	bool submit(IoRing* ring, FILE* file, uint32_t byteOffset, bool sync, uint64_t tag);
+
+	//
+	// \return TRUE if the supplied operation, added by submit, was successful
+	bool succeeded(const IoRing::Completion& completion) const;
+
+	//
+	// \return How many bytes that are added to this writer (including the EOF-marker if the writer is written)
+	inline uint32_t size() const { return mSize; }
+
+	//
+	// \return TRUE if nothing is added to this writer
+	inline bool empty() const { return mSize == 0; }
+
+private:
+	// Add the file header (version 2) or the EOF-marker (version 1) before the data is written
+	void prepare(uint32_t byteOffset);
+
+	// Write the supplied memory blocks at the supplied offset
+	static bool writeAt(FILE* file, iovec* parts, size_t count, uint32_t byteOffset);
+
+private:
+	struct Prefix
+	{
+		char value[Timestamp::BytesLength + 1];
+	};
+
+	const JournalFormat::Version mFormat;
+	vector<iovec> mParts;
+
+	// Timestamp prefixes for the added events. A deque never moves its elements when growing
+	deque<Prefix> mPrefixes;
+
+	// Record headers for the added events
+	deque<JournalFormat::RecordHeader> mRecordHeaders;
+	JournalFormat::FileHeader mFileHeader;
+	uint32_t mSize;
+
+	// Replaces the previous EOF-marker in a version 1 journal
+	iovec mNewLine;
+};
+
+#endif
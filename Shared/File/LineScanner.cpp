@@ -0,0 +1,83 @@
+#include "LineScanner.h"
+#include "FileUtils.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define LINE_SCANNER_X86
+#include <immintrin.h>
+#endif
+
+namespace
+{
+	typedef const char* (* FindNewLine)(const char*, const char*);
+
+#ifdef LINE_SCANNER_X86
+
+	__attribute__((target("sse2")))
+	const char* findNewLineSSE2(const char* begin, const char* end) {
+		const __m128i nl = _mm_set1_epi8(FileUtils::NL);
+		while (end - begin >= 16) {
+			const __m128i block = _mm_loadu_si128((const __m128i*) begin);
+			const int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, nl));
+			if (mask != 0) {
+				return begin + __builtin_ctz(mask);
+			}
+			begin += 16;
+		}
+		return LineScanner::findNewLineScalar(begin, end);
+	}
+
+	__attribute__((target("avx2")))
+	const char* findNewLineAVX2(const char* begin, const char* end) {
+		const __m256i nl = _mm256_set1_epi8(FileUtils::NL);
+		while (end - begin >= 32) {
+			const __m256i block = _mm256_loadu_si256((const __m256i*) begin);
+			const uint32_t mask = (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, nl));
+			if (mask != 0) {
+				return begin + __builtin_ctz(mask);
+			}
+			begin += 32;
+		}
+		return findNewLineSSE2(begin, end);
+	}
+
+	FindNewLine selectFindNewLine(const char** name) {
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx2")) {
+			*name = "avx2";
+			return findNewLineAVX2;
+		}
+		if (__builtin_cpu_supports("sse2")) {
+			*name = "sse2";
+			return findNewLineSSE2;
+		}
+		*name = "scalar";
+		return LineScanner::findNewLineScalar;
+	}
+
+#else
+
+	FindNewLine selectFindNewLine(const char** name) {
+		*name = "scalar";
+		return LineScanner::findNewLineScalar;
+	}
+
+#endif
+
+	const char* selectedName = nullptr;
+	const FindNewLine selected = selectFindNewLine(&selectedName);
+}
+
+const char* LineScanner::findNewLine(const char* begin, const char* end) {
+	return selected(begin, end);
+}
+
+const char* LineScanner::findNewLineScalar(const char* begin, const char* end) {
+	while (begin != end && *begin != FileUtils::NL) {
+		++begin;
+	}
+	return begin;
+}
+
+const char* LineScanner::instructions() {
+	return selectedName;
+}
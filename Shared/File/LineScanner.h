@@ -0,0 +1,29 @@
+#ifndef _EVERSTORE_LINE_SCANNER_H_
+#define _EVERSTORE_LINE_SCANNER_H_
+
+#include "../es_config.h"
+
+//
+// Finds the new-line characters in a block of memory. The widest vector instructions supported by the cpu are used,
+// which is decided when the program starts
+class LineScanner
+{
+public:
+	//
+	// Find the first new-line character
+	//
+	// \param begin Where the search starts
+	// \param end Where the search stops (exclusive)
+	// \return The position of the new-line character or end if none is found
+	static const char* findNewLine(const char* begin, const char* end);
+
+	//
+	// Find the first new-line character by looking at one byte at a time
+	static const char* findNewLineScalar(const char* begin, const char* end);
+
+	//
+	// \return The name of the instructions used by findNewLine, such as "avx2"
+	static const char* instructions();
+};
+
+#endif
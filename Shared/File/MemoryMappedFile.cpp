@@ -0,0 +1,54 @@
+#include "MemoryMappedFile.h"
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
+MemoryMappedFile::MemoryMappedFile() : mSize(0) {
+}
+
+MemoryMappedFile::~MemoryMappedFile() {
+	unmap();
+}
+
+#ifdef _WIN32
+
+MemoryMappedFile::Memory MemoryMappedFile::map(FILE* file, uint32_t size) {
+	// Not supported. The file is read using stdio instead
+	return nullptr;
+}
+
+void MemoryMappedFile::unmap() {
+}
+
+#else
+
+MemoryMappedFile::Memory MemoryMappedFile::map(FILE* file, uint32_t size) {
+	if (size == 0) {
+		return nullptr;
+	}
+
+	// Remap when the file has grown
+	if (mMemory != nullptr && size <= mSize) {
+		return mMemory;
+	}
+	unmap();
+
+	void* memory = mmap(nullptr, size, PROT_READ, MAP_SHARED, fileno(file), 0);
+	if (memory == MAP_FAILED) {
+		return nullptr;
+	}
+
+	// The journals are mostly read from the beginning to the end
+	madvise(memory, size, MADV_SEQUENTIAL);
+	mMemory = Memory((const char*) memory, [size](const char* memory) { munmap((void*) memory, size); });
+	mSize = size;
+	return mMemory;
+}
+
+void MemoryMappedFile::unmap() {
+	mMemory.reset();
+	mSize = 0;
+}
+
+#endif
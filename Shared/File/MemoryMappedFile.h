@@ -0,0 +1,40 @@
+#ifndef _EVERSTORE_MEMORY_MAPPED_FILE_H_
+#define _EVERSTORE_MEMORY_MAPPED_FILE_H_
+
+#include "../es_config.h"
+
+//
+// Read-only memory mapping of a file. The file is remapped when it has grown larger than what's mapped. The memory is
+// unmapped when the last reference to it is released, so a stream that keeps the reference can read the memory even
+// after the file has been remapped
+class MemoryMappedFile
+{
+public:
+	typedef std::shared_ptr<const char> Memory;
+
+	MemoryMappedFile();
+
+	~MemoryMappedFile();
+
+	//
+	// Map the first bytes of the supplied file
+	//
+	// \param file The file
+	// \param size How many bytes, from the beginning of the file, that must be mapped
+	// \return The mapped memory or nullptr if the file could not be mapped
+	Memory map(FILE* file, uint32_t size);
+
+	//
+	// Release this reference to the mapped memory
+	void unmap();
+
+	//
+	// \return How many bytes that are mapped
+	inline uint32_t size() const { return mSize; }
+
+private:
+	Memory mMemory;
+	uint32_t mSize;
+};
+
+#endif
@@ -1,8 +1,12 @@
 #include "IpcChild.h"
 #include "../StringUtils.h"
+#include "../Log/Log.hpp"
+
+constexpr uint32_t IpcChild::RingNameSize;
+constexpr uint32_t IpcChild::RingPollMicros;
 
 IpcChild::IpcChild(ProcessID id, Process* process)
-		: mId(id), mProcess(process) {
+		: mId(id), mProcess(process), mRing(nullptr), mResponseRing(nullptr) {
 }
 
 IpcChild::~IpcChild() {
@@ -10,31 +14,147 @@ IpcChild::~IpcChild() {
 		delete mProcess;
 		mProcess = nullptr;
 	}
+	if (mRing) {
+		delete mRing;
+		mRing = nullptr;
+	}
+	if (mResponseRing) {
+		delete mResponseRing;
+		mResponseRing = nullptr;
+	}
 }
 
-ESErrorCode IpcChild::sendTo(const ESHeader* header) {
-	const uint32_t size = sizeof(ESHeader);
-	lock_guard<mutex> l(mMutex);
-	const auto bytesSent = mProcess->Write((char*) header, size);
-	if (bytesSent != size) return ESERR_PIPE_WRITE;
+ESErrorCode IpcChild::createRing(uint32_t capacity) {
+	const string name = string("/everstore_ring_") + StringUtils::toString((uint32_t) getpid()) + string("_") +
+	                    mId.ToString();
+	return createRing(name, capacity, &mRing);
+}
+
+ESErrorCode IpcChild::createResponseRing(uint32_t capacity) {
+	const string name = string("/everstore_responses_") + StringUtils::toString((uint32_t) getpid()) + string("_") +
+	                    mId.ToString();
+	return createRing(name, capacity, &mResponseRing);
+}
+
+ESErrorCode IpcChild::createRing(const string& ringName, uint32_t capacity, SharedRing** ring) {
+	char name[RingNameSize] = {0};
+	if (capacity > 0) {
+		*ring = SharedRing::create(ringName, capacity);
+		if (*ring != nullptr) {
+			strncpy(name, ringName.c_str(), RingNameSize - 1);
+		} else {
+			Log::Write(Log::Warn, "IpcChild(%d) | Could not create a shared memory ring. Using the pipe instead",
+			           mId.value);
+		}
+	}
+
+	// An empty name tells the child process to use the pipe instead
+	if (mProcess->Write(name, RingNameSize) != RingNameSize) {
+		return ESERR_PIPE_WRITE;
+	}
 	return ESERR_NO_ERROR;
 }
 
+ESErrorCode IpcChild::attachRing() {
+	return attachRing(&mRing);
+}
+
+ESErrorCode IpcChild::attachResponseRing() {
+	return attachRing(&mResponseRing);
+}
+
+ESErrorCode IpcChild::attachRing(SharedRing** ring) {
+	char name[RingNameSize] = {0};
+	if (mProcess->Read(name, RingNameSize) != RingNameSize) {
+		return ESERR_PIPE_READ;
+	}
+	name[RingNameSize - 1] = 0;
+	if (name[0] == 0) {
+		return ESERR_NO_ERROR;
+	}
+
+	// The host uses the ring for everything, so the messages cannot be sent or read if it's not attached
+	*ring = SharedRing::open(string(name));
+	if (*ring == nullptr) {
+		return ESERR_PIPE_CONNECT;
+	}
+	return ESERR_NO_ERROR;
+}
+
+ESErrorCode IpcChild::sendTo(const ESHeader* header) {
+	return write((const char*) header, sizeof(ESHeader));
+}
+
 ESErrorCode IpcChild::sendTo(const ByteBuffer* bytes) {
 	assert(bytes != nullptr);
 
 	// The offset of the memory represents the size of the memory
-	const auto size = bytes->offset();
+	return write(bytes->ptr(), bytes->offset());
+}
 
-	// Send the data to the supplied process
-	mMutex.lock();
-	const auto ret = mProcess->Write(bytes->ptr(), size);
-	mMutex.unlock();
+ESErrorCode IpcChild::sendTo(const SharedRing::Part* parts, uint32_t count) {
+	if (mRing != nullptr) {
+		return writeParts(mRing, parts, count);
+	}
 
-	if (ret != size) {
+	mBatch.clear();
+	for (uint32_t i = 0; i < count; ++i) {
+		mBatch.insert(mBatch.end(), parts[i].bytes, parts[i].bytes + parts[i].size);
+	}
+	if (mBatch.empty()) {
+		return ESERR_NO_ERROR;
+	}
+	return write(mBatch.data(), mBatch.size());
+}
+
+ESErrorCode IpcChild::sendToHost(const SharedRing::Part* parts, uint32_t count) {
+	if (mResponseRing != nullptr) {
+		return writeParts(mResponseRing, parts, count);
+	}
+
+	mBatch.clear();
+	for (uint32_t i = 0; i < count; ++i) {
+		mBatch.insert(mBatch.end(), parts[i].bytes, parts[i].bytes + parts[i].size);
+	}
+	if (mBatch.empty()) {
+		return ESERR_NO_ERROR;
+	}
+	if (mProcess->Write(mBatch.data(), mBatch.size()) != (int32_t) mBatch.size()) {
 		return ESERR_PIPE_WRITE;
 	}
+	return ESERR_NO_ERROR;
+}
 
+ESErrorCode IpcChild::writeParts(SharedRing* ring, const SharedRing::Part* parts, uint32_t count) {
+	// Write as many messages as the ring can hold at a time
+	uint32_t first = 0;
+	while (first < count) {
+		uint32_t last = first;
+		uint32_t size = 0;
+		while (last < count && size + parts[last].size <= ring->capacity()) {
+			size += parts[last].size;
+			last++;
+		}
+		if (last == first || !ring->write(parts + first, last - first)) {
+			return ESERR_PIPE_WRITE;
+		}
+		first = last;
+	}
+	return ESERR_NO_ERROR;
+}
+
+ESErrorCode IpcChild::write(const char* bytes, uint32_t size) {
+	if (mRing != nullptr) {
+		if (!mRing->write(bytes, size)) {
+			return ESERR_PIPE_WRITE;
+		}
+		return ESERR_NO_ERROR;
+	}
+
+	const auto ret = mProcess->Write(bytes, size);
+	if (ret != size) {
+		return ESERR_PIPE_WRITE;
+	}
 	return ESERR_NO_ERROR;
 }
 
@@ -43,5 +163,47 @@ void IpcChild::close() {
 }
 
 int32_t IpcChild::read(char* bytes, uint32_t size) {
-	return mProcess->Read(bytes, size);
+	if (mRing == nullptr) {
+		return mProcess->Read(bytes, size);
+	}
+	return readRing(mRing, bytes, size);
+}
+
+int32_t IpcChild::readResponse(char* bytes, uint32_t size) {
+	if (mResponseRing == nullptr) {
+		return mProcess->Read(bytes, size);
+	}
+	return readRing(mResponseRing, bytes, size);
+}
+
+bool IpcChild::waitForResponse(uint32_t timeoutMicros) {
+	if (mResponseRing != nullptr) {
+		return mResponseRing->waitForData(timeoutMicros);
+	}
+	return mProcess->WaitForData(timeoutMicros);
+}
+
+int32_t IpcChild::readRing(SharedRing* ring, char* bytes, uint32_t size) {
+	uint32_t totalRead = 0;
+	while (totalRead != size) {
+		totalRead += ring->read(bytes + totalRead, size - totalRead, RingPollMicros);
+		if (totalRead == size) {
+			break;
+		}
+
+		// Nothing else is sent over the pipe while the ring is empty, so a readable pipe means that the other process
+		// has closed it. The ring is checked again, since the other process might have written to both since the ring
+		// was checked
+		if (mProcess->WaitForData(0) && !ring->waitForData(0)) {
+			break;
+		}
+	}
+	return totalRead;
+}
+
+bool IpcChild::waitForData(uint32_t timeoutMicros) {
+	if (mRing != nullptr) {
+		return mRing->waitForData(timeoutMicros);
+	}
+	return mProcess->WaitForData(timeoutMicros);
 }
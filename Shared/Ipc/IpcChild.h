@@ -5,34 +5,133 @@
 #include "../Memory/ByteBuffer.h"
 #include "../Process/Process.hpp"
 #include "../Mutex/Mutex.hpp"
+#include "SharedRing.h"
 
+//
+// The header of a response sent from a child process to the host. The bytes sent to the client follow directly after.
+// A response that's split up into many parts is always sent to the client without any other response in between
+struct IpcResponse
+{
+	// The client that the bytes are sent to
+	int32_t client;
+
+	// The number of bytes
+	uint32_t size;
+
+	// Is this the last part of a response (1 == true)
+	uint16_t last;
+
+	// How many requests from the client that are completed by this part. A part without any bytes only tells the host
+	// that requests are completed, when the responses are sent directly to the client
+	uint16_t completed;
+};
+
+//
+// The pipe, and the ring, between the host and a child process. The messages must be sent by one thread at a time
 class IpcChild
 {
 public:
+	// The size of the ring name sent from the host to the child process
+	static constexpr uint32_t RingNameSize = 64;
+
+	// How long a read from the ring waits before it checks if the host is still connected
+	static constexpr uint32_t RingPollMicros = 100000;
+
 	explicit IpcChild(ProcessID id, Process* process);
 
 	~IpcChild();
 
+	//
+	// Create a ring in shared memory used for sending the messages to the child process, and send its name over the
+	// pipe. The pipe is used for all messages if the ring cannot be created (capacity = 0 disables the ring)
+	ESErrorCode createRing(uint32_t capacity);
+
+	//
+	// Attach to the ring created by the host process, if the host has created one. Must be called by the child process
+	// before the first message is read
+	ESErrorCode attachRing();
+
+	//
+	// Create a ring in shared memory used by the child process for sending responses back to the host, and send its
+	// name over the pipe. The pipe is used for the responses if the ring cannot be created
+	ESErrorCode createResponseRing(uint32_t capacity);
+
+	//
+	// Attach to the ring created by the host process for the responses. Must be called by the child process after
+	// attachRing, if the host sends the responses to the clients
+	ESErrorCode attachResponseRing();
+
 	// Send a message over the IPC pipe
 	ESErrorCode sendTo(const ESHeader* header);
 
 	// Send a message over the IPC pipe
 	ESErrorCode sendTo(const ByteBuffer* bytes);
 
+	//
+	// Send many messages at once. The messages are written to the pipe with one write, or made visible in the ring
+	// at the same time
+	ESErrorCode sendTo(const SharedRing::Part* parts, uint32_t count);
+
 	int32_t read(char* bytes, uint32_t size);
 
+	//
+	// Send responses to the host. The responses are written to the pipe with one write, or made visible in the ring
+	// at the same time. Used by the child process
+	ESErrorCode sendToHost(const SharedRing::Part* parts, uint32_t count);
+
+	//
+	// Read the responses sent by the child process. Waits until all the bytes are read. Used by the host
+	//
+	// \return The number of bytes read; less than the supplied size if the child process is gone
+	int32_t readResponse(char* bytes, uint32_t size);
+
+	// Wait, at most the supplied amount of microseconds, for a response to be readable
+	bool waitForResponse(uint32_t timeoutMicros);
+
+	// Wait, at most the supplied amount of microseconds, for data to be readable
+	bool waitForData(uint32_t timeoutMicros);
+
 	// Retrieves this child's unique id
 	inline ProcessID id() const { return mId; }
 
 	inline Process* process() { return mProcess; }
 
+	// Are the messages sent using a ring in shared memory
+	inline bool usesRing() const { return mRing != nullptr; }
+
 	// Close pipe
 	void close();
 
+private:
+	// Send the supplied bytes using the ring, if one is used, or the pipe
+	ESErrorCode write(const char* bytes, uint32_t size);
+
+	// Create a ring and send its name over the pipe
+	ESErrorCode createRing(const string& name, uint32_t capacity, SharedRing** ring);
+
+	// Attach to the ring named by the host
+	ESErrorCode attachRing(SharedRing** ring);
+
+	// Write the supplied parts to the ring, as many at a time as the ring can hold
+	static ESErrorCode writeParts(SharedRing* ring, const SharedRing::Part* parts, uint32_t count);
+
+	// Read the supplied number of bytes from the ring. Stops if the other process has closed the pipe
+	int32_t readRing(SharedRing* ring, char* bytes, uint32_t size);
+
 private:
 	const ProcessID mId;
 	Process* mProcess;
-	mutex mMutex;
+
+	// Many messages sent over the pipe are copied into this buffer so that they are written at once. Used by the host
+	// for requests and by the child process for responses
+	vector<char> mBatch;
+
+	// The messages are sent using this ring instead of the pipe. Sockets and mutexes shared with the child process are
+	// still sent over the pipe
+	SharedRing* mRing;
+
+	// The responses are sent back to the host using this ring instead of the pipe
+	SharedRing* mResponseRing;
 };
 
 #endif
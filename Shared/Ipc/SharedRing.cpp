@@ -0,0 +1,261 @@
+#include "SharedRing.h"
+#include "../Log/Log.hpp"
+
+constexpr uint32_t SharedRing::WriteTimeoutMillis;
+
+#if defined(__linux__)
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <fcntl.h>
+#include <climits>
+
+// The state of the ring, placed before the bytes in the shared memory. The producer and consumer parts are kept on
+// separate cache lines
+struct SharedRingState
+{
+	// Total number of bytes written. Only moved by the producer
+	alignas(64) uint32_t tail;
+	uint32_t consumerWaiting;
+
+	// Total number of bytes read. Only moved by the consumer
+	alignas(64) uint32_t head;
+	uint32_t producerWaiting;
+
+	alignas(64) uint32_t capacity;
+};
+
+static void futexWait(uint32_t* address, uint32_t expected, uint32_t timeoutMicros) {
+	timespec timeout;
+	timeout.tv_sec = timeoutMicros / 1000000u;
+	timeout.tv_nsec = (timeoutMicros % 1000000u) * 1000u;
+	syscall(SYS_futex, address, FUTEX_WAIT, expected, &timeout, nullptr, 0);
+}
+
+static void futexWake(uint32_t* address) {
+	syscall(SYS_futex, address, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+static uint32_t roundUpToPowerOfTwo(uint32_t value) {
+	uint32_t result = 1;
+	while (result < value) {
+		result <<= 1u;
+	}
+	return result;
+}
+
+SharedRing::SharedRing(const string& name, SharedRingState* state, uint32_t capacity, bool owner)
+		: mName(name), mState(state), mBytes((char*) (state + 1)), mCapacity(capacity), mOwner(owner) {
+}
+
+SharedRing::~SharedRing() {
+	munmap(mState, sizeof(SharedRingState) + mCapacity);
+	if (mOwner) {
+		shm_unlink(mName.c_str());
+	}
+}
+
+SharedRing* SharedRing::create(const string& name, uint32_t capacity) {
+	if (capacity == 0 || capacity > 0x80000000u) {
+		return nullptr;
+	}
+	capacity = roundUpToPowerOfTwo(capacity);
+
+	// Remove memory left behind by a process that was not shut down properly
+	shm_unlink(name.c_str());
+	const int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+	if (fd == -1) {
+		Log::Write(Log::Error, "SharedRing | %s failed to open shared memory", name.c_str());
+		return nullptr;
+	}
+
+	const size_t size = sizeof(SharedRingState) + capacity;
+	if (ftruncate(fd, size) == -1) {
+		close(fd);
+		shm_unlink(name.c_str());
+		return nullptr;
+	}
+	void* const memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (memory == MAP_FAILED) {
+		shm_unlink(name.c_str());
+		return nullptr;
+	}
+
+	auto const state = (SharedRingState*) memory;
+	memset(state, 0, sizeof(SharedRingState));
+	state->capacity = capacity;
+	return new SharedRing(name, state, capacity, true);
+}
+
+SharedRing* SharedRing::open(const string& name) {
+	const int fd = shm_open(name.c_str(), O_RDWR, S_IRUSR | S_IWUSR);
+	if (fd == -1) {
+		Log::Write(Log::Error, "SharedRing | %s failed to open shared memory", name.c_str());
+		return nullptr;
+	}
+
+	// Read the capacity before the whole ring is mapped
+	void* memory = mmap(nullptr, sizeof(SharedRingState), PROT_READ, MAP_SHARED, fd, 0);
+	if (memory == MAP_FAILED) {
+		close(fd);
+		return nullptr;
+	}
+	const uint32_t capacity = ((SharedRingState*) memory)->capacity;
+	munmap(memory, sizeof(SharedRingState));
+
+	memory = mmap(nullptr, sizeof(SharedRingState) + capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (memory == MAP_FAILED) {
+		return nullptr;
+	}
+	return new SharedRing(name, (SharedRingState*) memory, capacity, false);
+}
+
+uint32_t SharedRing::size() const {
+	return __atomic_load_n(&mState->tail, __ATOMIC_SEQ_CST) - __atomic_load_n(&mState->head, __ATOMIC_SEQ_CST);
+}
+
+bool SharedRing::write(const char* bytes, uint32_t size) {
+	const Part part = {bytes, size};
+	return write(&part, 1);
+}
+
+bool SharedRing::write(const Part* parts, uint32_t count) {
+	uint64_t totalSize = 0;
+	for (uint32_t i = 0; i < count; ++i) {
+		totalSize += parts[i].size;
+	}
+	if (totalSize > mCapacity) {
+		return false;
+	}
+	const uint32_t size = (uint32_t) totalSize;
+
+	const uint32_t tail = mState->tail;
+	uint32_t waitedMicros = 0;
+	while (true) {
+		const uint32_t head = __atomic_load_n(&mState->head, __ATOMIC_ACQUIRE);
+		if (mCapacity - (tail - head) >= size) {
+			break;
+		}
+		if (waitedMicros >= WriteTimeoutMillis * 1000u) {
+			return false;
+		}
+
+		// Tell the consumer that we are waiting before the head is checked again, so that the wake-up is not lost
+		__atomic_store_n(&mState->producerWaiting, 1u, __ATOMIC_SEQ_CST);
+		if (__atomic_load_n(&mState->head, __ATOMIC_SEQ_CST) == head) {
+			futexWait(&mState->head, head, 1000u);
+			waitedMicros += 1000u;
+		}
+		__atomic_store_n(&mState->producerWaiting, 0u, __ATOMIC_SEQ_CST);
+	}
+
+	// Copy the bytes, which might wrap around the end of the ring
+	uint32_t position = tail;
+	for (uint32_t i = 0; i < count; ++i) {
+		const uint32_t offset = position & (mCapacity - 1);
+		const uint32_t first = std::min(parts[i].size, mCapacity - offset);
+		memcpy(mBytes + offset, parts[i].bytes, first);
+		memcpy(mBytes, parts[i].bytes + first, parts[i].size - first);
+		position += parts[i].size;
+	}
+
+	__atomic_store_n(&mState->tail, tail + size, __ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&mState->consumerWaiting, __ATOMIC_SEQ_CST) != 0) {
+		futexWake(&mState->tail);
+	}
+	return true;
+}
+
+uint32_t SharedRing::read(char* bytes, uint32_t size, uint32_t timeoutMicros) {
+	uint32_t head = mState->head;
+	uint32_t totalRead = 0;
+	while (totalRead != size) {
+		const uint32_t available = __atomic_load_n(&mState->tail, __ATOMIC_ACQUIRE) - head;
+		if (available == 0) {
+			if (!waitForData(timeoutMicros)) {
+				break;
+			}
+			continue;
+		}
+
+		// Copy the bytes, which might wrap around the end of the ring
+		const uint32_t count = std::min(available, size - totalRead);
+		const uint32_t offset = head & (mCapacity - 1);
+		const uint32_t first = std::min(count, mCapacity - offset);
+		memcpy(bytes + totalRead, mBytes + offset, first);
+		memcpy(bytes + totalRead + first, mBytes, count - first);
+		totalRead += count;
+		head += count;
+
+		__atomic_store_n(&mState->head, head, __ATOMIC_SEQ_CST);
+		if (__atomic_load_n(&mState->producerWaiting, __ATOMIC_SEQ_CST) != 0) {
+			futexWake(&mState->head);
+		}
+	}
+	return totalRead;
+}
+
+bool SharedRing::waitForData(uint32_t timeoutMicros) {
+	const uint32_t head = mState->head;
+	const uint32_t tail = __atomic_load_n(&mState->tail, __ATOMIC_ACQUIRE);
+	if (tail != head) {
+		return true;
+	}
+	if (timeoutMicros == 0) {
+		return false;
+	}
+
+	// Tell the producer that we are waiting before the tail is checked again, so that the wake-up is not lost
+	__atomic_store_n(&mState->consumerWaiting, 1u, __ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&mState->tail, __ATOMIC_SEQ_CST) == tail) {
+		futexWait(&mState->tail, tail, timeoutMicros);
+	}
+	__atomic_store_n(&mState->consumerWaiting, 0u, __ATOMIC_SEQ_CST);
+	return __atomic_load_n(&mState->tail, __ATOMIC_ACQUIRE) != head;
+}
+
+#else
+
+struct SharedRingState
+{
+};
+
+SharedRing::SharedRing(const string& name, SharedRingState* state, uint32_t capacity, bool owner)
+		: mName(name), mState(state), mBytes(nullptr), mCapacity(capacity), mOwner(owner) {
+}
+
+SharedRing::~SharedRing() {
+}
+
+SharedRing* SharedRing::create(const string& name, uint32_t capacity) {
+	return nullptr;
+}
+
+SharedRing* SharedRing::open(const string& name) {
+	return nullptr;
+}
+
+uint32_t SharedRing::size() const {
+	return 0;
+}
+
+bool SharedRing::write(const char* bytes, uint32_t size) {
+	return false;
+}
+
+bool SharedRing::write(const Part* parts, uint32_t count) {
+	return false;
+}
+
+uint32_t SharedRing::read(char* bytes, uint32_t size, uint32_t timeoutMicros) {
+	return 0;
+}
+
+bool SharedRing::waitForData(uint32_t timeoutMicros) {
+	return false;
+}
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef _EVERSTORE_SHARED_RING_H_
+#define _EVERSTORE_SHARED_RING_H_
+
+#include "../es_config.h"
+
+//
+// A ring buffer of bytes in memory shared between two processes. One producer writes and one consumer reads. Handing
+// over bytes is a copy into the ring. A futex is used to wake up a consumer that waits for bytes, or a producer that
+// waits for space, so no system call is made while both are busy. Only available on Linux
+class SharedRing
+{
+public:
+	// A block of bytes that is written together with other blocks
+	struct Part
+	{
+		const char* bytes;
+		uint32_t size;
+	};
+
+	// How long a producer waits for space in the ring before it gives up
+	static constexpr uint32_t WriteTimeoutMillis = 30000;
+
+	//
+	// Create a new ring in shared memory
+	//
+	// \param name A unique name for the shared memory
+	// \param capacity How many bytes the ring can hold. Rounded up to a power of two
+	// \return A new ring if successful; nullptr otherwise
+	static SharedRing* create(const string& name, uint32_t capacity);
+
+	//
+	// Attach to a ring created by another process
+	//
+	// \return The ring if successful; nullptr otherwise
+	static SharedRing* open(const string& name);
+
+	~SharedRing();
+
+	//
+	// Write the supplied bytes to the ring. Waits for the consumer if there's not enough space
+	//
+	// \return FALSE if the bytes don't fit in the ring or if the consumer did not make room for them in time
+	bool write(const char* bytes, uint32_t size);
+
+	//
+	// Write the supplied blocks of bytes to the ring. The consumer sees all of them at the same time
+	//
+	// \return FALSE if the blocks don't fit in the ring or if the consumer did not make room for them in time
+	bool write(const Part* parts, uint32_t count);
+
+	//
+	// Read the supplied number of bytes from the ring. Waits, at most the supplied amount of microseconds, for each
+	// part of the bytes to be written
+	//
+	// \return How many bytes that are read
+	uint32_t read(char* bytes, uint32_t size, uint32_t timeoutMicros);
+
+	// Wait, at most the supplied amount of microseconds, for bytes to be readable
+	bool waitForData(uint32_t timeoutMicros);
+
+	// Retrieves how many bytes that are written but not yet read
+	uint32_t size() const;
+
+	// Retrieves how many bytes the ring can hold
+	inline uint32_t capacity() const { return mCapacity; }
+
+	inline const string& name() const { return mName; }
+
+private:
+	SharedRing(const string& name, struct SharedRingState* state, uint32_t capacity, bool owner);
+
+private:
+	const string mName;
+	struct SharedRingState* const mState;
+	char* const mBytes;
+	const uint32_t mCapacity;
+
+	// The process that created the ring removes the shared memory
+	const bool mOwner;
+};
+
+#endif
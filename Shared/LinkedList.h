@@ -55,6 +55,12 @@ public:
 	// Constructor
 	LinkedList(size_t offset);
 
+	//
+	// Constructor
+	// @param link The link in the items that this list uses
+	template<class L>
+	explicit LinkedList(L T::* link) : LinkedList(offsetOf(link)) {}
+
 	//
 	// Destructor
 	~LinkedList();
@@ -101,6 +107,12 @@ public:
 	// Check to see if this list is empty or not
 	bool empty() const { return getSize() == 0; }
 
+	//
+	// Returns the offset of the supplied link in the items. Used instead of offsetof, which is only defined for
+	// standard-layout types and the links have a virtual destructor
+	template<class L>
+	static size_t offsetOf(L T::* link);
+
 protected:
 	//
 	// Retrieves the link value from the supplied item.
@@ -173,6 +185,15 @@ template<class T>
 LinkedList<T>::LinkedList(size_t offset) : mLinkOffset(offset), mHead(NULL), mTail(NULL), mSize(0) {
 }
 
+template<class T>
+template<class L>
+size_t LinkedList<T>::offsetOf(L T::* link) {
+	// The item is never constructed. Only the address of its link is used
+	alignas(T) char item[sizeof(T)];
+	Link* const address = &(reinterpret_cast<T*>(item)->*link);
+	return reinterpret_cast<char*>(address) - item;
+}
+
 template<class T>
 LinkedList<T>::~LinkedList() {
 	unlinkAll();
@@ -1,3 +1,13 @@
 #include "ESHeader.h"
 
 ESHeader INVALID_HEADER;
+
+bool isRequestPropertiesValid(const ESHeader* header) {
+	if ((header->properties & ~(ESPROP_MULTIPART | ESPROP_INCLUDE_TIMESTAMP | ESPROP_TYPE_IDS)) != 0) {
+		return false;
+	}
+	if ((header->properties & (ESPROP_MULTIPART | ESPROP_TYPE_IDS)) != 0) {
+		return header->type == REQ_COMMIT_TRANSACTION;
+	}
+	return true;
+}
@@ -16,7 +16,10 @@ enum ESHeaderProperty {
 	
 	ESPROP_COMPRESSED = 2u,
 
-	ESPROP_INCLUDE_TIMESTAMP = 4u
+	ESPROP_INCLUDE_TIMESTAMP = 4u,
+
+	// The types of a commit are sent as ids retrieved with REQ_REGISTER_TYPES instead of as names
+	ESPROP_TYPE_IDS = 8u
 };
 
 // Header for all messages sent to the server
@@ -47,4 +50,8 @@ static const uint32_t VERSION = 1;
 // Represents an invalid header
 extern ESHeader INVALID_HEADER;
 
+// Check if the properties of the supplied request header are supported. Only commits can be sent in many parts or
+// with type ids
+bool isRequestPropertiesValid(const ESHeader* header);
+
 #endif
\ No newline at end of file
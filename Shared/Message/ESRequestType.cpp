@@ -12,6 +12,9 @@ namespace
 			"REQ_ROLLBACK_TRANSACTION",
 			"REQ_READ_JOURNAL",
 			"REQ_JOURNAL_EXISTS",
+			"REQ_READ_JOURNAL_EVENTS",
+			"REQ_READ_JOURNAL_RANGE",
+			"REQ_REGISTER_TYPES",
 			"REQ_SERVER_TYPES",
 			"REQ_SHUTDOWN",
 			"REQ_STATUS",
@@ -18,6 +18,9 @@ enum ESRequestType : uint32_t  {
 	REQ_ROLLBACK_TRANSACTION,
 	REQ_READ_JOURNAL,
 	REQ_JOURNAL_EXISTS,
+	REQ_READ_JOURNAL_EVENTS,
+	REQ_READ_JOURNAL_RANGE,
+	REQ_REGISTER_TYPES,
 
 	//
 	// Internal request types
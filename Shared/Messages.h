@@ -61,7 +61,7 @@ struct CommitTransaction
 	struct Request
 	{
 		uint32_t journalStringLength;    // Length of the journal name
-		uint32_t typeSize;                // The byte size for the event types
+		uint32_t typeSize;                // The byte size for the event types. 4 bytes per type with ESPROP_TYPE_IDS
 		uint32_t eventsSize;            // The byte size for the actual events
 		TransactionID transactionUID;        // A unique identifier for the current transaction
 		// TODO: Add a hash that ensures that we can use to ensure the data to be consistent
@@ -176,6 +176,63 @@ struct ReadJournal
 static_assert(sizeof(ReadJournal::Request) == 12, "Expected ReadJournal::Request to be 12 byte(s)");
 static_assert(sizeof(ReadJournal::Response) == 4, "Expected ReadJournal::Response to be 4 byte(s)");
 
+struct ReadJournalEvents
+{
+	static const ESRequestType TYPE = REQ_READ_JOURNAL_EVENTS;
+
+	struct Header : ESHeader
+	{
+		Header(uint32_t requestId, ESHeaderProperties properties, ProcessID workerId)
+				: ESHeader(TYPE, sizeof(Response), requestId, properties, workerId) {}
+
+		~Header() {}
+	};
+
+	struct Request
+	{
+		uint32_t journalStringLength;    // Length of the journal name
+		uint32_t firstEvent;            // The number of the first event we want to read. The first event in a journal is 0
+		uint32_t eventCount;            // The maximum amount of events we want to read
+	};
+
+	struct Response
+	{
+		uint32_t bytes;                // The total amount of bytes sent back the the client
+		uint32_t eventCount;            // The amount of events sent back to the client
+
+		Response(uint32_t bytes, uint32_t eventCount) : bytes(bytes), eventCount(eventCount) {}
+
+		~Response() {}
+	};
+};
+
+static_assert(sizeof(ReadJournalEvents::Request) == 12, "Expected ReadJournalEvents::Request to be 12 byte(s)");
+static_assert(sizeof(ReadJournalEvents::Response) == 8, "Expected ReadJournalEvents::Response to be 8 byte(s)");
+
+struct ReadJournalRange
+{
+	static const ESRequestType TYPE = REQ_READ_JOURNAL_RANGE;
+
+	struct Header : ESHeader
+	{
+		Header(uint32_t requestId, ESHeaderProperties properties, ProcessID workerId)
+				: ESHeader(TYPE, sizeof(Response), requestId, properties, workerId) {}
+
+		~Header() {}
+	};
+
+	struct Request
+	{
+		uint32_t journalStringLength;    // Length of the journal name
+		char fromTimestamp[24];        // Read events written at, or after, this timestamp. Can be shortened, such as "2019-10-01T00:00"
+		char toTimestamp[24];            // Stop at the first event written at, or after, this timestamp. Empty to read all events
+	};
+
+	typedef ReadJournalEvents::Response Response;
+};
+
+static_assert(sizeof(ReadJournalRange::Request) == 52, "Expected ReadJournalRange::Request to be 52 byte(s)");
+
 struct JournalExists
 {
 	static const ESRequestType TYPE = REQ_JOURNAL_EXISTS;
@@ -206,4 +263,36 @@ struct JournalExists
 static_assert(sizeof(JournalExists::Request) == 4, "Expected JournalExists::Request to be 4 byte(s)");
 static_assert(sizeof(JournalExists::Response) == 1, "Expected JournalExists::Response to be 1 byte(s)");
 
+// Registers event type names with a worker, so that commits to the worker can send the types as ids. The ids are
+// valid for as long as the worker is running and are only known by the worker that assigned them
+struct RegisterTypes
+{
+	static const ESRequestType TYPE = REQ_REGISTER_TYPES;
+
+	struct Header : ESHeader
+	{
+		Header(uint32_t requestId, uint32_t count, ProcessID workerId)
+				: ESHeader(TYPE, sizeof(Response) + count * sizeof(uint32_t), requestId, ESPROP_NONE, workerId) {}
+
+		~Header() {}
+	};
+
+	struct Request
+	{
+		uint32_t typeSize;                // The byte size for the comma separated event types that follow
+	};
+
+	struct Response
+	{
+		uint32_t count;                    // The number of type ids that follow, one for each type in the request
+
+		Response(uint32_t count) : count(count) {}
+
+		~Response() {}
+	};
+};
+
+static_assert(sizeof(RegisterTypes::Request) == 4, "Expected RegisterTypes::Request to be 4 byte(s)");
+static_assert(sizeof(RegisterTypes::Response) == 4, "Expected RegisterTypes::Response to be 4 byte(s)");
+
 #endif
@@ -0,0 +1,108 @@
+#ifndef _EVERSTORE_MPSC_QUEUE_H_
+#define _EVERSTORE_MPSC_QUEUE_H_
+
+#include "es_config.h"
+
+//
+// The link used by the items in a MpscQueue
+struct MpscNode
+{
+	atomic<MpscNode*> next;
+};
+
+//
+// A lock-free queue that many threads can push items to while one thread pops them. Pushing an item never waits for
+// the other threads. The items must inherit from MpscNode and are owned by the caller
+template<class T>
+class MpscQueue
+{
+public:
+	MpscQueue();
+
+	//
+	// Add an item to the end of the queue. Can be called by any thread
+	void push(T* item);
+
+	//
+	// Remove the first item from the queue. Must only be called by one thread at a time
+	//
+	// \return The item; nullptr if the queue is empty or if the next item is not completely pushed yet
+	T* pop();
+
+	//
+	// Check if the queue is empty. Must only be called by the thread that pops the items
+	bool empty() const;
+
+private:
+	void pushNode(MpscNode* node);
+
+private:
+	// The last pushed item
+	atomic<MpscNode*> mHead;
+
+	// The next item to be popped
+	MpscNode* mTail;
+
+	// Keeps the queue linked when all items are popped
+	MpscNode mStub;
+};
+
+template<class T>
+MpscQueue<T>::MpscQueue()
+		: mHead(&mStub), mTail(&mStub) {
+	mStub.next = nullptr;
+}
+
+template<class T>
+void MpscQueue<T>::push(T* item) {
+	pushNode(item);
+}
+
+template<class T>
+void MpscQueue<T>::pushNode(MpscNode* node) {
+	node->next.store(nullptr, memory_order_relaxed);
+	MpscNode* const prev = mHead.exchange(node);
+
+	// The item can't be popped until the previous item links to it
+	prev->next.store(node, memory_order_release);
+}
+
+template<class T>
+T* MpscQueue<T>::pop() {
+	MpscNode* tail = mTail;
+	MpscNode* next = tail->next.load(memory_order_acquire);
+	if (tail == &mStub) {
+		if (next == nullptr) {
+			return nullptr;
+		}
+		mTail = next;
+		tail = next;
+		next = next->next.load(memory_order_acquire);
+	}
+	if (next != nullptr) {
+		mTail = next;
+		return static_cast<T*>(tail);
+	}
+
+	// Another thread is pushing an item after the last one
+	if (tail != mHead.load(memory_order_acquire)) {
+		return nullptr;
+	}
+
+	// Put the stub after the last item, so that the last item can be popped
+	pushNode(&mStub);
+	next = tail->next.load(memory_order_acquire);
+	if (next != nullptr) {
+		mTail = next;
+		return static_cast<T*>(tail);
+	}
+	return nullptr;
+}
+
+template<class T>
+bool MpscQueue<T>::empty() const {
+	return mTail == &mStub && mStub.next.load(memory_order_acquire) == nullptr &&
+	       mHead.load() == &mStub;
+}
+
+#endif
@@ -86,9 +86,12 @@ ESErrorCode OsMutex::Destroy(OsMutex* mutex) {
 		pthread_mutex_destroy(mutex->ptr);
 	}
 
-	// Unmap the memory for the mutex
+	// Unmap the memory for the mutex. The name is only removed by the host, since it might already be reused by the
+	// mutex of a new client when a worker gets around to destroying its copy
 	munmap(mutex->ptr, sizeof(pthread_mutex_t));
-	shm_unlink(mutex->name);
+	if (mutex->onHost) {
+		shm_unlink(mutex->name);
+	}
 	return ESERR_NO_ERROR;
 }
 
@@ -26,6 +26,14 @@ public:
 
 	inline int32_t Write(const char* buffer, uint32_t size) { return OsProcess::Write(&mProcess, buffer, size); }
 
+	/**
+	 * Wait until data can be read from this process
+	 *
+	 * @param timeoutMicros How long, in microseconds, we are allowed to wait for the data
+	 * @return <code>true</code> if data is available before the timeout expired
+	 */
+	inline bool WaitForData(uint32_t timeoutMicros) { return OsProcess::WaitForData(&mProcess, timeoutMicros); }
+
 	inline ESErrorCode WaitForClosed(uint32_t timeout = UINT32_MAX) {
 		return OsProcess::WaitForClosed(&mProcess, timeout);
 	}
@@ -5,6 +5,7 @@
 #include "UnixProcess.hpp"
 #include <sys/un.h>
 #include <sys/socket.h>
+#include <sys/select.h>
 #include "../../Socket/Unix/UnixSocket.hpp"
 #include "../../Log/Log.hpp"
 
@@ -229,3 +230,18 @@ int32_t OsProcess::Read(OsProcess* process, char* bytes, uint32_t size) {
 
 	return UnixSocketReceiveAll(process->unixSocket, bytes, size);
 }
+
+bool OsProcess::WaitForData(OsProcess* process, uint32_t timeoutMicros) {
+	if (IsInvalid(process)) {
+		return false;
+	}
+
+	// The select timeout has a resolution in microseconds, which is needed for short group-commit windows
+	fd_set readSet;
+	FD_ZERO(&readSet);
+	FD_SET(process->unixSocket, &readSet);
+	struct timeval timeout;
+	timeout.tv_sec = timeoutMicros / 1000000u;
+	timeout.tv_usec = timeoutMicros % 1000000u;
+	return select(process->unixSocket + 1, &readSet, nullptr, nullptr, &timeout) > 0;
+}
@@ -32,6 +32,8 @@ struct OsProcess
 
 	static int32_t Read(OsProcess* process, char* bytes, uint32_t size);
 
+	static bool WaitForData(OsProcess* process, uint32_t timeoutMicros);
+
 	static bool IsInvalid(const OsProcess* process) { return process == nullptr || !process->running; }
 };
 
@@ -172,3 +172,21 @@ int32_t OsProcess::Read(OsProcess* p, char* bytes, uint32_t size) {
 	} while (result && totalBytes < (int32_t) size);
 	return totalBytes;
 }
+
+bool OsProcess::WaitForData(OsProcess* p, uint32_t timeoutMicros) {
+	if (p == nullptr || !p->running) {
+		return false;
+	}
+
+	// Named pipes cannot be waited on without overlapped I/O, so peek once before and once after the timeout
+	DWORD bytesAvailable = 0;
+	if (PeekNamedPipe(p->pipe, nullptr, 0, nullptr, &bytesAvailable, nullptr) && bytesAvailable > 0) {
+		return true;
+	}
+	if (timeoutMicros == 0) {
+		return false;
+	}
+	Sleep(timeoutMicros < 1000u ? 1u : timeoutMicros / 1000u);
+	bytesAvailable = 0;
+	return PeekNamedPipe(p->pipe, nullptr, 0, nullptr, &bytesAvailable, nullptr) && bytesAvailable > 0;
+}
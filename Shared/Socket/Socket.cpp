@@ -108,7 +108,7 @@ int32_t Socket::ReceiveAll(char* buffer, uint32_t size) {
 
 	int32_t totalRecv = 0;
 	while (totalRecv != size) {
-		const auto t = recv(mSocket.socket, buffer, size - totalRecv, 0);
+		const auto t = recv(mSocket.socket, buffer + totalRecv, size - totalRecv, 0);
 		if (t <= 0)
 			return totalRecv;
 		totalRecv += t;
@@ -116,6 +116,18 @@ int32_t Socket::ReceiveAll(char* buffer, uint32_t size) {
 	return totalRecv;
 }
 
+int32_t Socket::Receive(char* buffer, uint32_t size) {
+	if (IsDestroyed()) {
+		return -1;
+	}
+
+	const auto t = recv(mSocket.socket, buffer, size, 0);
+	if (t < 0) {
+		return -1;
+	}
+	return (int32_t) t;
+}
+
 int32_t Socket::SendAll(const char* bytes, uint32_t size) {
 	if (IsDestroyed()) {
 		return -1;
@@ -123,7 +135,7 @@ int32_t Socket::SendAll(const char* bytes, uint32_t size) {
 
 	int32_t totalSend = 0;
 	while (totalSend != size) {
-		const auto t = send(mSocket.socket, bytes, size - totalSend, 0);
+		const auto t = send(mSocket.socket, bytes + totalSend, size - totalSend, 0);
 		if (t <= 0)
 			return totalSend;
 		totalSend += t;
@@ -131,6 +143,22 @@ int32_t Socket::SendAll(const char* bytes, uint32_t size) {
 	return totalSend;
 }
 
+int32_t Socket::SendFile(FILE* file, uint32_t offset, uint32_t size) {
+	if (IsDestroyed() || file == nullptr) {
+		return -1;
+	}
+
+	return OsSocket::SendFile(&mSocket, fileno(file), offset, size);
+}
+
+int32_t Socket::SendAll(const SocketPart* parts, uint32_t count) {
+	if (IsDestroyed() || (parts == nullptr && count > 0)) {
+		return -1;
+	}
+
+	return OsSocket::SendAll(&mSocket, parts, count);
+}
+
 ESErrorCode Socket::ShareWithProcess(Process* process) {
 	if (IsDestroyed()) {
 		return ESERR_SCCKET_DESTROYED;
@@ -7,6 +7,16 @@
 
 #include "Port.hpp"
 #include "../ESErrorCodes.h"
+#include <cstdio>
+
+/**
+ * A block of memory sent together with other blocks
+ */
+struct SocketPart
+{
+	const char* bytes;
+	uint32_t size;
+};
 
 #if defined(_WIN32)
 
@@ -93,6 +103,15 @@ public:
 	 */
 	int32_t ReceiveAll(char* buffer, uint32_t size);
 
+	/**
+	 * Receive the bytes that are available, but no more than the supplied size. Only blocks if no bytes are available
+	 *
+	 * @param buffer Where the bytes are put
+	 * @param size The maximum number of bytes to receive
+	 * @return The number of bytes received, 0 if the connection is closed or -1 if the socket is destroyed or failed
+	 */
+	int32_t Receive(char* buffer, uint32_t size);
+
 	/**
 	 *
 	 * @tparam Max
@@ -120,6 +139,25 @@ public:
 	 */
 	int32_t SendAll(const char* bytes, uint32_t size);
 
+	/**
+	 * Send a part of the supplied file directly from the file cache to the socket, without copying it into user memory
+	 *
+	 * @param file The file containing the bytes
+	 * @param offset Where in the file the bytes start
+	 * @param size The number of bytes to send
+	 * @return The number of bytes sent or -1 if the socket is destroyed
+	 */
+	int32_t SendFile(FILE* file, uint32_t offset, uint32_t size);
+
+	/**
+	 * Send all the supplied memory blocks, in order, using as few system calls as possible
+	 *
+	 * @param parts The memory blocks
+	 * @param count The number of memory blocks
+	 * @return The number of bytes sent or -1 if the socket is destroyed
+	 */
+	int32_t SendAll(const SocketPart* parts, uint32_t count);
+
 	/**
 	 * @param process
 	 * @return
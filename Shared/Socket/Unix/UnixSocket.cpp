@@ -3,10 +3,18 @@
 //
 
 #include "UnixSocket.hpp"
+#include "../Socket.hpp"
 #include "../../Process/Unix/UnixProcess.hpp"
 #include "../../Log/Log.hpp"
 #include <sys/un.h>
 #include <netinet/tcp.h>
+#include <cerrno>
+#include <climits>
+#include <sys/uio.h>
+
+#if !defined(__APPLE__)
+#include <sys/sendfile.h>
+#endif
 
 ESErrorCode OsSocket::ShareWithProcess(OsSocket* socket, OsProcess* process) {
 	if (IsInvalid(socket)) {
@@ -172,3 +180,78 @@ ESErrorCode OsSocket::Close(OsSocket* socket) {
 
 	return ESERR_NO_ERROR;
 }
+
+int32_t OsSocket::SendFile(OsSocket* socket, int fd, uint32_t offset, uint32_t size) {
+	if (IsInvalid(socket)) {
+		return -1;
+	}
+
+	uint32_t totalSend = 0;
+	while (totalSend != size) {
+#if defined(__APPLE__)
+		off_t len = size - totalSend;
+		const auto result = ::sendfile(fd, socket->socket, offset + totalSend, &len, nullptr, 0);
+		const auto t = (ssize_t) len;
+		if (result == -1 && t == 0 && errno != EINTR && errno != EAGAIN) {
+			break;
+		}
+#else
+		off_t off = offset + totalSend;
+		const auto t = ::sendfile(socket->socket, fd, &off, size - totalSend);
+		if (t == -1 && errno == EINTR) {
+			continue;
+		}
+#endif
+		if (t <= 0) {
+			break;
+		}
+		totalSend += t;
+	}
+	return totalSend;
+}
+
+int32_t OsSocket::SendAll(OsSocket* socket, const SocketPart* parts, uint32_t count) {
+	if (IsInvalid(socket)) {
+		return -1;
+	}
+
+	// Send as many parts as possible with each call. The parts that are partially sent are continued by the next call
+	struct iovec vectors[64];
+	uint32_t next = 0;
+	uint32_t nextOffset = 0;
+	int32_t totalSend = 0;
+	while (next < count) {
+		int vectorCount = 0;
+		for (uint32_t i = next; i < count && vectorCount < 64 && vectorCount < IOV_MAX; ++i) {
+			const uint32_t offset = i == next ? nextOffset : 0;
+			if (parts[i].size == offset) {
+				continue;
+			}
+			vectors[vectorCount].iov_base = (void*) (parts[i].bytes + offset);
+			vectors[vectorCount].iov_len = parts[i].size - offset;
+			vectorCount++;
+		}
+		if (vectorCount == 0) {
+			break;
+		}
+
+		const auto t = ::writev(socket->socket, vectors, vectorCount);
+		if (t == -1 && errno == EINTR) {
+			continue;
+		}
+		if (t <= 0) {
+			break;
+		}
+		totalSend += t;
+
+		// Skip the parts that are completely sent
+		size_t sent = (size_t) t;
+		while (next < count && sent >= parts[next].size - nextOffset) {
+			sent -= parts[next].size - nextOffset;
+			next++;
+			nextOffset = 0;
+		}
+		nextOffset += (uint32_t) sent;
+	}
+	return totalSend;
+}
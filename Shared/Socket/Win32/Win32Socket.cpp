@@ -3,7 +3,9 @@
 //
 
 #include "Win32Socket.hpp"
+#include "../Socket.hpp"
 #include "../../Process/Win32/Win32Process.hpp"
+#include <io.h>
 
 ESErrorCode OsSocket::ShareWithProcess(OsSocket* socket, OsProcess* process) {
 	if (IsInvalid(socket)) {
@@ -109,3 +111,53 @@ ESErrorCode OsSocket::Close(OsSocket* socket) {
 	}
 	return ESERR_NO_ERROR;
 }
+
+int32_t OsSocket::SendFile(OsSocket* socket, int fd, uint32_t offset, uint32_t size) {
+	if (IsInvalid(socket)) {
+		return -1;
+	}
+
+	// There are no zero-copy equivalent for CRT file descriptors, so the bytes are sent through a temporary buffer
+	char buffer[64 * 1024];
+	uint32_t totalSend = 0;
+	if (_lseek(fd, offset, SEEK_SET) == -1L) {
+		return 0;
+	}
+	while (totalSend != size) {
+		const auto bytesLeft = size - totalSend;
+		const auto readBytes = _read(fd, buffer, bytesLeft < sizeof(buffer) ? bytesLeft : sizeof(buffer));
+		if (readBytes <= 0) {
+			break;
+		}
+		int32_t sent = 0;
+		while (sent != readBytes) {
+			const auto t = send(socket->socket, buffer + sent, readBytes - sent, 0);
+			if (t <= 0) {
+				return totalSend + sent;
+			}
+			sent += t;
+		}
+		totalSend += sent;
+	}
+	return totalSend;
+}
+
+int32_t OsSocket::SendAll(OsSocket* socket, const SocketPart* parts, uint32_t count) {
+	if (IsInvalid(socket)) {
+		return -1;
+	}
+
+	int32_t totalSend = 0;
+	for (uint32_t i = 0; i < count; ++i) {
+		uint32_t sent = 0;
+		while (sent != parts[i].size) {
+			const auto t = send(socket->socket, parts[i].bytes + sent, parts[i].size - sent, 0);
+			if (t <= 0) {
+				return totalSend + sent;
+			}
+			sent += t;
+		}
+		totalSend += sent;
+	}
+	return totalSend;
+}
@@ -10,6 +10,7 @@
 #include "../../ESErrorCodes.h"
 
 struct OsProcess;
+struct SocketPart;
 
 struct OsSocket
 {
@@ -32,6 +33,12 @@ struct OsSocket
 
 	static ESErrorCode Close(OsSocket* socket);
 
+	// Send bytes from the supplied file descriptor without copying them into user memory. Returns the number of bytes sent
+	static int32_t SendFile(OsSocket* socket, int fd, uint32_t offset, uint32_t size);
+
+	// Send all the supplied memory blocks in order. Returns the number of bytes sent
+	static int32_t SendAll(OsSocket* socket, const SocketPart* parts, uint32_t count);
+
 	static bool IsInvalid(const OsSocket* s) { return s->socket == INVALID_SOCKET; }
 };
 
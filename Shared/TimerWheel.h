@@ -0,0 +1,222 @@
+#ifndef _EVERSTORE_TIMER_WHEEL_H_
+#define _EVERSTORE_TIMER_WHEEL_H_
+
+#include "es_config.h"
+#include "LinkedList.h"
+
+//
+// The link used by the items in a TimerWheel. Remembers the tick when the item expires
+template<class T>
+class TimerWheelLink : public LinkedListLink<T>
+{
+public:
+	TimerWheelLink() : tick(0) {}
+
+	uint64_t tick;
+};
+
+//
+// A hierarchical timer wheel. The first level has one slot for each of the next 64 ticks, and each level above has
+// slots that are 64 times as long as the level below. The items in a slot are moved one level down when the level
+// below has gone around once, so adding, removing and expiring an item never depends on how many items there are.
+//
+// The items are linked with a TimerWheelLink and are owned by the caller. An item is removed from the wheel when it's
+// deleted. The ticks are counted by the caller, which means that the wheel never reads the clock
+template<class T>
+class TimerWheel
+{
+public:
+	static constexpr uint32_t SlotBits = 6u;
+	static constexpr uint32_t Slots = 1u << SlotBits;
+	static constexpr uint32_t Levels = 4u;
+
+	// The most number of ticks until an item expires. Items that are added to expire later expire after this many ticks
+	static constexpr uint64_t MaxTicks = (1ull << (SlotBits * Levels)) - 1u;
+
+	//
+	// \param link The TimerWheelLink in the items
+	// \param tick The first tick
+	explicit TimerWheel(TimerWheelLink<T> T::* link, uint64_t tick = 0);
+
+	~TimerWheel();
+
+	//
+	// Add an item that expires when the supplied tick has passed. An item that's already added is moved
+	void add(T* item, uint64_t tick);
+
+	//
+	// Remove an item. Nothing happens if the item is not added
+	void remove(T* item);
+
+	//
+	// Expire all items up to and including the supplied tick. Each item is removed from the wheel before the
+	// callback is called, so the callback is allowed to delete it
+	//
+	// \return The number of expired items
+	template<class F>
+	uint32_t advance(uint64_t tick, F onExpired);
+
+	//
+	// \return The number of ticks after the next tick that's expired until an item might expire; UINT64_MAX if the
+	//         wheel is empty
+	uint64_t ticksUntilNext() const;
+
+	// Is the wheel empty
+	bool empty() const;
+
+	// The next tick that will be expired
+	inline uint64_t tick() const { return mTick; }
+
+private:
+	inline LinkedList<T>* slot(uint32_t level, uint32_t index) const { return mSlots[level * Slots + index]; }
+
+	inline TimerWheelLink<T>* getLink(T* item) const {
+		return reinterpret_cast<TimerWheelLink<T>*>(reinterpret_cast<char*>(item) + mOffset);
+	}
+
+	// Put the item in the slot that matches its tick
+	void place(T* item);
+
+	// Move the items in a slot to the levels below
+	void cascade(uint32_t level, uint32_t index);
+
+private:
+	const size_t mOffset;
+	uint64_t mTick;
+	vector<LinkedList<T>*> mSlots;
+};
+
+template<class T>
+constexpr uint32_t TimerWheel<T>::Slots;
+
+template<class T>
+constexpr uint64_t TimerWheel<T>::MaxTicks;
+
+template<class T>
+TimerWheel<T>::TimerWheel(TimerWheelLink<T> T::* link, uint64_t tick)
+		: mOffset(LinkedList<T>::offsetOf(link)), mTick(tick) {
+	mSlots.reserve(Levels * Slots);
+	for (uint32_t i = 0; i < Levels * Slots; ++i) {
+		mSlots.push_back(new LinkedList<T>(mOffset));
+	}
+}
+
+template<class T>
+TimerWheel<T>::~TimerWheel() {
+	for (auto list : mSlots) {
+		delete list;
+	}
+	mSlots.clear();
+}
+
+template<class T>
+void TimerWheel<T>::add(T* item, uint64_t tick) {
+	remove(item);
+
+	// Items that have already expired are expired with the next tick
+	if (tick < mTick) {
+		tick = mTick;
+	} else if (tick - mTick > MaxTicks) {
+		tick = mTick + MaxTicks;
+	}
+	getLink(item)->tick = tick;
+	place(item);
+}
+
+template<class T>
+void TimerWheel<T>::remove(T* item) {
+	getLink(item)->unlink();
+}
+
+template<class T>
+void TimerWheel<T>::place(T* item) {
+	const uint64_t tick = getLink(item)->tick;
+	const uint64_t delta = tick > mTick ? tick - mTick : 0u;
+	uint32_t level = 0;
+	while (level < Levels - 1 && delta >= (1ull << (SlotBits * (level + 1)))) {
+		level++;
+	}
+	const uint64_t due = tick > mTick ? tick : mTick;
+	const auto index = (uint32_t) ((due >> (SlotBits * level)) & (Slots - 1));
+	slot(level, index)->addLast(item);
+}
+
+template<class T>
+void TimerWheel<T>::cascade(uint32_t level, uint32_t index) {
+	LinkedList<T>* const list = slot(level, index);
+	T* item;
+	while ((item = list->first()) != nullptr) {
+		list->remove(item);
+		place(item);
+	}
+}
+
+template<class T>
+template<class F>
+uint32_t TimerWheel<T>::advance(uint64_t tick, F onExpired) {
+	// Nothing to go through if the wheel is empty
+	if (empty()) {
+		if (tick >= mTick) {
+			mTick = tick + 1;
+		}
+		return 0;
+	}
+
+	uint32_t expired = 0;
+	while (mTick <= tick) {
+		// Move the items down from the levels above when the level below has gone around once
+		const auto index = (uint32_t) (mTick & (Slots - 1));
+		if (index == 0) {
+			for (uint32_t level = 1; level < Levels; ++level) {
+				const auto levelIndex = (uint32_t) ((mTick >> (SlotBits * level)) & (Slots - 1));
+				cascade(level, levelIndex);
+				if (levelIndex != 0) {
+					break;
+				}
+			}
+		}
+
+		// Items added by the callback are never expired by this tick
+		mTick++;
+		LinkedList<T>* const list = slot(0, index);
+		T* item;
+		while ((item = list->first()) != nullptr) {
+			list->remove(item);
+			expired++;
+			onExpired(item);
+		}
+	}
+	return expired;
+}
+
+template<class T>
+uint64_t TimerWheel<T>::ticksUntilNext() const {
+	uint64_t ticks = UINT64_MAX;
+	const auto index = (uint32_t) (mTick & (Slots - 1));
+	for (uint32_t i = 0; i < Slots; ++i) {
+		if (!slot(0, (index + i) & (Slots - 1))->empty()) {
+			ticks = i;
+			break;
+		}
+	}
+
+	// The items in the levels above might expire after the first level has gone around
+	for (uint32_t i = Slots; i < mSlots.size(); ++i) {
+		if (!mSlots[i]->empty()) {
+			return std::min(ticks, (uint64_t) ((Slots - index) & (Slots - 1)));
+		}
+	}
+	return ticks;
+}
+
+template<class T>
+bool TimerWheel<T>::empty() const {
+	for (auto list : mSlots) {
+		if (!list->empty()) {
+			return false;
+		}
+	}
+	return true;
+}
+
+#endif
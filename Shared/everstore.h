@@ -9,6 +9,7 @@
 #include "Memory/ByteBuffer.h"
 #include "Messages.h"
 #include "Database/Journal.h"
+#include "Database/TypeInterner.hpp"
 #include "AutoClosable.h"
 #include "Mutex/Mutex.hpp"
 
@@ -0,0 +1,107 @@
+#include "../Worker/ChunkScheduler.h"
+#include "test/Test.h"
+
+namespace
+{
+	// A read that sends the supplied number of responses, or fails with an error
+	class PartsTask : public ChunkTask
+	{
+	public:
+		PartsTask(const AttachedConnection* connection, uint32_t requestUID, Journal* journal, uint32_t parts,
+		          vector<uint32_t>* sent, ESErrorCode error = ESERR_NO_ERROR)
+				: ChunkTask(connection, requestUID, journal, 1024u, ProcessID(1)), mParts(parts), mSent(sent),
+				  mError(error) {
+		}
+
+		ESErrorCode sendNext(ByteBuffer* memory, bool* done) final {
+			if (isError(mError)) {
+				return mError;
+			}
+			mSent->push_back(mRequestUID);
+			*done = --mParts == 0;
+			return ESERR_NO_ERROR;
+		}
+
+	private:
+		uint32_t mParts;
+		vector<uint32_t>* const mSent;
+		const ESErrorCode mError;
+	};
+
+	const AttachedConnection* const first = (const AttachedConnection*) 0x10;
+	const AttachedConnection* const second = (const AttachedConnection*) 0x20;
+}
+
+TEST_SUITE(ChunkScheduler)
+{
+	static const string logSuffix(".log");
+
+	UNIT_TEST(connectionsTakeTurns) {
+		Journal journal(Path(FileUtils::getTempFile() + logSuffix));
+		vector<uint32_t> sent;
+		ChunkScheduler scheduler;
+		scheduler.add(new PartsTask(first, 1u, &journal, 3u, &sent));
+		scheduler.add(new PartsTask(first, 2u, &journal, 2u, &sent));
+		scheduler.add(new PartsTask(second, 3u, &journal, 2u, &sent));
+		assertEquals(3U, scheduler.depth());
+		assertTrue(journal.hasReaders());
+
+		ByteBuffer memory(1024u);
+		while (!scheduler.empty()) {
+			assertEquals((ESErrorCode) ESERR_NO_ERROR, scheduler.sendNext(&memory));
+		}
+
+		// The reads for the same connection are sent in the order they arrived
+		const vector<uint32_t> expected = {1u, 3u, 1u, 3u, 1u, 2u, 2u};
+		assertTrue(sent == expected);
+		assertEquals(7U, (uint32_t) scheduler.chunks());
+		assertEquals(3U, scheduler.maxDepth());
+		assertFalse(journal.hasReaders());
+	}
+
+	UNIT_TEST(removedConnectionLosesItsTurn) {
+		Journal journal(Path(FileUtils::getTempFile() + logSuffix));
+		vector<uint32_t> sent;
+		ChunkScheduler scheduler;
+		scheduler.add(new PartsTask(first, 1u, &journal, 2u, &sent));
+		scheduler.add(new PartsTask(second, 2u, &journal, 2u, &sent));
+		scheduler.remove(first);
+		assertEquals(1U, scheduler.depth());
+
+		ByteBuffer memory(1024u);
+		while (!scheduler.empty()) {
+			scheduler.sendNext(&memory);
+		}
+		const vector<uint32_t> expected = {2u, 2u};
+		assertTrue(sent == expected);
+	}
+
+	UNIT_TEST(failedReadSendsErrorForItsRequest) {
+		int sockets[2];
+		assertEquals(0, socketpair(AF_UNIX, SOCK_STREAM, 0, sockets));
+		Socket socket(sockets[0], 1024);
+		std::unique_ptr<Mutex> lock(Mutex::Create("/everstore_chunk_scheduler_test"));
+		assertNotNull(lock.get());
+		const AttachedConnection connection = {&socket, lock.get(), nullptr, 1};
+
+		Journal journal(Path(FileUtils::getTempFile() + logSuffix));
+		vector<uint32_t> sent;
+		ChunkScheduler scheduler;
+		scheduler.add(new PartsTask(&connection, 42u, &journal, 2u, &sent, ESERR_JOURNAL_READ));
+
+		ByteBuffer memory(1024u);
+		assertEquals((ESErrorCode) ESERR_NO_ERROR, scheduler.sendNext(&memory));
+		assertTrue(scheduler.empty());
+		assertFalse(journal.hasReaders());
+
+		// The client finds the failed request by its id
+		char received[sizeof(RequestError::Header) + sizeof(RequestError::Response)];
+		assertEquals((int) sizeof(received), (int) recv(sockets[1], received, sizeof(received), MSG_WAITALL));
+		const auto header = (const ESHeader*) received;
+		const auto response = (const RequestError::Response*) (received + sizeof(ESHeader));
+		assertEquals(REQ_ERROR, header->type);
+		assertEquals(42U, header->requestUID);
+		assertEquals((ESErrorCode) ESERR_JOURNAL_READ, response->errorCode);
+		close(sockets[1]);
+	}
+}
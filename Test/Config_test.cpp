@@ -18,6 +18,22 @@ TEST_SUITE(Config)
 		assertEquals((uint32_t) DEFAULT_JOURNAL_GC_SECONDS, p.maxJournalLifeTime);
 		assertEquals((uint32_t) DEFAULT_MAX_DATA_SEND_SIZE, p.maxBufferSize);
 		assertEquals((uint32_t) DEFAULT_LOG_LEVEL, p.logLevel);
+		assertEquals((uint32_t) DEFAULT_GROUP_COMMIT_MICROS, p.groupCommitMicros);
+		assertEquals((uint32_t) DEFAULT_GROUP_COMMIT_MAX_BYTES, p.groupCommitMaxBytes);
+		assertEquals((uint32_t) DEFAULT_DURABILITY, (uint32_t) p.durability);
+		assertEquals((uint32_t) DEFAULT_DURABILITY_INTERVAL_MILLIS, p.durabilityIntervalMillis);
+		assertEquals((uint32_t) DEFAULT_JOURNAL_FORMAT, (uint32_t) p.journalFormat);
+		assertEquals((uint32_t) DEFAULT_MMAP_READ_MIN_BYTES, p.mmapReadMinBytes);
+		assertEquals((uint32_t) DEFAULT_MAX_OPEN_JOURNALS, p.maxOpenJournals);
+		assertEquals((uint32_t) DEFAULT_READER_THREADS, p.readerThreads);
+		assertEquals((uint32_t) DEFAULT_IO_URING_ENTRIES, p.ioUringEntries);
+		assertEquals((uint32_t) DEFAULT_IO_THREADS, p.ioThreads);
+		assertEquals((uint32_t) DEFAULT_IPC_RING_SIZE, p.ipcRingSize);
+		assertEquals((uint32_t) DEFAULT_SERVER_RESPONSES, p.serverResponses);
+		assertEquals((uint32_t) DEFAULT_MAX_PIPELINED_REQUESTS, p.maxPipelinedRequests);
+		assertEquals((uint32_t) DEFAULT_MAX_COMMIT_SIZE, p.maxCommitSize);
+		assertEquals((uint32_t) DEFAULT_TRANSACTION_TIMEOUT_MILLIS, p.transactionTimeoutMillis);
+		assertEquals((uint32_t) DEFAULT_STATS_INTERVAL_MILLIS, p.statsIntervalMillis);
 	}
 
 	UNIT_TEST(overrideAllPropertiesFromFile) {
@@ -29,6 +45,22 @@ TEST_SUITE(Config)
 		assertEquals(2U, p.maxConnections);
 		assertEquals((uint16_t) 1234, p.port);
 		assertEquals(123456U, p.maxJournalLifeTime);
+		assertEquals(250U, p.groupCommitMicros);
+		assertEquals(4096U, p.groupCommitMaxBytes);
+		assertEquals((uint32_t) Durability::FDataSyncInterval, (uint32_t) p.durability);
+		assertEquals(50U, p.durabilityIntervalMillis);
+		assertEquals((uint32_t) JournalFormat::V2, (uint32_t) p.journalFormat);
+		assertEquals(4096U, p.mmapReadMinBytes);
+		assertEquals(300U, p.maxOpenJournals);
+		assertEquals(4U, p.readerThreads);
+		assertEquals(64U, p.ioUringEntries);
+		assertEquals(4U, p.ioThreads);
+		assertEquals(262144U, p.ipcRingSize);
+		assertEquals(1U, p.serverResponses);
+		assertEquals(32U, p.maxPipelinedRequests);
+		assertEquals(1048576U, p.maxCommitSize);
+		assertEquals(30000U, p.transactionTimeoutMillis);
+		assertEquals(10000U, p.statsIntervalMillis);
 	}
 
 	UNIT_TEST(overrideOnePropertyFromFile) {
@@ -0,0 +1,99 @@
+#include "../Shared/everstore.h"
+#include "test/Test.h"
+
+TEST_SUITE(FileInputStream)
+{
+	static const string logSuffix(".log");
+
+	void commitEvents(Journal* journal, uint32_t count) {
+		for (uint32_t i = 0; i < count; ++i) {
+			const string data = "event" + std::to_string(i) + "\nline" + std::to_string(i);
+			ByteBuffer bytes(data.length());
+			memcpy(bytes.allocate(data.length()), data.c_str(), data.length());
+			bytes.reset();
+			journal->tryCommit(journal->openTransaction(), TypeSet{1u}, MutableString(data.length(), &bytes));
+		}
+	}
+
+	// Read the journal in small parts, in the same way as a journal is sent to the client
+	string readJournalBytes(FileInputStream* stream, uint32_t size) {
+		string result;
+		while (stream->bytesLeft() > 0) {
+			ByteBuffer memory(64);
+			uint32_t bytes = 0;
+			if (isError(stream->readJournalBytes(&memory, 100, &bytes)) || bytes == 0) {
+				break;
+			}
+			result.append(memory.ptr(), bytes);
+		}
+		return result.substr(0, size);
+	}
+
+	UNIT_TEST(mappedJournalIsReadAsStdioJournal) {
+		const Path journalPath(FileUtils::getTempFile() + logSuffix);
+		JournalOptions options;
+		options.mmapReadMinBytes = 1;
+		Journal j(journalPath, options);
+		commitEvents(&j, 100);
+
+		FILE* file = fopen(journalPath.value.c_str(), "rb");
+		MemoryMappedFile mapping;
+		const auto memory = mapping.map(file, j.journalSize());
+		assertTrue(memory != nullptr);
+
+		const auto stdioEvents = readJournalBytes(AutoClosable<FileInputStream>(
+				new FileInputStream(file, j.journalSize(), 0)).get(), j.journalSize());
+		const auto mappedEvents = readJournalBytes(AutoClosable<FileInputStream>(
+				new FileInputStream(file, j.journalSize(), 0, JournalFormat::V1, memory)).get(), j.journalSize());
+		assertEquals(stdioEvents, mappedEvents);
+		assertEquals(string("event0\nline0\nevent1"), mappedEvents.substr(0, 19));
+
+		ByteBuffer bytes(64);
+		AutoClosable<FileInputStream>(j.inputStream(0))->readBytes(&bytes, j.journalSize());
+		assertEquals(0, memcmp(bytes.ptr(), memory.get(), j.journalSize()));
+		fclose(file);
+	}
+
+	UNIT_TEST(mappedRecordsAreReadAsStdioRecords) {
+		const Path journalPath(FileUtils::getTempFile() + logSuffix);
+		JournalOptions options;
+		options.format = JournalFormat::V2;
+		Journal j(journalPath, options);
+		commitEvents(&j, 100);
+
+		FILE* file = fopen(journalPath.value.c_str(), "rb");
+		MemoryMappedFile mapping;
+		const auto memory = mapping.map(file, j.journalSize());
+
+		ByteBuffer stdioEvents(64);
+		ByteBuffer mappedEvents(64);
+		uint32_t stdioBytes = 0;
+		uint32_t mappedBytes = 0;
+		AutoClosable<FileInputStream>(new FileInputStream(file, j.journalSize(), 0, JournalFormat::V2))
+				->readRecords(&stdioEvents, j.journalSize() * 2, true, &stdioBytes);
+		AutoClosable<FileInputStream>(new FileInputStream(file, j.journalSize(), 0, JournalFormat::V2, memory))
+				->readRecords(&mappedEvents, j.journalSize() * 2, true, &mappedBytes);
+		assertEquals(stdioBytes, mappedBytes);
+		assertEquals(string(stdioEvents.ptr(), stdioBytes), string(mappedEvents.ptr(), mappedBytes));
+		fclose(file);
+	}
+
+	UNIT_TEST(mappedStreamCanBeReadAfterTheJournalIsRemapped) {
+		const Path journalPath(FileUtils::getTempFile() + logSuffix);
+		JournalOptions options;
+		options.mmapReadMinBytes = 1;
+		Journal j(journalPath, options);
+		commitEvents(&j, 10);
+		const auto size = j.journalSize();
+		AutoClosable<FileInputStream> stream(j.inputStream(0));
+
+		// The journal has grown, so the next stream maps the journal again
+		commitEvents(&j, 1000);
+		AutoClosable<FileInputStream>(j.inputStream(0));
+
+		const auto events = readJournalBytes(stream.get(), size);
+		assertEquals(string("event0\nline0\nevent1"), events.substr(0, 19));
+		assertTrue(events.find("event9\nline9") != string::npos);
+		assertTrue(events.find("event10") == string::npos);
+	}
+}
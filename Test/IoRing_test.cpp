@@ -0,0 +1,84 @@
+#include "../Shared/everstore.h"
+#include "../Shared/File/IoRing.h"
+#include "test/Test.h"
+#include <sys/uio.h>
+
+TEST_SUITE(IoRing)
+{
+	UNIT_TEST(disabledRingIsNotAvailable) {
+		IoRing ring(0);
+		assertFalse(ring.available());
+		assertEquals(0U, ring.capacity());
+		assertFalse(ring.sync(0, 0, false));
+	}
+
+	UNIT_TEST(linkedWritesAreCompletedInOrder) {
+		IoRing ring(4);
+
+		// The kernel might not support io_uring
+		if (!ring.available()) {
+			return;
+		}
+		assertTrue(ring.capacity() >= 4U);
+
+		const string path = FileUtils::getTempFile();
+		FILE* file = fopen(path.c_str(), "w+b");
+		const int fd = fileno(file);
+
+		char first[] = "hello world";
+		char second[] = "W";
+		iovec parts[2];
+		parts[0].iov_base = first;
+		parts[0].iov_len = 5;
+		parts[1].iov_base = first + 5;
+		parts[1].iov_len = 6;
+		iovec patch;
+		patch.iov_base = second;
+		patch.iov_len = 1;
+
+		assertTrue(ring.writev(fd, parts, 2, 0, 1u, true));
+		assertTrue(ring.sync(fd, 2u, true));
+		assertTrue(ring.writev(fd, &patch, 1, 6, 3u, false));
+		assertEquals(ring.capacity() - 3, ring.space());
+
+		vector<IoRing::Completion> completions;
+		assertTrue(ring.submitAndWait(&completions));
+		assertEquals(3U, (uint32_t) completions.size());
+		assertEquals(ring.capacity(), ring.space());
+		for (auto& completion : completions) {
+			if (completion.userData == 1u) {
+				assertEquals(11, completion.result);
+			} else if (completion.userData == 2u) {
+				assertEquals(0, completion.result);
+			} else {
+				assertEquals(1, completion.result);
+			}
+		}
+
+		char result[12] = {0};
+		assertTrue(FileUtils::readAt(file, 0, result, 11));
+		assertEquals(string("hello World"), string(result));
+		fclose(file);
+	}
+
+	UNIT_TEST(fullRingRejectsOperations) {
+		IoRing ring(1);
+		if (!ring.available()) {
+			return;
+		}
+
+		const string path = FileUtils::getTempFile();
+		FILE* file = fopen(path.c_str(), "w+b");
+		uint32_t added = 0;
+		while (ring.sync(fileno(file), added, false)) {
+			added++;
+		}
+		assertEquals(ring.capacity(), added);
+		assertEquals(0U, ring.space());
+
+		vector<IoRing::Completion> completions;
+		assertTrue(ring.submitAndWait(&completions));
+		assertEquals(added, (uint32_t) completions.size());
+		fclose(file);
+	}
+}
@@ -0,0 +1,213 @@
+#include "../Shared/everstore.h"
+#include "../Shared/Crc32c.hpp"
+#include "../Shared/Database/JournalConverter.hpp"
+#include "test/Test.h"
+
+TEST_SUITE(JournalFormat)
+{
+	static const string logSuffix(".log");
+
+	JournalOptions v2Options() {
+		JournalOptions options;
+		options.format = JournalFormat::V2;
+		return options;
+	}
+
+	void commit(Journal* journal, const string& data) {
+		ByteBuffer bytes(data.length());
+		memcpy(bytes.allocate(data.length()), data.c_str(), data.length());
+		bytes.reset();
+		journal->tryCommit(journal->openTransaction(), TypeSet{1u}, MutableString(data.length(), &bytes));
+	}
+
+	string readEvents(Journal* journal, bool includeTimestamp) {
+		ByteBuffer memory(64);
+		uint32_t bytes = 0;
+		AutoClosable<FileInputStream>(journal->inputStream(0))->readRecords(&memory, 4096, includeTimestamp, &bytes);
+		return string(memory.ptr(), bytes);
+	}
+
+	// Remove the timestamp in front of each line
+	string withoutTimestamps(const string& events) {
+		string result;
+		for (size_t line = 0; line < events.length();) {
+			auto nl = events.find(FileUtils::NL, line);
+			nl = nl == string::npos ? events.length() : nl + 1;
+			result.append(events, line + Timestamp::BytesLength + 1, nl - line - Timestamp::BytesLength - 1);
+			line = nl;
+		}
+		return result;
+	}
+
+	UNIT_TEST(crc32cKnownValue) {
+		const string data("123456789");
+		assertEquals(0xE3069283U, Crc32c::compute(data.c_str(), data.length()));
+	}
+
+	UNIT_TEST(newJournalStartsWithFileHeader) {
+		const Path journalPath(FileUtils::getTempFile() + logSuffix);
+		{
+			Journal j(journalPath, v2Options());
+			commit(&j, "data1");
+			assertEquals((uint32_t) JournalFormat::V2, (uint32_t) j.format());
+			assertEquals((uint32_t) (sizeof(JournalFormat::FileHeader) + sizeof(JournalFormat::RecordHeader) + 5),
+			             j.journalSize());
+		}
+
+		// The format of an existing journal is used regardless of the options
+		Journal j(journalPath);
+		assertEquals((uint32_t) JournalFormat::V2, (uint32_t) j.format());
+	}
+
+	UNIT_TEST(recordsAreReadAsVersion1Journal) {
+		Journal v1(Path(FileUtils::getTempFile() + logSuffix));
+		Journal v2(Path(FileUtils::getTempFile() + logSuffix), v2Options());
+		commit(&v1, "data1\ndata2");
+		commit(&v2, "data1\ndata2");
+		commit(&v2, "data3");
+
+		assertEquals(string("data1\ndata2\ndata3"), readEvents(&v2, false));
+
+		// The commits to the two journals might be written in different milliseconds
+		const string withTimestamp = readEvents(&v2, true);
+		ByteBuffer expected(64);
+		AutoClosable<FileInputStream>(v1.inputStream(0))->readBytes(&expected, v1.journalSize() - 1);
+		assertEquals(withoutTimestamps(string(expected.ptr(), expected.offset())),
+		             withoutTimestamps(withTimestamp.substr(0, expected.offset())));
+		assertEquals(string("data1\ndata2\ndata3"), withoutTimestamps(withTimestamp));
+	}
+
+	UNIT_TEST(tornRecordIsRemoved) {
+		const Path journalPath(FileUtils::getTempFile() + logSuffix);
+		uint32_t sizeBeforeCommit;
+		{
+			Journal j(journalPath, v2Options());
+			commit(&j, "data1");
+			sizeBeforeCommit = j.journalSize();
+			commit(&j, "data2");
+		}
+		FileUtils::truncate(journalPath.value, FileUtils::getFileSize(journalPath.value) - 1);
+
+		Journal j(journalPath);
+		assertTrue(j.performConsistencyCheck());
+		assertEquals(sizeBeforeCommit, j.journalSize());
+		assertEquals(sizeBeforeCommit, FileUtils::getFileSize(journalPath.value));
+		assertEquals(string("data1"), readEvents(&j, false));
+	}
+
+	UNIT_TEST(tornFileHeaderIsRemoved) {
+		const Path journalPath(FileUtils::getTempFile() + logSuffix);
+		const char torn[] = {'E', 'S', '\0'};
+		FILE* file = fopen(journalPath.value.c_str(), "wb");
+		fwrite(torn, sizeof(torn), 1, file);
+		fclose(file);
+
+		Journal j(journalPath, v2Options());
+		assertEquals((uint32_t) JournalFormat::V2, (uint32_t) j.format());
+		assertTrue(j.performConsistencyCheck());
+		assertEquals(0U, j.journalSize());
+		assertEquals(0U, FileUtils::getFileSize(journalPath.value));
+
+		commit(&j, "data1");
+		assertEquals(string("data1"), readEvents(&j, false));
+	}
+
+	UNIT_TEST(tornRecordIsRemovedFromLargeJournal) {
+		const Path journalPath(FileUtils::getTempFile() + logSuffix);
+		uint32_t sizeBeforeCommit;
+		{
+			// Small records that span many blocks, and a record that's larger than a block
+			Journal j(journalPath, v2Options());
+			for (uint32_t i = 0; i < 3000; ++i) {
+				commit(&j, "event" + std::to_string(i));
+			}
+			commit(&j, string(100 * 1024, 'x'));
+			commit(&j, "data1");
+			sizeBeforeCommit = j.journalSize();
+			commit(&j, "data2");
+		}
+		FileUtils::truncate(journalPath.value, FileUtils::getFileSize(journalPath.value) - 1);
+
+		Journal j(journalPath);
+		assertTrue(j.performConsistencyCheck());
+		assertEquals(sizeBeforeCommit, j.journalSize());
+		ByteBuffer memory(64);
+		uint32_t bytes = 0;
+		AutoClosable<FileInputStream>(j.inputStream(0))->readRecords(&memory, j.journalSize(), false, &bytes);
+		assertEquals(string("x\ndata1"), string(memory.ptr() + bytes - 7, 7));
+	}
+
+	UNIT_TEST(recordWithCorruptLengthIsRemoved) {
+		const Path journalPath(FileUtils::getTempFile() + logSuffix);
+		uint32_t sizeBeforeCommit;
+		{
+			Journal j(journalPath, v2Options());
+			commit(&j, "data1");
+			sizeBeforeCommit = j.journalSize();
+			commit(&j, "data2");
+		}
+
+		// A length that would move the offset back to where it started
+		const uint32_t length = 0xFFFFFFDCU;
+		FILE* file = fopen(journalPath.value.c_str(), "r+b");
+		fseek(file, sizeBeforeCommit + offsetof(JournalFormat::RecordHeader, length), SEEK_SET);
+		fwrite(&length, sizeof(length), 1, file);
+		fclose(file);
+
+		Journal j(journalPath);
+		assertTrue(j.performConsistencyCheck());
+		assertEquals(sizeBeforeCommit, j.journalSize());
+		assertEquals(string("data1"), readEvents(&j, false));
+	}
+
+	UNIT_TEST(convertVersion1Journal) {
+		const Path journalPath(FileUtils::getTempFile() + logSuffix);
+		string expected;
+		{
+			Journal j(journalPath);
+			commit(&j, "data1\ndata2");
+			commit(&j, "data3\n");
+			commit(&j, "data4");
+			ByteBuffer memory(64);
+			AutoClosable<FileInputStream>(j.inputStream(0))->readBytes(&memory, j.journalSize() - 1);
+			expected.assign(memory.ptr(), memory.offset());
+		}
+
+		assertEquals((ESErrorCode) ESERR_NO_ERROR, JournalConverter::convert(journalPath));
+		assertFalse(FileUtils::fileExists(journalPath.value + JournalConverter::Suffix));
+
+		Journal j(journalPath);
+		assertEquals((uint32_t) JournalFormat::V2, (uint32_t) j.format());
+		assertEquals(expected, readEvents(&j, true));
+		assertTrue(j.performConsistencyCheck());
+	}
+
+	UNIT_TEST(convertLargeVersion1JournalAndReadItInParts) {
+		const Path journalPath(FileUtils::getTempFile() + logSuffix);
+		string expected;
+		{
+			Journal j(journalPath);
+			for (uint32_t i = 0; i < 3000; ++i) {
+				commit(&j, "event" + std::to_string(i) + "\nline" + std::to_string(i));
+			}
+			assertTrue(j.journalSize() > 128 * 1024);
+			ByteBuffer memory(64);
+			AutoClosable<FileInputStream>(j.inputStream(0))->readBytes(&memory, j.journalSize() - 1);
+			expected.assign(memory.ptr(), memory.offset());
+		}
+
+		assertEquals((ESErrorCode) ESERR_NO_ERROR, JournalConverter::convert(journalPath));
+
+		// The parts end in the middle of timestamps and lines
+		Journal j(journalPath);
+		AutoClosable<FileInputStream> stream(j.inputStream(0));
+		string events;
+		uint32_t bytes = 0;
+		do {
+			ByteBuffer memory(64);
+			assertEquals((ESErrorCode) ESERR_NO_ERROR, stream->readRecords(&memory, 100, true, &bytes));
+			events.append(memory.ptr(), bytes);
+		} while (bytes > 0);
+		assertEquals(expected, events);
+	}
+}
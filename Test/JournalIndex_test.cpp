@@ -0,0 +1,173 @@
+#include "../Shared/everstore.h"
+#include "../Shared/Database/JournalConverter.hpp"
+#include "test/Test.h"
+
+TEST_SUITE(JournalIndex)
+{
+	static const string logSuffix(".log");
+
+	// Commit "count" events, one commit for each "eventsPerCommit" events, named "event<number>"
+	void commitEvents(Journal* journal, uint32_t count, uint32_t eventsPerCommit) {
+		for (uint32_t i = 0; i < count; i += eventsPerCommit) {
+			string data;
+			for (uint32_t j = i; j < i + eventsPerCommit && j < count; ++j) {
+				if (j > i) data += "\n";
+				data += "event" + std::to_string(j);
+			}
+			ByteBuffer bytes(data.length());
+			memcpy(bytes.allocate(data.length()), data.c_str(), data.length());
+			bytes.reset();
+			journal->tryCommit(journal->openTransaction(), TypeSet{1u}, MutableString(data.length(), &bytes));
+		}
+	}
+
+	string eventAt(Journal* journal, uint32_t eventNumber) {
+		std::unique_ptr<JournalCursor> cursor(journal->cursor(eventNumber));
+		if (!cursor->next()) {
+			return string();
+		}
+		return string(cursor->event(), cursor->eventLength());
+	}
+
+	UNIT_TEST(findEventsInVersion1Journal) {
+		Journal j(Path(FileUtils::getTempFile() + logSuffix));
+		commitEvents(&j, 1000, 3);
+		assertEquals(1000U, j.eventCount());
+		assertEquals(string("event0"), eventAt(&j, 0));
+		assertEquals(string("event1"), eventAt(&j, 1));
+		assertEquals(string("event500"), eventAt(&j, 500));
+		assertEquals(string("event999"), eventAt(&j, 999));
+		assertEquals(string(), eventAt(&j, 1000));
+	}
+
+	UNIT_TEST(findEventsInVersion2Journal) {
+		JournalOptions options;
+		options.format = JournalFormat::V2;
+		Journal j(Path(FileUtils::getTempFile() + logSuffix), options);
+		commitEvents(&j, 1000, 3);
+		assertEquals(1000U, j.eventCount());
+		assertEquals(string("event0"), eventAt(&j, 0));
+		assertEquals(string("event1"), eventAt(&j, 1));
+		assertEquals(string("event500"), eventAt(&j, 500));
+		assertEquals(string("event999"), eventAt(&j, 999));
+		assertEquals(string(), eventAt(&j, 1000));
+	}
+
+	UNIT_TEST(indexIsRebuiltIfMissing) {
+		const Path journalPath(FileUtils::getTempFile() + logSuffix);
+		{
+			Journal j(journalPath);
+			commitEvents(&j, 1000, 7);
+		}
+		assertTrue(FileUtils::getFileSize((journalPath + JournalIndex::Suffix).value) > 0);
+		FileUtils::remove((journalPath + JournalIndex::Suffix).value);
+
+		Journal j(journalPath);
+		assertEquals((ESErrorCode) ESERR_NO_ERROR, j.loadIndex());
+		assertTrue(FileUtils::getFileSize((journalPath + JournalIndex::Suffix).value) > 0);
+		assertEquals(1000U, j.eventCount());
+		assertEquals(string("event0"), eventAt(&j, 0));
+		assertEquals(string("event1"), eventAt(&j, 1));
+		assertEquals(string("event500"), eventAt(&j, 500));
+		assertEquals(string("event999"), eventAt(&j, 999));
+		assertEquals(string(), eventAt(&j, 1000));
+	}
+
+	UNIT_TEST(entriesAfterTheJournalAreRemoved) {
+		const Path journalPath(FileUtils::getTempFile() + logSuffix);
+		const Path indexPath(journalPath + JournalIndex::Suffix);
+		{
+			Journal j(journalPath);
+			commitEvents(&j, 1000, 1);
+		}
+		const auto indexSize = FileUtils::getFileSize(indexPath.value);
+
+		JournalIndex index;
+		assertTrue(index.open(indexPath, JournalIndex::BytesBetweenEntries));
+		assertEquals(0U, index.last()->byteOffset);
+		assertTrue(FileUtils::getFileSize(indexPath.value) < indexSize);
+
+		const JournalIndex::Entry first = {0u, 0u};
+		assertEquals(0U, index.find(100, first).eventNumber);
+	}
+
+	UNIT_TEST(indexInAnOlderLayoutIsRebuilt) {
+		const Path journalPath(FileUtils::getTempFile() + logSuffix);
+		const Path indexPath(journalPath + JournalIndex::Suffix);
+		{
+			Journal j(journalPath);
+			commitEvents(&j, 1000, 7);
+		}
+
+		// Entries with only an event number and a byte offset, and no file header
+		FILE* file = fopen(indexPath.value.c_str(), "wb");
+		for (uint32_t i = 0; i < 16; ++i) {
+			const uint32_t entry[2] = {i * 100u, i * JournalIndex::BytesBetweenEntries};
+			fwrite(entry, sizeof(entry), 1, file);
+		}
+		fclose(file);
+
+		JournalIndex index;
+		assertTrue(index.open(indexPath, 1000000));
+		assertNull((void*) index.last());
+		assertEquals((uint32_t) sizeof(JournalIndex::FileHeader), (uint32_t) FileUtils::getFileSize(indexPath.value));
+		index.close();
+
+		Journal j(journalPath);
+		assertEquals((ESErrorCode) ESERR_NO_ERROR, j.loadIndex());
+		assertEquals(1000U, j.eventCount());
+		assertEquals(string("event500"), eventAt(&j, 500));
+		assertEquals(string("event999"), eventAt(&j, 999));
+
+		assertTrue(index.open(indexPath, 1000000));
+		assertNotNull((void*) index.last());
+	}
+
+	// One event per second, starting at 2019-01-01T00:00:00.000
+	void writeTimedJournal(const Path& journalPath, uint32_t count) {
+		string data;
+		for (uint32_t i = 0; i < count; ++i) {
+			char line[64];
+			sprintf(line, "2019-01-01T00:%02u:%02u.000 event%u\n", i / 60, i % 60, i);
+			data += line;
+		}
+		data[data.length() - 1] = Journal::JournalEof;
+		FILE* file = fopen(journalPath.value.c_str(), "wb");
+		fwrite(data.c_str(), data.length(), 1, file);
+		fclose(file);
+	}
+
+	string eventAt(Journal* journal, const string& timestamp) {
+		std::unique_ptr<JournalCursor> cursor(journal->cursor(timestamp.c_str(), timestamp.length()));
+		if (!cursor->next()) {
+			return string();
+		}
+		return string(cursor->event(), cursor->eventLength());
+	}
+
+	UNIT_TEST(findEventsByTimestamp) {
+		const Path journalPath(FileUtils::getTempFile() + logSuffix);
+		writeTimedJournal(journalPath, 1000);
+
+		Journal j(journalPath);
+		assertEquals(string("event0"), eventAt(&j, ""));
+		assertEquals(string("event600"), eventAt(&j, "2019-01-01T00:10"));
+		assertEquals(string("event601"), eventAt(&j, "2019-01-01T00:10:00.001"));
+		assertEquals(string("event999"), eventAt(&j, "2019-01-01T00:16:39.000"));
+		assertEquals(string(), eventAt(&j, "2019-01-01T01"));
+
+		std::unique_ptr<JournalCursor> cursor(j.cursor("2019-01-01T00:10", 16));
+		assertEquals(600U, cursor->nextEventNumber());
+	}
+
+	UNIT_TEST(findEventsByTimestampInVersion2Journal) {
+		const Path journalPath(FileUtils::getTempFile() + logSuffix);
+		writeTimedJournal(journalPath, 1000);
+		assertEquals((ESErrorCode) ESERR_NO_ERROR, JournalConverter::convert(journalPath));
+
+		Journal j(journalPath);
+		assertEquals(string("event600"), eventAt(&j, "2019-01-01T00:10"));
+		assertEquals(string("event601"), eventAt(&j, "2019-01-01T00:10:00.001"));
+		assertEquals(string(), eventAt(&j, "2019-01-01T01"));
+	}
+}
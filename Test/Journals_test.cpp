@@ -0,0 +1,46 @@
+#include "../Worker/Journals.h"
+#include "test/Test.h"
+
+TEST_SUITE(Journals)
+{
+	static const string logSuffix(".log");
+
+	UNIT_TEST(leastRecentlyUsedJournalIsClosedWhenTooManyAreOpen) {
+		Journals journals(60u, 2u, JournalOptions());
+		const Path first(FileUtils::getTempFile() + logSuffix);
+		const Path second(FileUtils::getTempFile() + logSuffix);
+		const Path third(FileUtils::getTempFile() + logSuffix);
+		journals.getOrCreate(first);
+		journals.getOrCreate(second);
+
+		auto const journal = journals.getOrCreate(third);
+		assertEquals(2U, journals.size());
+		assertEquals(1U, (uint32_t) journals.evictions());
+		assertTrue(journals.getOrNull(first) == nullptr);
+		assertTrue(journals.getOrNull(third) == journal);
+	}
+
+	UNIT_TEST(newJournalIsKeptWhenAllOtherJournalsAreInUse) {
+		Journals journals(60u, 2u, JournalOptions());
+		const Path first(FileUtils::getTempFile() + logSuffix);
+		const Path second(FileUtils::getTempFile() + logSuffix);
+		const Path third(FileUtils::getTempFile() + logSuffix);
+		const auto firstTransaction = journals.getOrCreate(first)->openTransaction();
+		const auto secondTransaction = journals.getOrCreate(second)->openTransaction();
+
+		// The new journal is opened even if it means that too many journals are open
+		auto const journal = journals.getOrCreate(third);
+		assertEquals(3U, journals.size());
+		assertEquals(0U, (uint32_t) journals.evictions());
+		assertTrue(journals.getOrNull(third) == journal);
+		const auto transaction = journal->openTransaction();
+		assertTrue(journal->transaction(transaction) != nullptr);
+
+		// The journals are closed when they are no longer in use
+		journals.getOrNull(first)->rollback(firstTransaction);
+		journals.getOrNull(second)->rollback(secondTransaction);
+		journals.getOrCreate(Path(FileUtils::getTempFile() + logSuffix));
+		assertEquals(2U, journals.size());
+		assertTrue(journals.getOrNull(third) == journal);
+	}
+}
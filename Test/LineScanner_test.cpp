@@ -0,0 +1,74 @@
+#include "../Shared/everstore.h"
+#include "../Shared/File/LineScanner.h"
+#include "test/Test.h"
+
+TEST_SUITE(LineScanner)
+{
+	typedef const char* (* FindNewLine)(const char*, const char*);
+
+	static const uint32_t TIMESTAMP_AND_SPACE_LEN = Timestamp::BytesLength + 1;
+
+	// Remove the timestamp in front of each line, in the same way as the journal is read, and return the new size
+	uint32_t stripTimestamps(char* bytes, uint32_t size, FindNewLine findNewLine) {
+		const char* current = bytes;
+		const char* const end = bytes + size;
+		char* moveDataTo = bytes;
+		while (current < end) {
+			const char* nl = findNewLine(current, end);
+			const char* lineEnd = nl == end ? end : nl + 1;
+			memmove(moveDataTo, current, lineEnd - current);
+			moveDataTo += lineEnd - current;
+			current = lineEnd + (nl == end ? 0 : TIMESTAMP_AND_SPACE_LEN);
+		}
+		return moveDataTo - bytes;
+	}
+
+	string journalLines(uint32_t count) {
+		string result;
+		for (uint32_t i = 0; i < count; ++i) {
+			if (i > 0) result += "2019-10-01T12:00:00.000 ";
+			result += "EventType {\"value\": " + std::to_string(i) + ", \"name\": \"some event name\"}\n";
+		}
+		return result;
+	}
+
+	UNIT_TEST(findNewLineAtEveryPosition) {
+		char bytes[100];
+		for (uint32_t length = 0; length <= sizeof(bytes); ++length) {
+			for (uint32_t position = 0; position <= length; ++position) {
+				memset(bytes, 'a', sizeof(bytes));
+				if (position < length) bytes[position] = '\n';
+				const auto expected = LineScanner::findNewLineScalar(bytes, bytes + length);
+				assertTrue(LineScanner::findNewLine(bytes, bytes + length) == expected);
+				assertEquals(position, (uint32_t) (expected - bytes));
+			}
+		}
+	}
+
+	UNIT_TEST(findNewLineIgnoresBytesAfterEnd) {
+		const char bytes[] = "0123456789012345678901234567890123456789\n";
+		assertTrue(LineScanner::findNewLine(bytes, bytes + 40) == bytes + 40);
+		assertTrue(LineScanner::findNewLine(bytes + 3, bytes + 41) == bytes + 40);
+	}
+
+	UNIT_TEST(benchmarkStripTimestamps) {
+		const string lines = journalLines(50000);
+		string scalar(lines);
+		string vectorized(lines);
+
+		const auto scalarStart = chrono::high_resolution_clock::now();
+		const auto scalarSize = stripTimestamps(&scalar[0], scalar.length(), LineScanner::findNewLineScalar);
+		const auto scalarTime = chrono::high_resolution_clock::now() - scalarStart;
+
+		const auto vectorizedStart = chrono::high_resolution_clock::now();
+		const auto vectorizedSize = stripTimestamps(&vectorized[0], vectorized.length(), LineScanner::findNewLine);
+		const auto vectorizedTime = chrono::high_resolution_clock::now() - vectorizedStart;
+
+		assertEquals(scalarSize, vectorizedSize);
+		assertTrue(scalar.substr(0, scalarSize) == vectorized.substr(0, vectorizedSize));
+
+		Log::Write(Log::Info, "Stripped %d bytes: scalar %d us, %s %d us", (int) lines.length(),
+		           (int) chrono::duration_cast<chrono::microseconds>(scalarTime).count(), LineScanner::instructions(),
+		           (int) chrono::duration_cast<chrono::microseconds>(vectorizedTime).count());
+	}
+}
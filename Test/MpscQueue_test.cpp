@@ -0,0 +1,83 @@
+#include "../Shared/everstore.h"
+#include "../Shared/MpscQueue.h"
+#include "test/Test.h"
+
+struct QueueItem : MpscNode
+{
+	uint32_t producer;
+	uint32_t value;
+};
+
+TEST_SUITE(MpscQueue)
+{
+	UNIT_TEST(emptyQueue) {
+		MpscQueue<QueueItem> queue;
+		assertTrue(queue.empty());
+		assertNull(queue.pop());
+	}
+
+	UNIT_TEST(itemsArePoppedInTheOrderTheyArePushed) {
+		MpscQueue<QueueItem> queue;
+		QueueItem items[3];
+		for (uint32_t i = 0; i < 3; ++i) {
+			items[i].value = i;
+			queue.push(&items[i]);
+		}
+		assertFalse(queue.empty());
+
+		for (uint32_t i = 0; i < 3; ++i) {
+			QueueItem* item = queue.pop();
+			assertNotNull(item);
+			assertEquals(i, item->value);
+		}
+		assertTrue(queue.empty());
+		assertNull(queue.pop());
+
+		// The queue can be used again when it's empty
+		queue.push(&items[1]);
+		assertTrue(queue.pop() == &items[1]);
+		assertTrue(queue.empty());
+	}
+
+	UNIT_TEST(manyProducers) {
+		static const uint32_t Producers = 4;
+		static const uint32_t Count = 10000;
+		MpscQueue<QueueItem> queue;
+		vector<QueueItem> items(Producers * Count);
+
+		vector<thread> threads;
+		for (uint32_t p = 0; p < Producers; ++p) {
+			threads.push_back(thread([&queue, &items, p]() {
+				for (uint32_t i = 0; i < Count; ++i) {
+					QueueItem* item = &items[p * Count + i];
+					item->producer = p;
+					item->value = i;
+					queue.push(item);
+				}
+			}));
+		}
+
+		// The items from each producer must be popped in the order they were pushed
+		vector<uint32_t> next(Producers, 0);
+		uint32_t popped = 0;
+		bool ordered = true;
+		while (popped < Producers * Count) {
+			QueueItem* item = queue.pop();
+			if (item == nullptr) {
+				this_thread::yield();
+				continue;
+			}
+			if (item->value != next[item->producer]) {
+				ordered = false;
+			}
+			next[item->producer]++;
+			popped++;
+		}
+		for (auto& t : threads) {
+			t.join();
+		}
+
+		assertTrue(ordered);
+		assertTrue(queue.empty());
+	}
+}
@@ -0,0 +1,101 @@
+#include "../Worker/MultipartCommits.h"
+#include "test/Test.h"
+
+namespace
+{
+	const AttachedConnection* const connection = (const AttachedConnection*) 0x10;
+	const AttachedConnection* const otherConnection = (const AttachedConnection*) 0x20;
+	const char bytes[] = "0123456789";
+}
+
+TEST_SUITE(MultipartCommits)
+{
+	UNIT_TEST(commitThatIsTooLargeKeepsItsError) {
+		MultipartCommits commits(100u);
+		auto const first = commits.start(connection, 1u, 60u);
+		assertEquals((ESErrorCode) ESERR_NO_ERROR, first->error);
+
+		auto const tooLarge = commits.start(connection, 2u, 60u);
+		assertEquals((ESErrorCode) ESERR_JOURNAL_COMMIT_TOO_LARGE, tooLarge->error);
+		assertNull(tooLarge->events);
+
+		// The types of the commit are read after it's started
+		tooLarge->fail(ESERR_NO_ERROR);
+		assertEquals((ESErrorCode) ESERR_JOURNAL_COMMIT_TOO_LARGE, tooLarge->error);
+		tooLarge->append(bytes, 10u);
+		assertTrue(tooLarge->complete());
+
+		// The bytes of the first commit are still reserved
+		commits.remove(connection, 2u);
+		auto const third = commits.start(connection, 3u, 41u);
+		assertEquals((ESErrorCode) ESERR_JOURNAL_COMMIT_TOO_LARGE, third->error);
+	}
+
+	UNIT_TEST(commitsFromOneConnectionShareTheBudget) {
+		MultipartCommits commits(100u);
+		assertEquals((ESErrorCode) ESERR_NO_ERROR, commits.start(connection, 1u, 60u)->error);
+		assertEquals((ESErrorCode) ESERR_NO_ERROR, commits.start(connection, 2u, 40u)->error);
+		assertEquals((ESErrorCode) ESERR_JOURNAL_COMMIT_TOO_LARGE, commits.start(connection, 3u, 1u)->error);
+
+		// Other connections have their own budget
+		assertEquals((ESErrorCode) ESERR_NO_ERROR, commits.start(otherConnection, 1u, 100u)->error);
+
+		// The bytes are released when a commit is done
+		commits.remove(connection, 1u);
+		commits.remove(connection, 3u);
+		assertEquals((ESErrorCode) ESERR_NO_ERROR, commits.start(connection, 4u, 60u)->error);
+	}
+
+	UNIT_TEST(commitWithMissingOrExtraEventsIsIncomplete) {
+		MultipartCommits commits(100u);
+		auto const missing = commits.start(connection, 1u, 20u);
+		missing->append(bytes, 10u);
+		assertFalse(missing->complete());
+		assertEquals((ESErrorCode) ESERR_JOURNAL_COMMIT_INCOMPLETE, missing->result());
+
+		auto const extra = commits.start(connection, 2u, 15u);
+		extra->append(bytes, 10u);
+		extra->append(bytes, 10u);
+		assertTrue(extra->complete());
+		assertEquals((ESErrorCode) ESERR_JOURNAL_COMMIT_INCOMPLETE, extra->result());
+
+		auto const done = commits.start(connection, 3u, 20u);
+		done->append(bytes, 10u);
+		done->append(bytes, 10u);
+		assertTrue(done->complete());
+		assertEquals((ESErrorCode) ESERR_NO_ERROR, done->result());
+	}
+
+	UNIT_TEST(interleavedCommitsAreFoundByTheirRequest) {
+		MultipartCommits commits(100u);
+		commits.start(connection, 1u, 4u);
+		commits.start(connection, 2u, 4u);
+		commits.start(otherConnection, 1u, 4u);
+
+		commits.get(connection, 1u)->append("ab", 2u);
+		commits.get(connection, 2u)->append("AB", 2u);
+		commits.get(otherConnection, 1u)->append("xy", 2u);
+		commits.get(connection, 1u)->append("cd", 2u);
+		commits.get(connection, 2u)->append("CD", 2u);
+
+		assertEquals(string("abcd"), string(commits.get(connection, 1u)->events->ptr(), 4u));
+		assertEquals(string("ABCD"), string(commits.get(connection, 2u)->events->ptr(), 4u));
+		assertEquals(2U, commits.get(otherConnection, 1u)->eventsReceived());
+		assertNull(commits.get(connection, 3u));
+	}
+
+	UNIT_TEST(commitsAreRemovedWhenTheConnectionIsClosed) {
+		MultipartCommits commits(100u);
+		commits.start(connection, 1u, 50u);
+		commits.start(connection, 2u, 50u);
+		commits.start(otherConnection, 1u, 50u);
+
+		commits.remove(connection);
+		assertNull(commits.get(connection, 1u));
+		assertNull(commits.get(connection, 2u));
+		assertNotNull(commits.get(otherConnection, 1u));
+
+		// A new connection at the same address starts with the whole budget
+		assertEquals((ESErrorCode) ESERR_NO_ERROR, commits.start(connection, 1u, 100u)->error);
+	}
+}
@@ -0,0 +1,135 @@
+#include "../Shared/everstore.h"
+#include "test/Test.h"
+
+TEST_SUITE(RecoveryLog)
+{
+	static const string logSuffix(".log");
+
+	uint32_t commit(const Path& journalPath, RecoveryLog* log, const string& data) {
+		ByteBuffer bytes(data.length());
+		memcpy(bytes.allocate(data.length()), data.c_str(), data.length());
+		bytes.reset();
+
+		JournalOptions options;
+		options.recoveryLog = log;
+		Journal j(journalPath, options);
+		j.tryCommit(j.openTransaction(), TypeSet{1u}, MutableString(data.length(), &bytes));
+		return j.journalSize();
+	}
+
+	void append(const Path& journalPath, const string& data) {
+		FILE* file = fopen(journalPath.value.c_str(), "ab");
+		fwrite(data.c_str(), data.length(), 1, file);
+		fclose(file);
+	}
+
+	string readJournal(const Path& journalPath) {
+		const auto size = FileUtils::getFileSize(journalPath.value);
+		string result(size, '\0');
+		FILE* file = fopen(journalPath.value.c_str(), "rb");
+		fread(&result[0], size, 1, file);
+		fclose(file);
+		return result;
+	}
+
+	UNIT_TEST(replayWithoutLog) {
+		assertTrue(RecoveryLog::replay(Path(FileUtils::getTempFile() + RecoveryLog::Suffix), Path()));
+	}
+
+	UNIT_TEST(replayRemovesUnfinishedCommit) {
+		const Path journalPath(FileUtils::getTempFile() + logSuffix);
+		const Path logPath(FileUtils::getTempFile() + RecoveryLog::Suffix);
+		const auto sizeBeforeCommit = commit(journalPath, nullptr, "data1");
+
+		RecoveryLog log;
+		assertTrue(log.open(logPath));
+		assertEquals((ESErrorCode) ESERR_NO_ERROR, log.begin(journalPath, sizeBeforeCommit, Durability::getDefault()));
+		append(journalPath, "2019-01-01T00:00:00.000 unfinished");
+
+		assertTrue(RecoveryLog::replay(logPath, Path()));
+		assertFalse(FileUtils::fileExists(logPath.value));
+
+		const auto journal = readJournal(journalPath);
+		assertEquals(sizeBeforeCommit, (uint32_t) journal.length());
+		assertEquals(Journal::JournalEof, journal[sizeBeforeCommit - 1]);
+	}
+
+	UNIT_TEST(recordWithCorruptPathLengthIsIgnored) {
+		const Path journalPath(FileUtils::getTempFile() + logSuffix);
+		const Path logPath(FileUtils::getTempFile() + RecoveryLog::Suffix);
+		const auto sizeBeforeCommit = commit(journalPath, nullptr, "data1");
+
+		RecoveryLog log;
+		assertTrue(log.open(logPath));
+		assertEquals((ESErrorCode) ESERR_NO_ERROR, log.begin(journalPath, sizeBeforeCommit, Durability::getDefault()));
+		append(journalPath, "2019-01-01T00:00:00.000 unfinished");
+
+		// A Begin record header with a path length that's far too large
+		const uint32_t record[] = {1u, 0u, 0xFFFFFFF0U};
+		append(logPath, string((const char*) record, sizeof(record)));
+
+		assertTrue(RecoveryLog::replay(logPath, Path()));
+		assertEquals(sizeBeforeCommit, FileUtils::getFileSize(journalPath.value));
+	}
+
+	UNIT_TEST(replayReplacesPreviousEofForFinishedCommit) {
+		const Path journalPath(FileUtils::getTempFile() + logSuffix);
+		const Path logPath(FileUtils::getTempFile() + RecoveryLog::Suffix);
+		const auto sizeBeforeCommit = commit(journalPath, nullptr, "data1");
+
+		RecoveryLog log;
+		assertTrue(log.open(logPath));
+		assertEquals((ESErrorCode) ESERR_NO_ERROR, log.begin(journalPath, sizeBeforeCommit, Durability::getDefault()));
+		const string finished = string("2019-01-01T00:00:00.000 data2") + Journal::JournalEof;
+		append(journalPath, finished);
+
+		assertTrue(RecoveryLog::replay(logPath, Path()));
+
+		const auto journal = readJournal(journalPath);
+		assertEquals(sizeBeforeCommit + (uint32_t) finished.length(), (uint32_t) journal.length());
+		assertEquals('\n', journal[sizeBeforeCommit - 1]);
+		assertEquals(Journal::JournalEof, journal[journal.length() - 1]);
+	}
+
+	UNIT_TEST(finishedWritesAreNotReplayed) {
+		const Path journalPath(FileUtils::getTempFile() + logSuffix);
+		const Path logPath(FileUtils::getTempFile() + RecoveryLog::Suffix);
+
+		RecoveryLog log;
+		assertTrue(log.open(logPath));
+		commit(journalPath, &log, "data1");
+		const auto size = commit(journalPath, &log, "data2");
+		assertTrue(FileUtils::getFileSize(logPath.value) > 0);
+
+		// Data appended after the last finished write is not touched
+		append(journalPath, "unrelated");
+		assertTrue(RecoveryLog::replay(logPath, Path()));
+		assertEquals(size + 9, FileUtils::getFileSize(journalPath.value));
+	}
+
+	UNIT_TEST(logIsNotEmptiedWhileOtherWritesAreUnfinished) {
+		const Path journalPath(FileUtils::getTempFile() + logSuffix);
+		const Path logPath(FileUtils::getTempFile() + RecoveryLog::Suffix);
+		const auto sizeBeforeCommit = commit(journalPath, nullptr, "data1");
+
+		// Two journals are written at the same time, as when a worker flushes many journals
+		RecoveryLog log;
+		assertTrue(log.open(logPath));
+		assertEquals((ESErrorCode) ESERR_NO_ERROR, log.prepare(Path("first.log"), 0));
+		assertEquals((ESErrorCode) ESERR_NO_ERROR, log.prepare(journalPath, sizeBeforeCommit));
+		assertEquals((ESErrorCode) ESERR_NO_ERROR, log.persist(Durability::getDefault()));
+
+		// Grow the log past the size where it's emptied
+		const Path other(string(1000, 'x') + logSuffix);
+		for (uint32_t i = 0; i < 1100; ++i) {
+			assertEquals((ESErrorCode) ESERR_NO_ERROR, log.begin(other, 0, Durability::getDefault()));
+			log.end(other);
+		}
+		log.end(Path("first.log"));
+		assertTrue(FileUtils::getFileSize(logPath.value) > 1024 * 1024);
+		append(journalPath, "2019-01-01T00:00:00.000 unfinished");
+
+		assertTrue(RecoveryLog::replay(logPath, Path()));
+		assertEquals(sizeBeforeCommit, FileUtils::getFileSize(journalPath.value));
+	}
+}
@@ -0,0 +1,107 @@
+#include "../Shared/everstore.h"
+#include "../Server/RequestsInFlight.h"
+#include "../Server/StoreClient.h"
+#include "test/Test.h"
+
+TEST_SUITE(RequestsInFlight)
+{
+	ESHeader request(ESHeaderProperties properties) {
+		ESHeader header;
+		header.type = REQ_READ_JOURNAL;
+		header.properties = properties;
+		return header;
+	}
+
+	UNIT_TEST(requestsAreNotCountedWithoutALimit) {
+		RequestsInFlight requests(0);
+		const auto header = request(ESPROP_NONE);
+		assertFalse(requests.add(&header));
+		assertFalse(requests.full());
+		assertEquals(0, requests.size());
+	}
+
+	UNIT_TEST(requestInManyPartsIsCountedByItsLastPart) {
+		RequestsInFlight requests(2);
+		const auto part = request(ESPROP_MULTIPART);
+		const auto last = request(ESPROP_NONE);
+		assertFalse(requests.add(&part));
+		assertFalse(requests.add(&part));
+		assertTrue(requests.add(&last));
+		assertEquals(1, requests.size());
+		assertFalse(requests.full());
+	}
+
+	UNIT_TEST(pausedClientIsResumedOnce) {
+		RequestsInFlight requests(2);
+		const auto header = request(ESPROP_NONE);
+		requests.add(&header);
+		requests.add(&header);
+		assertTrue(requests.full());
+		assertTrue(requests.pause());
+		assertTrue(requests.paused());
+
+		assertTrue(requests.complete(1));
+		assertFalse(requests.paused());
+		assertFalse(requests.complete(1));
+		assertEquals(0, requests.size());
+	}
+
+	UNIT_TEST(clientIsNotPausedIfRequestsCompletedInTheMeantime) {
+		RequestsInFlight requests(1);
+		const auto header = request(ESPROP_NONE);
+		requests.add(&header);
+		requests.complete(1);
+		assertFalse(requests.pause());
+		assertFalse(requests.paused());
+	}
+
+	UNIT_TEST(completedRequestsNeverGoBelowZero) {
+		RequestsInFlight requests(2);
+		const auto header = request(ESPROP_NONE);
+		requests.add(&header);
+		assertFalse(requests.complete(5));
+		assertEquals(0, requests.size());
+
+		requests.add(&header);
+		requests.add(&header);
+		assertTrue(requests.full());
+	}
+
+	UNIT_TEST(lostRequestsResumeTheClient) {
+		RequestsInFlight requests(2);
+		const auto header = request(ESPROP_NONE);
+		requests.add(&header);
+		requests.add(&header);
+		assertTrue(requests.pause());
+		assertTrue(requests.lose());
+		assertFalse(requests.paused());
+		assertEquals(0, requests.size());
+	}
+
+	UNIT_TEST(requestThatNeverReachesAWorkerIsCompleted) {
+		int sockets[2];
+		assertEquals(0, socketpair(AF_UNIX, SOCK_STREAM, 0, sockets));
+
+		// There are no workers, so every request fails
+		IpcHost host(Path(), Path(), 1024u, 0u, false, false);
+		StoreClient client(new Socket(sockets[0], 1024), 1, &host, 1024u, 1u);
+		assertEquals((ESErrorCode) ESERR_NO_ERROR, client.initialize());
+
+		// Two requests sent at the same time
+		char requests[2 * sizeof(ESHeader)];
+		for (uint32_t i = 0; i < 2; ++i) {
+			const ESHeader header(REQ_READ_JOURNAL, 0, i + 1, ESPROP_NONE, ProcessID(1));
+			memcpy(requests + i * sizeof(ESHeader), &header, sizeof(ESHeader));
+		}
+		assertEquals((int) sizeof(requests), (int) send(sockets[1], requests, sizeof(requests), 0));
+		assertEquals((ESErrorCode) ESERR_NO_ERROR, client.receive());
+		assertFalse(client.full());
+
+		// The client finds the failed requests by their ids
+		char received[2 * (sizeof(RequestError::Header) + sizeof(RequestError::Response))];
+		assertEquals((int) sizeof(received), (int) recv(sockets[1], received, sizeof(received), MSG_WAITALL));
+		assertEquals(1U, ((const ESHeader*) received)->requestUID);
+		assertEquals(2U, ((const ESHeader*) (received + sizeof(received) / 2))->requestUID);
+		close(sockets[1]);
+	}
+}
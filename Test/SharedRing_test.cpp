@@ -0,0 +1,118 @@
+#include "../Shared/everstore.h"
+#include "../Shared/Ipc/SharedRing.h"
+#include "test/Test.h"
+
+TEST_SUITE(SharedRing)
+{
+	UNIT_TEST(bytesAreReadInTheOrderTheyAreWritten) {
+		SharedRing* producer = SharedRing::create("/everstore_ring_test_order", 100);
+
+		// Shared memory rings are only supported on Linux
+		if (producer == nullptr) {
+			return;
+		}
+		assertEquals(128U, producer->capacity());
+		SharedRing* consumer = SharedRing::open("/everstore_ring_test_order");
+		assertNotNull(consumer);
+		assertEquals(128U, consumer->capacity());
+		assertFalse(consumer->waitForData(0));
+
+		// Write enough messages for the ring to wrap around a few times
+		char message[48];
+		char result[48];
+		for (uint32_t i = 0; i < 10; ++i) {
+			memset(message, 'a' + i, sizeof(message));
+			assertTrue(producer->write(message, sizeof(message)));
+			assertTrue(consumer->waitForData(0));
+			assertEquals((uint32_t) sizeof(message), consumer->size());
+			assertEquals((uint32_t) sizeof(message), consumer->read(result, sizeof(result), 0));
+			assertEquals(0, memcmp(message, result, sizeof(message)));
+		}
+		assertEquals(0U, producer->size());
+
+		delete consumer;
+		delete producer;
+	}
+
+	UNIT_TEST(tooLargeWritesAreRejected) {
+		SharedRing* producer = SharedRing::create("/everstore_ring_test_large", 64);
+		if (producer == nullptr) {
+			return;
+		}
+
+		char message[65] = {0};
+		assertFalse(producer->write(message, sizeof(message)));
+		assertTrue(producer->write(message, 64));
+		assertEquals(64U, producer->size());
+
+		delete producer;
+	}
+
+	UNIT_TEST(manyPartsAreWrittenTogether) {
+		SharedRing* ring = SharedRing::create("/everstore_ring_test_parts", 64);
+		if (ring == nullptr) {
+			return;
+		}
+
+		const SharedRing::Part parts[] = {{"hello", 5}, {" ", 1}, {"world", 5}};
+		assertTrue(ring->write(parts, 3));
+		assertEquals(11U, ring->size());
+
+		char result[12] = {0};
+		assertEquals(11U, ring->read(result, 11, 0));
+		assertEquals(string("hello world"), string(result));
+
+		// All parts must fit in the ring
+		char large[60] = {0};
+		const SharedRing::Part tooLarge[] = {{large, 60}, {"hello", 5}};
+		assertFalse(ring->write(tooLarge, 2));
+
+		delete ring;
+	}
+
+	UNIT_TEST(readStopsWhenNoBytesAreWritten) {
+		SharedRing* ring = SharedRing::create("/everstore_ring_test_timeout", 64);
+		if (ring == nullptr) {
+			return;
+		}
+
+		char message[] = "hello";
+		char result[16];
+		assertTrue(ring->write(message, 5));
+		assertEquals(5U, ring->read(result, sizeof(result), 1000));
+		assertFalse(ring->waitForData(1000));
+
+		delete ring;
+	}
+
+	UNIT_TEST(producerWaitsForConsumer) {
+		SharedRing* producer = SharedRing::create("/everstore_ring_test_threads", 256);
+		if (producer == nullptr) {
+			return;
+		}
+		SharedRing* consumer = SharedRing::open("/everstore_ring_test_threads");
+		assertNotNull(consumer);
+
+		// Write many more bytes than the ring can hold, so that both the producer and the consumer have to wait
+		static const uint32_t Count = 10000;
+		thread writer([producer]() {
+			for (uint32_t i = 0; i < Count; ++i) {
+				producer->write((const char*) &i, sizeof(i));
+			}
+		});
+
+		bool ordered = true;
+		for (uint32_t i = 0; i < Count; ++i) {
+			uint32_t value = 0;
+			if (consumer->read((char*) &value, sizeof(value), 1000000) != sizeof(value) || value != i) {
+				ordered = false;
+				break;
+			}
+		}
+		writer.join();
+		assertTrue(ordered);
+
+		delete consumer;
+		delete producer;
+	}
+}
@@ -0,0 +1,78 @@
+#include "../Shared/everstore.h"
+#include "test/Test.h"
+
+TEST_SUITE(Socket)
+{
+	UNIT_TEST(sendPartOfFile) {
+		int sockets[2];
+		assertEquals(0, socketpair(AF_UNIX, SOCK_STREAM, 0, sockets));
+		Socket sender(sockets[0], 1024);
+
+		string data;
+		for (uint32_t i = 0; i < 1000; ++i) {
+			data += "line" + std::to_string(i) + "\n";
+		}
+		const string path = FileUtils::getTempFile();
+		FILE* file = fopen(path.c_str(), "w+b");
+		fwrite(data.c_str(), data.length(), 1, file);
+		fflush(file);
+
+		const uint32_t offset = 10;
+		const uint32_t size = data.length() - 20;
+		assertEquals((int32_t) size, sender.SendFile(file, offset, size));
+
+		string received(size, '\0');
+		uint32_t receivedBytes = 0;
+		while (receivedBytes < size) {
+			const auto t = recv(sockets[1], &received[receivedBytes], size - receivedBytes, 0);
+			if (t <= 0) break;
+			receivedBytes += t;
+		}
+		assertEquals(size, receivedBytes);
+		assertTrue(received == data.substr(offset, size));
+
+		fclose(file);
+		close(sockets[1]);
+	}
+
+	UNIT_TEST(sendManyParts) {
+		int sockets[2];
+		assertEquals(0, socketpair(AF_UNIX, SOCK_STREAM, 0, sockets));
+		Socket sender(sockets[0], 1024);
+
+		// More parts than can be sent with one call, and an empty part
+		vector<string> lines;
+		for (uint32_t i = 0; i < 100; ++i) {
+			lines.push_back(i == 50 ? string() : "line" + std::to_string(i) + "\n");
+		}
+		vector<SocketPart> parts;
+		string data;
+		for (auto& line : lines) {
+			parts.push_back({line.c_str(), (uint32_t) line.length()});
+			data += line;
+		}
+		assertEquals((int32_t) data.length(), sender.SendAll(parts.data(), parts.size()));
+
+		string received(data.length(), '\0');
+		uint32_t receivedBytes = 0;
+		while (receivedBytes < data.length()) {
+			const auto t = recv(sockets[1], &received[receivedBytes], data.length() - receivedBytes, 0);
+			if (t <= 0) break;
+			receivedBytes += t;
+		}
+		assertEquals((uint32_t) data.length(), receivedBytes);
+		assertTrue(received == data);
+
+		close(sockets[1]);
+	}
+
+	UNIT_TEST(sendFileOnDestroyedSocket) {
+		Socket sender(OsSocket::Invalid, 1024);
+		const string path = FileUtils::getTempFile();
+		FILE* file = fopen(path.c_str(), "w+b");
+
+		assertEquals(-1, sender.SendFile(file, 0, 10));
+
+		fclose(file);
+	}
+}
@@ -0,0 +1,116 @@
+#include "../Shared/everstore.h"
+#include "../Shared/TimerWheel.h"
+#include "test/Test.h"
+
+struct TimerItem
+{
+	uint32_t value;
+	TimerWheelLink<TimerItem> link;
+};
+
+TEST_SUITE(TimerWheel)
+{
+	UNIT_TEST(emptyWheel) {
+		TimerWheel<TimerItem> wheel(&TimerItem::link);
+		assertTrue(wheel.empty());
+		assertTrue(wheel.ticksUntilNext() == UINT64_MAX);
+
+		vector<uint32_t> expired;
+		assertEquals(0U, wheel.advance(1000u, [&expired](TimerItem* item) { expired.push_back(item->value); }));
+		assertEquals(1001U, (uint32_t) wheel.tick());
+	}
+
+	UNIT_TEST(itemsExpireAtTheirTick) {
+		TimerWheel<TimerItem> wheel(&TimerItem::link);
+		const uint64_t ticks[] = {0u, 1u, 63u, 64u, 65u, 4095u, 4096u, 5000u, 300000u};
+		const uint32_t count = sizeof(ticks) / sizeof(ticks[0]);
+		TimerItem items[count];
+		for (uint32_t i = 0; i < count; ++i) {
+			items[i].value = i;
+			wheel.add(&items[i], ticks[i]);
+		}
+		assertFalse(wheel.empty());
+
+		// Advance one tick at a time and make sure that each item expires exactly at its tick
+		vector<uint64_t> expiredAt(count, UINT64_MAX);
+		for (uint64_t tick = 0; tick <= 300000u; ++tick) {
+			wheel.advance(tick, [&expiredAt, tick](TimerItem* item) { expiredAt[item->value] = tick; });
+		}
+		for (uint32_t i = 0; i < count; ++i) {
+			assertEquals((uint32_t) ticks[i], (uint32_t) expiredAt[i]);
+		}
+		assertTrue(wheel.empty());
+	}
+
+	UNIT_TEST(advanceManyTicksAtOnce) {
+		TimerWheel<TimerItem> wheel(&TimerItem::link, 100u);
+		TimerItem items[3];
+		wheel.add(&items[0], 150u);
+		wheel.add(&items[1], 10000u);
+		wheel.add(&items[2], 20000u);
+
+		uint32_t expired = 0;
+		auto onExpired = [&expired](TimerItem*) { expired++; };
+		assertEquals(0U, wheel.advance(149u, onExpired));
+		assertEquals(2U, wheel.advance(10000u, onExpired));
+		assertEquals(2U, expired);
+		assertFalse(wheel.empty());
+		assertEquals(1U, wheel.advance(30000u, onExpired));
+		assertTrue(wheel.empty());
+	}
+
+	UNIT_TEST(removedAndDeletedItemsNeverExpire) {
+		TimerWheel<TimerItem> wheel(&TimerItem::link);
+		TimerItem kept;
+		TimerItem removed;
+		auto deleted = new TimerItem();
+		wheel.add(&kept, 10u);
+		wheel.add(&removed, 10u);
+		wheel.add(deleted, 5000u);
+
+		wheel.remove(&removed);
+		delete deleted;
+
+		vector<TimerItem*> expired;
+		wheel.advance(10000u, [&expired](TimerItem* item) { expired.push_back(item); });
+		assertEquals(1U, (uint32_t) expired.size());
+		assertTrue(expired[0] == &kept);
+	}
+
+	UNIT_TEST(addedItemIsMoved) {
+		TimerWheel<TimerItem> wheel(&TimerItem::link);
+		TimerItem item;
+		wheel.add(&item, 10u);
+		wheel.add(&item, 20u);
+
+		uint32_t expired = 0;
+		auto onExpired = [&expired](TimerItem*) { expired++; };
+		assertEquals(0U, wheel.advance(19u, onExpired));
+		assertEquals(1U, wheel.advance(20u, onExpired));
+	}
+
+	UNIT_TEST(ticksUntilNextItem) {
+		TimerWheel<TimerItem> wheel(&TimerItem::link, 10u);
+		TimerItem soon;
+		TimerItem later;
+		wheel.add(&soon, 15u);
+		assertEquals(5U, (uint32_t) wheel.ticksUntilNext());
+
+		// An item in the levels above might be due when the first level has gone around
+		wheel.add(&later, 1000u);
+		assertEquals(5U, (uint32_t) wheel.ticksUntilNext());
+		wheel.remove(&soon);
+		assertEquals(54U, (uint32_t) wheel.ticksUntilNext());
+	}
+
+	UNIT_TEST(itemsAfterTheLastLevelExpireAfterMaxTicks) {
+		TimerWheel<TimerItem> wheel(&TimerItem::link);
+		TimerItem item;
+		wheel.add(&item, UINT64_MAX);
+
+		uint32_t expired = 0;
+		auto onExpired = [&expired](TimerItem*) { expired++; };
+		assertEquals(0U, wheel.advance(TimerWheel<TimerItem>::MaxTicks - 1, onExpired));
+		assertEquals(1U, wheel.advance(TimerWheel<TimerItem>::MaxTicks, onExpired));
+	}
+}
@@ -10,4 +10,48 @@ TEST_SUITE(Timestamp) {
 
 		assertTrue(regex_match(string(t.value), regex("\\d{4}-\\d{2}-\\d{2}T\\d{2}:\\d{2}:\\d{2}\\.\\d{3}")));
 	}
+
+	UNIT_TEST(formatSuppliedTime) {
+		// 2019-10-01T12:34:56.007
+		const chrono::system_clock::time_point time(chrono::milliseconds(1569933296007LL));
+		Timestamp t(time);
+
+		assertEquals(string("2019-10-01T12:34:56.007"), string(t.value));
+	}
+
+	UNIT_TEST(cachedTimestampsHaveValidFormatAndAreOrdered) {
+		Timestamp previous;
+		for (uint32_t i = 0; i < 10000; ++i) {
+			Timestamp t;
+			assertEquals(Timestamp::BytesLength, (uint32_t) strlen(t.value));
+			assertTrue(strcmp(previous.value, t.value) <= 0);
+			previous = t;
+		}
+		assertTrue(regex_match(string(previous.value), regex("\\d{4}-\\d{2}-\\d{2}T\\d{2}:\\d{2}:\\d{2}\\.\\d{3}")));
+
+		// A cached timestamp is never ahead of the time formatted afterwards
+		Timestamp cached;
+		Timestamp formatted(chrono::system_clock::now());
+		assertTrue(strcmp(cached.value, formatted.value) <= 0);
+	}
+
+	UNIT_TEST(benchmarkTimestamp) {
+		const uint32_t count = 100000;
+
+		const auto formattedStart = chrono::high_resolution_clock::now();
+		for (uint32_t i = 0; i < count; ++i) {
+			Timestamp t(chrono::system_clock::now());
+		}
+		const auto formattedTime = chrono::high_resolution_clock::now() - formattedStart;
+
+		const auto cachedStart = chrono::high_resolution_clock::now();
+		for (uint32_t i = 0; i < count; ++i) {
+			Timestamp t;
+		}
+		const auto cachedTime = chrono::high_resolution_clock::now() - cachedStart;
+
+		Log::Write(Log::Info, "Timestamp: formatted %d ns/op, cached %d ns/op",
+		           (int) (chrono::duration_cast<chrono::nanoseconds>(formattedTime).count() / count),
+		           (int) (chrono::duration_cast<chrono::nanoseconds>(cachedTime).count() / count));
+	}
 }
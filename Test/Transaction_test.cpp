@@ -1,4 +1,5 @@
 #include "../Shared/everstore.h"
+#include "../Shared/File/IoRing.h"
 #include "test/Test.h"
 
 TEST_SUITE(Transaction)
@@ -17,6 +18,23 @@ TEST_SUITE(Transaction)
 		assertEquals(3U, transaction3.value);
 	}
 
+	UNIT_TEST(journalHasOpenTransactionsUntilTheyAreClosed) {
+		const Path journalPath(FileUtils::getTempFile() + logSuffix);
+		Journal j(journalPath);
+		assertFalse(j.hasOpenTransactions());
+
+		const auto transaction1 = j.openTransaction();
+		const auto transaction2 = j.openTransaction();
+		assertTrue(j.hasOpenTransactions());
+
+		j.rollback(transaction1);
+		assertTrue(j.hasOpenTransactions());
+
+		j.rollback(transaction2);
+		j.rollback(transaction2);
+		assertFalse(j.hasOpenTransactions());
+	}
+
 	UNIT_TEST(commitSuccessfulOnOneTranscation) {
 		const Path journalPath(FileUtils::getTempFile() + logSuffix);
 		Journal j(journalPath);
@@ -30,7 +48,7 @@ TEST_SUITE(Transaction)
 		bytes.reset();
 		MutableString events(data.length(), &bytes);
 
-		auto err = j.tryCommit(transaction, Bits::All, events);
+		auto err = j.tryCommit(transaction, TypeSet{1u, 2u}, events);
 		assertEquals((ESErrorCode) ESERR_NO_ERROR, err);
 
 		bytes.reset();
@@ -45,11 +63,331 @@ TEST_SUITE(Transaction)
 		assertEquals(data, endsWith);
 	}
 
-	//UNIT_TEST(secondCommitFailedOnSameType) {
+	UNIT_TEST(stagedCommitsAreWrittenOnFlush) {
+		const Path journalPath(FileUtils::getTempFile() + logSuffix);
+		Journal j(journalPath);
+		const auto transaction1 = j.openTransaction();
+		const auto transaction2 = j.openTransaction();
+
+		const string data1("data1");
+		const string data2("data2");
+		ByteBuffer bytes(32);
+		memcpy(bytes.allocate(data1.length()), data1.c_str(), data1.length());
+		memcpy(bytes.allocate(data2.length()), data2.c_str(), data2.length());
+		bytes.reset();
+		MutableString events1(data1.length(), &bytes);
+		MutableString events2(data2.length(), &bytes);
+
+		assertEquals((ESErrorCode) ESERR_NO_ERROR, j.tryStage(transaction1, TypeSet{1u}, events1));
+		assertEquals((ESErrorCode) ESERR_NO_ERROR, j.tryStage(transaction2, TypeSet{2u}, events2));
+		assertEquals(0U, j.journalSize());
+		assertEquals(0U, FileUtils::getFileSize(journalPath.value));
+
+		const uint32_t lineSize = Timestamp::BytesLength + 1;
+		assertEquals((ESErrorCode) ESERR_NO_ERROR, j.flush());
+		assertFalse(j.hasStagedEvents());
+		assertEquals(lineSize * 2 + 12, j.journalSize());
+		assertEquals(j.journalSize(), FileUtils::getFileSize(journalPath.value));
+
+		ByteBuffer journal(128);
+		AutoClosable<FileInputStream>(j.inputStream(0))->readBytes(&journal);
+		const char* ptr = journal.ptr();
+		assertEquals(data1, string(ptr + lineSize, data1.length()));
+		assertEquals('\n', ptr[lineSize + 5]);
+		assertEquals(data2, string(ptr + lineSize * 2 + 6, data2.length()));
+		assertEquals(Journal::JournalEof, ptr[j.journalSize() - 1]);
+	}
+
+	UNIT_TEST(commitManyAndLargeLines) {
+		const Path journalPath(FileUtils::getTempFile() + logSuffix);
+		Journal j(journalPath);
+
+		// More lines than can be written with one vectored write and a line longer than 1 KB
+		const uint32_t numLines = 3000;
+		const string largeLine(4096, 'x');
+		string data;
+		for (uint32_t i = 0; i < numLines; ++i) {
+			data += "line\n";
+		}
+		data += largeLine;
+
+		ByteBuffer bytes(data.length());
+		memcpy(bytes.allocate(data.length()), data.c_str(), data.length());
+		bytes.reset();
+		assertEquals((ESErrorCode) ESERR_NO_ERROR,
+		             j.tryCommit(j.openTransaction(), TypeSet{1u}, MutableString(data.length(), &bytes)));
+		bytes.reset();
+		assertEquals((ESErrorCode) ESERR_NO_ERROR, j.tryCommit(j.openTransaction(), TypeSet{2u}, MutableString(5, &bytes)));
+
+		const uint32_t lineSize = Timestamp::BytesLength + 1;
+		const uint32_t firstCommitSize = (numLines + 1) * lineSize + data.length() + 1;
+		assertEquals(firstCommitSize + lineSize + 5 + 1, j.journalSize());
+		assertEquals(j.journalSize(), FileUtils::getFileSize(journalPath.value));
+
+		ByteBuffer journal(j.journalSize());
+		AutoClosable<FileInputStream>(j.inputStream(0))->readBytes(&journal);
+		const char* ptr = journal.ptr();
+		assertEquals(largeLine, string(ptr + firstCommitSize - 1 - largeLine.length(), largeLine.length()));
+		assertEquals('\n', ptr[firstCommitSize - 1]);
+		assertEquals(string("line\n"), string(ptr + firstCommitSize + lineSize, 5));
+		assertEquals(Journal::JournalEof, ptr[j.journalSize() - 1]);
+	}
+
+	UNIT_TEST(commitsAreSynchronizedWithDisk) {
+		const Path journalPath(FileUtils::getTempFile() + logSuffix);
+		Durability durability(Durability::FDataSync, 0);
+		JournalOptions options;
+		options.durability = &durability;
+		Journal j(journalPath, options);
+
+		const string data("data");
+		ByteBuffer bytes(32);
+		memcpy(bytes.allocate(data.length()), data.c_str(), data.length());
+		bytes.reset();
+
+		// The first commit has no previous EOF-marker to replace
+		assertEquals((ESErrorCode) ESERR_NO_ERROR,
+		             j.tryCommit(j.openTransaction(), TypeSet{1u}, MutableString(data.length(), &bytes)));
+		assertEquals(1U, (uint32_t) durability.syncs());
+
+		bytes.reset();
+		assertEquals((ESErrorCode) ESERR_NO_ERROR,
+		             j.tryCommit(j.openTransaction(), TypeSet{2u}, MutableString(data.length(), &bytes)));
+		assertEquals(3U, (uint32_t) durability.syncs());
+	}
+
+	UNIT_TEST(writtenJournalsAreSynchronizedOnInterval) {
+		const Path journalPath(FileUtils::getTempFile() + logSuffix);
+		Durability durability(Durability::FDataSyncInterval, 0);
+		JournalOptions options;
+		options.durability = &durability;
+		Journal j(journalPath, options);
+
+		const string data("data");
+		ByteBuffer bytes(32);
+		memcpy(bytes.allocate(data.length()), data.c_str(), data.length());
+		bytes.reset();
+
+		assertEquals((ESErrorCode) ESERR_NO_ERROR,
+		             j.tryCommit(j.openTransaction(), TypeSet{1u}, MutableString(data.length(), &bytes)));
+		assertTrue(j.durabilityLink.isLinked());
+		assertEquals(0U, (uint32_t) durability.syncs());
+
+		durability.syncWrittenJournals();
+		assertFalse(j.durabilityLink.isLinked());
+		assertEquals(1U, (uint32_t) durability.syncs());
+	}
+
+	UNIT_TEST(writtenJournalsAreSynchronizedWithRing) {
+		IoRing ring(1);
+		Durability durability(Durability::FDataSyncInterval, 0, &ring);
+		JournalOptions options;
+		options.durability = &durability;
+		Journal j1(Path(FileUtils::getTempFile() + logSuffix), options);
+		Journal j2(Path(FileUtils::getTempFile() + logSuffix), options);
+
+		const string data("data");
+		ByteBuffer bytes(32);
+		memcpy(bytes.allocate(data.length()), data.c_str(), data.length());
+		bytes.reset();
+		assertEquals((ESErrorCode) ESERR_NO_ERROR,
+		             j1.tryCommit(j1.openTransaction(), TypeSet{1u}, MutableString(data.length(), &bytes)));
+		bytes.reset();
+		assertEquals((ESErrorCode) ESERR_NO_ERROR,
+		             j2.tryCommit(j2.openTransaction(), TypeSet{1u}, MutableString(data.length(), &bytes)));
+
+		// More journals than the ring can take at a time
+		durability.syncWrittenJournals();
+		assertFalse(j1.durabilityLink.isLinked());
+		assertFalse(j2.durabilityLink.isLinked());
+		assertEquals(2U, (uint32_t) durability.syncs());
+	}
+
+	UNIT_TEST(stagedCommitsInManyJournalsAreWrittenTogether) {
+		IoRing ring(8);
+		IoRing disabled(0);
+		IoRing* const rings[] = {&ring, &disabled};
+		for (auto r : rings) {
+			Durability durability(Durability::Group, 0, r);
+			JournalOptions options;
+			options.durability = &durability;
+			Journal v1(Path(FileUtils::getTempFile() + logSuffix), options);
+			options.format = JournalFormat::V2;
+			Journal v2(Path(FileUtils::getTempFile() + logSuffix), options);
+
+			const string data("data");
+			ByteBuffer bytes(32);
+			memcpy(bytes.allocate(data.length()), data.c_str(), data.length());
+			bytes.reset();
+
+			// The first commit to the version 1 journal is written directly, so that the EOF-marker is replaced
+			assertEquals((ESErrorCode) ESERR_NO_ERROR,
+			             v1.tryCommit(v1.openTransaction(), TypeSet{1u}, MutableString(data.length(), &bytes)));
+			const uint32_t sizeBefore = v1.journalSize();
+			bytes.reset();
+			assertEquals((ESErrorCode) ESERR_NO_ERROR,
+			             v1.tryStage(v1.openTransaction(), TypeSet{1u}, MutableString(data.length(), &bytes)));
+			bytes.reset();
+			assertEquals((ESErrorCode) ESERR_NO_ERROR,
+			             v2.tryStage(v2.openTransaction(), TypeSet{1u}, MutableString(data.length(), &bytes)));
+
+			vector<Journal*> journals;
+			journals.push_back(&v1);
+			journals.push_back(&v2);
+			vector<ESErrorCode> errors;
+			Journal::flush(journals, r, &errors);
+			assertEquals(2U, (uint32_t) errors.size());
+			assertEquals((ESErrorCode) ESERR_NO_ERROR, errors[0]);
+			assertEquals((ESErrorCode) ESERR_NO_ERROR, errors[1]);
+			assertFalse(v1.hasStagedEvents());
+			assertFalse(v2.hasStagedEvents());
+
+			assertEquals(sizeBefore * 2, v1.journalSize());
+			assertEquals(v1.journalSize(), FileUtils::getFileSize(v1.path().value));
+			assertEquals(v2.journalSize(), FileUtils::getFileSize(v2.path().value));
+
+			ByteBuffer journal(128);
+			AutoClosable<FileInputStream>(v1.inputStream(0))->readBytes(&journal);
+			assertEquals('\n', journal.ptr()[sizeBefore - 1]);
+			assertEquals(Journal::JournalEof, journal.ptr()[v1.journalSize() - 1]);
+
+			ByteBuffer records(128);
+			uint32_t bytesWritten = 0;
+			assertEquals((ESErrorCode) ESERR_NO_ERROR,
+			             AutoClosable<FileInputStream>(v2.inputStream(0))->readRecords(&records, 128, false,
+			                                                                          &bytesWritten));
+			assertEquals(data, string(records.ptr(), bytesWritten));
+		}
+	}
+
+	UNIT_TEST(secondCommitFailedOnSameType) {
+		const Path journalPath(FileUtils::getTempFile() + logSuffix);
+		Journal j(journalPath);
+		const auto transaction1 = j.openTransaction();
+		const auto transaction2 = j.openTransaction();
+
+		const string data("data");
+		ByteBuffer bytes(32);
+		memcpy(bytes.allocate(data.length()), data.c_str(), data.length());
+		bytes.reset();
+		MutableString events(data.length(), &bytes);
+
+		assertEquals((ESErrorCode) ESERR_NO_ERROR, j.tryCommit(transaction1, TypeSet{1u, 2u}, events));
+		assertEquals((ESErrorCode) ESERR_JOURNAL_TRANSACTION_CONFLICT,
+		             j.tryCommit(transaction2, TypeSet{2u, 3u}, events));
+
+		// A transaction opened after the commit doesn't conflict with it
+		assertEquals((ESErrorCode) ESERR_NO_ERROR, j.tryCommit(j.openTransaction(), TypeSet{2u}, events));
+	}
+
+	UNIT_TEST(commitSuccessfullForDifferentTypes) {
+		const Path journalPath(FileUtils::getTempFile() + logSuffix);
+		Journal j(journalPath);
+		const auto transaction1 = j.openTransaction();
+		const auto transaction2 = j.openTransaction();
+
+		const string data("data");
+		ByteBuffer bytes(32);
+		memcpy(bytes.allocate(data.length()), data.c_str(), data.length());
+		bytes.reset();
+		MutableString events(data.length(), &bytes);
 
-	//}
+		// Type ids above the ones that fit in 64 bits are kept apart
+		assertEquals((ESErrorCode) ESERR_NO_ERROR, j.tryCommit(transaction1, TypeSet{1u, 500u}, events));
+		assertEquals((ESErrorCode) ESERR_NO_ERROR, j.tryCommit(transaction2, TypeSet{65u, 501u}, events));
+		const uint32_t lineSize = Timestamp::BytesLength + 1;
+		assertEquals(2U * (lineSize + (uint32_t) data.length() + 1), j.journalSize());
+	}
 
-	//UNIT_TEST(commitSuccessfullForDifferentTypes) {
+	UNIT_TEST(closedTransactionIdsAreNotFoundWhenTheirIndexIsReused) {
+		const Path journalPath(FileUtils::getTempFile() + logSuffix);
+		Journal j(journalPath);
+		const auto transaction1 = j.openTransaction();
+		j.rollback(transaction1);
+		const auto transaction2 = j.openTransaction();
+		assertEquals(transaction1.AsIndex(), transaction2.AsIndex());
+		assertTrue(transaction1 != transaction2);
 
-	//}
+		const string data("data");
+		ByteBuffer bytes(32);
+		memcpy(bytes.allocate(data.length()), data.c_str(), data.length());
+		bytes.reset();
+		MutableString events(data.length(), &bytes);
+
+		// Neither a commit nor a rollback with the old id affects the new transaction
+		j.rollback(transaction1);
+		assertTrue(j.hasOpenTransactions());
+		assertEquals((ESErrorCode) ESERR_JOURNAL_TRANSACTION_DOES_NOT_EXIST,
+		             j.tryCommit(transaction1, TypeSet{1u}, events));
+		assertEquals((ESErrorCode) ESERR_NO_ERROR, j.tryCommit(transaction2, TypeSet{1u}, events));
+	}
+
+	UNIT_TEST(commitsAreLoggedWhileOlderTransactionsAreOpen) {
+		const Path journalPath(FileUtils::getTempFile() + logSuffix);
+		Journal j(journalPath);
+		OpenTransactions transactions;
+		const auto idle = transactions.open(&j);
+
+		for (uint32_t i = 0; i < 1000; ++i) {
+			const auto id = transactions.open(&j);
+			assertFalse(transactions.conflictsWith(transactions.get(id), TypeSet{1u}));
+			transactions.close(id);
+			transactions.onTransactionCommitted(TypeSet{i % 2u});
+		}
+		assertEquals(1000U, transactions.loggedCommits());
+		assertTrue(transactions.conflictsWith(transactions.get(idle), TypeSet{1u}));
+		assertFalse(transactions.conflictsWith(transactions.get(idle), TypeSet{2u}));
+
+		transactions.close(idle);
+		assertTrue(transactions.empty());
+		assertEquals(0U, transactions.loggedCommits());
+	}
+
+	UNIT_TEST(commitsAreRemovedWhenNoTransactionCanConflictWithThem) {
+		const Path journalPath(FileUtils::getTempFile() + logSuffix);
+		Journal j(journalPath);
+		OpenTransactions transactions;
+		uint32_t previous = transactions.open(&j).value;
+
+		for (uint32_t i = 0; i < 1000; ++i) {
+			const auto next = transactions.open(&j);
+			transactions.close(TransactionID(previous));
+			transactions.onTransactionCommitted(TypeSet{1u});
+			previous = next.value;
+		}
+		assertTrue(transactions.loggedCommits() <= 2 * OpenTransactions::MinCommitsBeforeTrim);
+		assertTrue(transactions.conflictsWith(transactions.get(TransactionID(previous)), TypeSet{1u}));
+	}
+
+	UNIT_TEST(commitOfExpiredTransactionFails) {
+		const Path journalPath(FileUtils::getTempFile() + logSuffix);
+		Journal j(journalPath);
+		const auto transaction1 = j.openTransaction();
+		const auto transaction2 = j.openTransaction();
+
+		j.expire(transaction1);
+		assertTrue(j.transaction(transaction1) == nullptr);
+		assertTrue(j.hasOpenTransactions());
+
+		const string data("data");
+		ByteBuffer bytes(32);
+		memcpy(bytes.allocate(data.length()), data.c_str(), data.length());
+		bytes.reset();
+		MutableString events(data.length(), &bytes);
+
+		assertEquals((ESErrorCode) ESERR_JOURNAL_TRANSACTION_EXPIRED, j.tryCommit(transaction1, TypeSet{1u}, events));
+		assertEquals((ESErrorCode) ESERR_NO_ERROR, j.tryCommit(transaction2, TypeSet{1u}, events));
+
+		// The transaction that reuses the index is not expired
+		const auto transaction3 = j.openTransaction();
+		assertEquals(transaction2.AsIndex(), transaction3.AsIndex());
+		j.expire(transaction3);
+		const auto transaction4 = j.openTransaction();
+		assertEquals(transaction3.AsIndex(), transaction4.AsIndex());
+		assertEquals((ESErrorCode) ESERR_JOURNAL_TRANSACTION_EXPIRED, j.tryCommit(transaction3, TypeSet{2u}, events));
+		assertEquals((ESErrorCode) ESERR_NO_ERROR, j.tryCommit(transaction4, TypeSet{2u}, events));
+		assertEquals((ESErrorCode) ESERR_JOURNAL_TRANSACTION_DOES_NOT_EXIST,
+		             j.tryCommit(transaction4, TypeSet{2u}, events));
+		assertFalse(j.hasOpenTransactions());
+	}
 }
@@ -0,0 +1,67 @@
+#include "../Shared/everstore.h"
+#include "test/Test.h"
+
+TEST_SUITE(TypeInterner)
+{
+	UNIT_TEST(namesAreGivenIdsInOrder) {
+		TypeInterner types;
+		assertEquals(0U, types.intern("a", 1));
+		assertEquals(1U, types.intern("b", 1));
+		assertEquals(2U, types.intern("ab", 2));
+		assertEquals(3U, types.size());
+	}
+
+	UNIT_TEST(sameNameIsGivenSameId) {
+		TypeInterner types;
+		types.intern("first", 5);
+		const auto id = types.intern("second", 6);
+		assertEquals(id, types.intern("second", 6));
+		assertEquals(2U, types.size());
+	}
+
+	UNIT_TEST(nameDoesNotHaveToEndWithNull) {
+		TypeInterner types;
+		const char names[] = "Org.Event1,Org.Event2";
+		const auto first = types.intern(names, 10);
+		const auto second = types.intern(names + 11, 10);
+		assertEquals(0U, first);
+		assertEquals(1U, second);
+		assertEquals(first, types.find("Org.Event1", 10));
+		assertEquals(second, types.find("Org.Event2", 10));
+	}
+
+	UNIT_TEST(hashCanBeComputedOneCharacterAtATime) {
+		const char name[] = "Org.Event";
+		uint32_t hash = TypeInterner::EmptyHash;
+		for (uint32_t i = 0; i < 9; ++i) {
+			hash = TypeInterner::hash(hash, name[i]);
+		}
+		assertEquals(TypeInterner::hash(name, 9), hash);
+
+		TypeInterner types;
+		const auto id = types.intern(name, 9, hash);
+		assertEquals(id, types.intern(name, 9));
+	}
+
+	UNIT_TEST(unknownNameIsNotFound) {
+		TypeInterner types;
+		types.intern("a", 1);
+		assertEquals(TypeInterner::NotFound, types.find("b", 1));
+		assertEquals(TypeInterner::NotFound, types.find("", 0));
+		assertEquals(1U, types.size());
+	}
+
+	UNIT_TEST(namesAreFoundAfterTheTableHasGrown) {
+		TypeInterner types;
+		char name[16];
+		for (uint32_t i = 0; i < 2000; ++i) {
+			const auto length = (uint32_t) snprintf(name, sizeof(name), "Event%u", i);
+			assertEquals(i, types.intern(name, length));
+		}
+		assertEquals(2000U, types.size());
+		for (uint32_t i = 0; i < 2000; ++i) {
+			const auto length = (uint32_t) snprintf(name, sizeof(name), "Event%u", i);
+			assertEquals(i, types.find(name, length));
+		}
+	}
+}
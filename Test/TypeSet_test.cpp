@@ -0,0 +1,97 @@
+#include "../Shared/everstore.h"
+#include "test/Test.h"
+
+TEST_SUITE(TypeSet)
+{
+	UNIT_TEST(emptySet) {
+		TypeSet types;
+		assertTrue(types.empty());
+		assertEquals(0U, types.size());
+		assertFalse(types.contains(0u));
+		assertFalse(types.contains(1000u));
+		assertFalse(types.intersects(types));
+	}
+
+	UNIT_TEST(addTypes) {
+		TypeSet types;
+		types.add(0u);
+		types.add(63u);
+		types.add(64u);
+		types.add(TypeSet::InlineTypes);
+		types.add(1000u);
+		types.add(1000u);
+
+		assertFalse(types.empty());
+		assertEquals(5U, types.size());
+		assertTrue(types.contains(0u));
+		assertTrue(types.contains(63u));
+		assertTrue(types.contains(64u));
+		assertTrue(types.contains(TypeSet::InlineTypes));
+		assertTrue(types.contains(1000u));
+		assertFalse(types.contains(1u));
+		assertFalse(types.contains(999u));
+		assertFalse(types.contains(100000u));
+	}
+
+	UNIT_TEST(setsWithTheSameTypeIntersect) {
+		const TypeSet a{1u, 2u, 300u};
+		const TypeSet b{3u, 300u};
+		const TypeSet c{3u, 299u, 4000u};
+		assertTrue(a.intersects(b));
+		assertTrue(b.intersects(a));
+		assertFalse(a.intersects(c));
+		assertFalse(c.intersects(a));
+		assertTrue(b.intersects(c));
+	}
+
+	UNIT_TEST(addAllTypesInAnotherSet) {
+		TypeSet types{1u};
+		types.add(TypeSet{2u, 700u});
+		assertEquals(3U, types.size());
+		assertTrue(types.contains(1u));
+		assertTrue(types.contains(2u));
+		assertTrue(types.contains(700u));
+		assertTrue(types.intersects(TypeSet{700u}));
+	}
+
+	UNIT_TEST(manyLargeTypes) {
+		TypeSet types;
+		for (uint32_t i = 0; i < 3u * TypeSet::InlineLargeTypes; ++i) {
+			types.add(100000u - i * 1000u);
+		}
+		types.add(100000u);
+		assertEquals(3U * TypeSet::InlineLargeTypes, types.size());
+		assertTrue(types.contains(100000u));
+		assertTrue(types.contains(100000u - 5u * 1000u));
+		assertFalse(types.contains(100000u - 500u));
+
+		assertTrue(types.intersects(TypeSet{1u, 100000u - 2u * 1000u}));
+		assertTrue(TypeSet{100000u - 2u * 1000u}.intersects(types));
+		assertFalse(types.intersects(TypeSet{1u, 200u, 100001u}));
+
+		// A copy has the same types
+		const TypeSet copy(types);
+		assertEquals(types.size(), copy.size());
+		assertTrue(copy.intersects(TypeSet{100000u}));
+	}
+
+	UNIT_TEST(clearTypes) {
+		TypeSet types{5u, 900u};
+		types.clear();
+		assertTrue(types.empty());
+		assertFalse(types.contains(900u));
+
+		types.add(900u);
+		assertEquals(1U, types.size());
+
+		for (uint32_t i = 0; i < 2u * TypeSet::InlineLargeTypes; ++i) {
+			types.add(1000u + i);
+		}
+		types.clear();
+		assertTrue(types.empty());
+		assertFalse(types.contains(1000u));
+		types.add(1001u);
+		assertEquals(1U, types.size());
+		assertTrue(types.contains(1001u));
+	}
+}
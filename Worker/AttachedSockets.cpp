@@ -1,6 +1,51 @@
 #include "AttachedSockets.h"
 
-AttachedConnection gAttachedSocket = {nullptr, nullptr};
+AttachedConnection gAttachedSocket = {nullptr, nullptr, nullptr, 0};
+
+ESErrorCode AttachedConnection::send(const ByteBuffer* memory) const {
+	if (socket == nullptr) {
+		return channel->send(client, memory);
+	}
+
+	// The current offset indicates how much memory we've written to the memory
+	const uint32_t size = memory->offset();
+
+	lock->Lock();
+	const uint32_t recv = socket->SendAll(memory->ptr(), size);
+	lock->Unlock();
+
+	// The request is completed even if the client is gone
+	if (channel != nullptr && ResponseChannel::completesRequest(memory)) {
+		channel->complete(client);
+	}
+
+	// Verify that we've sent all the data to the client
+	if (recv != size) return ESERR_SOCKET_SEND;
+	return ESERR_NO_ERROR;
+}
+
+ESErrorCode AttachedConnection::sendWithFile(const ByteBuffer* memory, FILE* file, uint32_t offset,
+                                             uint32_t size) const {
+	if (socket == nullptr) {
+		return channel->sendWithFile(client, memory, file, offset, size);
+	}
+
+	const uint32_t memorySize = memory->offset();
+
+	lock->Lock();
+	bool sent = socket->SendAll(memory->ptr(), memorySize) == (int32_t) memorySize;
+	if (sent && size > 0) {
+		sent = socket->SendFile(file, offset, size) == (int32_t) size;
+	}
+	lock->Unlock();
+
+	if (channel != nullptr && ResponseChannel::completesRequest(memory)) {
+		channel->complete(client);
+	}
+
+	if (!sent) return ESERR_SOCKET_SEND;
+	return ESERR_NO_ERROR;
+}
 
 AttachedSockets::AttachedSockets() {
 
@@ -21,10 +66,22 @@ AttachedConnection* AttachedSockets::get(OsSocket::Ref socketRef) {
 	return it->second;
 }
 
-void AttachedSockets::add(OsSocket::Ref socketFromHost, Socket* clientSocket, Mutex* lock) {
+void AttachedSockets::add(OsSocket::Ref socketFromHost, Socket* clientSocket, Mutex* lock,
+                          ResponseChannel* completions) {
 	auto a = new AttachedConnection();
 	a->socket = clientSocket;
 	a->lock = lock;
+	a->channel = completions;
+	a->client = socketFromHost;
+	mSockets.insert(make_pair(socketFromHost, a));
+}
+
+void AttachedSockets::add(OsSocket::Ref socketFromHost, ResponseChannel* channel) {
+	auto a = new AttachedConnection();
+	a->socket = nullptr;
+	a->lock = nullptr;
+	a->channel = channel;
+	a->client = socketFromHost;
 	mSockets.insert(make_pair(socketFromHost, a));
 }
 
@@ -2,11 +2,25 @@
 #define _EVERSTORE_ATTACHED_SOCKETS_H_
 
 #include "../Shared/everstore.h"
+#include "ResponseChannel.h"
 
 struct AttachedConnection
 {
 	Socket* socket;
 	Mutex* lock;
+
+	// Used for the responses if there's no socket. Otherwise set if the host is told when the requests are completed
+	ResponseChannel* channel;
+	int32_t client;
+
+	// Can responses be sent to the client
+	inline bool attached() const { return channel != nullptr || (socket != nullptr && lock != nullptr); }
+
+	// Send the supplied memory block to the client
+	ESErrorCode send(const ByteBuffer* memory) const;
+
+	// Send the supplied memory block followed by a part of a file, without any other response in between
+	ESErrorCode sendWithFile(const ByteBuffer* memory, FILE* file, uint32_t offset, uint32_t size) const;
 };
 
 class AttachedSockets
@@ -18,7 +32,10 @@ public:
 
 	AttachedConnection* get(OsSocket::Ref socketRef);
 
-	void add(OsSocket::Ref socketFromHost, Socket* clientSocket, Mutex* lock);
+	void add(OsSocket::Ref socketFromHost, Socket* clientSocket, Mutex* lock, ResponseChannel* completions);
+
+	// Add a client whose responses are sent through the host
+	void add(OsSocket::Ref socketFromHost, ResponseChannel* channel);
 
 	void remove(OsSocket::Ref socketFromHost);
 
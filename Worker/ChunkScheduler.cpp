@@ -0,0 +1,95 @@
+#include "ChunkScheduler.h"
+
+constexpr uint32_t ChunkScheduler::RequestsPerChunk;
+
+ChunkScheduler::ChunkScheduler()
+		: mDepth(0), mMaxDepth(0), mChunks(0), mWaitMicros(0), mMaxWaitMicros(0) {
+}
+
+ChunkScheduler::~ChunkScheduler() {
+	clear();
+}
+
+void ChunkScheduler::clear() {
+	for (auto& pair : mTasks) {
+		for (auto task : pair.second) {
+			delete task;
+		}
+	}
+	mTasks.clear();
+	mTurns.clear();
+	mDepth = 0;
+}
+
+void ChunkScheduler::add(ChunkTask* task) {
+	auto& tasks = mTasks[task->connection()];
+	if (tasks.empty()) {
+		mTurns.push_back(task->connection());
+	}
+	task->waitingSince = chrono::steady_clock::now();
+	tasks.push_back(task);
+
+	mDepth++;
+	if (mDepth > mMaxDepth) {
+		mMaxDepth = mDepth;
+	}
+}
+
+ESErrorCode ChunkScheduler::sendNext(ByteBuffer* memory) {
+	if (mTurns.empty()) {
+		return ESERR_NO_ERROR;
+	}
+
+	const auto connection = mTurns.front();
+	mTurns.pop_front();
+	auto it = mTasks.find(connection);
+	auto task = it->second.front();
+
+	const auto now = chrono::steady_clock::now();
+	const uint64_t waited = chrono::duration_cast<chrono::microseconds>(now - task->waitingSince).count();
+	mWaitMicros += waited;
+	if (waited > mMaxWaitMicros) {
+		mMaxWaitMicros = waited;
+	}
+	mChunks++;
+
+	bool done = false;
+	ESErrorCode err = task->sendNext(memory, &done);
+	if (isError(err)) {
+		Log::Write(Log::Warn, "ChunkScheduler | %s (%d)", parseErrorCode(err), err);
+		if (IsErrorButNotFatal(err)) {
+			err = task->sendError(err, memory);
+		}
+		done = true;
+	}
+
+	if (done) {
+		delete task;
+		it->second.pop_front();
+		mDepth--;
+	} else {
+		task->waitingSince = chrono::steady_clock::now();
+	}
+
+	// Let the other connections send a response before this connection sends another one
+	if (it->second.empty()) {
+		mTasks.erase(it);
+	} else {
+		mTurns.push_back(connection);
+	}
+	return err;
+}
+
+void ChunkScheduler::remove(const AttachedConnection* connection) {
+	auto it = mTasks.find(connection);
+	if (it == mTasks.end()) {
+		return;
+	}
+
+	for (auto task : it->second) {
+		delete task;
+		mDepth--;
+	}
+	mTasks.erase(it);
+	mTurns.erase(std::find(mTurns.begin(), mTurns.end(), connection));
+}
@@ -0,0 +1,68 @@
+#ifndef _EVERSTORE_CHUNK_SCHEDULER_H_
+#define _EVERSTORE_CHUNK_SCHEDULER_H_
+
+#include "ChunkTask.h"
+#include <deque>
+#include <algorithm>
+
+//
+// Reads that are sent one response at a time by the worker, in between the other requests. The connections take
+// turns, so that one client reading a large journal doesn't hold back the reads of the other clients. The reads for
+// the same connection are sent in the order they arrived
+class ChunkScheduler
+{
+public:
+	// How many requests the worker can handle before the next response must be sent. The requests are prioritized,
+	// since they are small compared to a large read
+	static constexpr uint32_t RequestsPerChunk = 8;
+
+	ChunkScheduler();
+
+	~ChunkScheduler();
+
+	// Are there any reads waiting to be sent
+	inline bool empty() const { return mDepth == 0; }
+
+	// Add a read. The scheduler takes ownership of the task
+	void add(ChunkTask* task);
+
+	// Send the next response for the connection that's next in turn. A read that fails is removed
+	ESErrorCode sendNext(ByteBuffer* memory);
+
+	// Remove all reads for the supplied connection
+	void remove(const AttachedConnection* connection);
+
+	// Remove all reads
+	void clear();
+
+	// Number of reads waiting to be sent
+	inline uint32_t depth() const { return mDepth; }
+
+	// The largest number of reads that have been waiting at the same time
+	inline uint32_t maxDepth() const { return mMaxDepth; }
+
+	// Number of responses sent
+	inline uint64_t chunks() const { return mChunks; }
+
+	// Total number of microseconds the reads have waited for their turn
+	inline uint64_t waitMicros() const { return mWaitMicros; }
+
+	// The longest time, in microseconds, that a read has waited for its turn
+	inline uint64_t maxWaitMicros() const { return mMaxWaitMicros; }
+
+private:
+	// The connections in the order they are served
+	deque<const AttachedConnection*> mTurns;
+
+	// The reads for each connection
+	unordered_map<const AttachedConnection*, deque<ChunkTask*>> mTasks;
+
+	// Statistics
+	uint32_t mDepth;
+	uint32_t mMaxDepth;
+	uint64_t mChunks;
+	uint64_t mWaitMicros;
+	uint64_t mMaxWaitMicros;
+};
+
+#endif
@@ -0,0 +1,226 @@
+#include "ChunkTask.h"
+
+ChunkTask::ChunkTask(const AttachedConnection* connection, uint32_t requestUID, Journal* journal,
+                     uint32_t maxBufferSize, ProcessID worker)
+		: waitingSince(chrono::steady_clock::now()), mConnection(connection), mRequestUID(requestUID),
+		  mJournal(journal), mMaxBufferSize(maxBufferSize), mWorker(worker) {
+	mJournal->addReader();
+}
+
+ChunkTask::~ChunkTask() {
+	mJournal->removeReader();
+}
+
+ESErrorCode ChunkTask::sendAll(ByteBuffer* memory) {
+	bool done = false;
+	while (!done) {
+		const ESErrorCode err = sendNext(memory, &done);
+		if (isError(err)) {
+			return err;
+		}
+	}
+	return ESERR_NO_ERROR;
+}
+
+ESErrorCode ChunkTask::sendError(ESErrorCode err, ByteBuffer* memory) {
+	memory->reset();
+	const RequestError::Header responseHeader(mRequestUID, mWorker);
+	const RequestError::Response response(err);
+	memory->write(&responseHeader);
+	memory->write(&response);
+	return mConnection->send(memory);
+}
+
+JournalBytesTask::JournalBytesTask(const AttachedConnection* connection, uint32_t requestUID, Journal* journal,
+                                   uint32_t maxBufferSize, ProcessID worker, FileInputStream* stream)
+		: ChunkTask(connection, requestUID, journal, maxBufferSize, worker), mStream(stream) {
+}
+
+JournalBytesTask::~JournalBytesTask() {
+	mStream->close();
+}
+
+ESErrorCode JournalBytesTask::sendNext(ByteBuffer* memory, bool* done) {
+	// The amount of bytes left after the header and the response header is written to buffer
+	const auto BYTES_LEFT_AFTER_HEADERS = mMaxBufferSize - sizeof(ReadJournal::Header) - sizeof(ReadJournal::Response);
+
+	memory->reset();
+	memory->ensureCapacity(mMaxBufferSize);
+	const ReadJournal::Header responseHeader(mRequestUID, ESPROP_NONE, mWorker);
+	memory->write(&responseHeader);
+	memory->allocate<ReadJournal::Response>();
+
+	// Write the journal body without the timestamps
+	uint32_t bytesWritten = 0;
+	const ESErrorCode err = mStream->readJournalBytes(memory, BYTES_LEFT_AFTER_HEADERS, &bytesWritten);
+	if (isError(err)) {
+		return err;
+	}
+
+	// The timestamps are removed while reading, so it's not known if more parts are needed until the part is read
+	*done = mStream->bytesLeft() == 0;
+	auto header = (ReadJournal::Header*) memory->ptr();
+	header->properties = *done ? ESPROP_NONE : ESPROP_MULTIPART;
+	auto response = (ReadJournal::Response*) (memory->ptr() + sizeof(ReadJournal::Header));
+	response->bytes = bytesWritten;
+	return mConnection->send(memory);
+}
+
+JournalFileTask::JournalFileTask(const AttachedConnection* connection, uint32_t requestUID, Journal* journal,
+                                 uint32_t maxBufferSize, ProcessID worker, uint32_t offset, uint32_t size)
+		: ChunkTask(connection, requestUID, journal, maxBufferSize, worker), mOffset(offset),
+		  mSize(size) {
+}
+
+ESErrorCode JournalFileTask::sendNext(ByteBuffer* memory, bool* done) {
+	// The amount of bytes left after the header and the response header is written to buffer
+	const auto BYTES_LEFT_AFTER_HEADERS = mMaxBufferSize - sizeof(ReadJournal::Header) - sizeof(ReadJournal::Response);
+
+	const ESHeaderProperties properties = mSize > BYTES_LEFT_AFTER_HEADERS ? ESPROP_MULTIPART : ESPROP_NONE;
+	const uint32_t sendSize = mSize > BYTES_LEFT_AFTER_HEADERS ? BYTES_LEFT_AFTER_HEADERS : mSize;
+
+	// Only the headers are put in memory. The body is sent from the file cache
+	memory->reset();
+	const ReadJournal::Header responseHeader(mRequestUID, properties, mWorker);
+	memory->write(&responseHeader);
+	auto const response = memory->allocate<ReadJournal::Response>();
+	response->bytes = sendSize;
+
+	const ESErrorCode err = mConnection->sendWithFile(memory, mJournal->file(), mOffset, sendSize);
+	if (isError(err)) {
+		return err;
+	}
+
+	mOffset += sendSize;
+	mSize -= sendSize;
+	*done = mSize == 0;
+	return ESERR_NO_ERROR;
+}
+
+JournalRecordsTask::JournalRecordsTask(const AttachedConnection* connection, uint32_t requestUID, Journal* journal,
+                                       uint32_t maxBufferSize, ProcessID worker, FileInputStream* stream,
+                                       bool includeTimestamp)
+		: ChunkTask(connection, requestUID, journal, maxBufferSize, worker), mStream(stream),
+		  mIncludeTimestamp(includeTimestamp) {
+}
+
+JournalRecordsTask::~JournalRecordsTask() {
+	mStream->close();
+}
+
+ESErrorCode JournalRecordsTask::sendNext(ByteBuffer* memory, bool* done) {
+	// The amount of bytes left after the header and the response header is written to buffer
+	const auto BYTES_LEFT_AFTER_HEADERS = mMaxBufferSize - sizeof(ReadJournal::Header) - sizeof(ReadJournal::Response);
+
+	memory->reset();
+	const ReadJournal::Header responseHeader(mRequestUID, ESPROP_NONE, mWorker);
+	memory->write(&responseHeader);
+	memory->allocate<ReadJournal::Response>();
+
+	uint32_t bytesWritten = 0;
+	const ESErrorCode err = mStream->readRecords(memory, BYTES_LEFT_AFTER_HEADERS, mIncludeTimestamp, &bytesWritten);
+	if (isError(err)) {
+		return err;
+	}
+
+	// The size of the formatted events is not known up front, so the multipart property is set after each part is read
+	*done = mStream->bytesLeft() == 0;
+	auto header = (ReadJournal::Header*) memory->ptr();
+	header->properties = *done ? ESPROP_NONE : ESPROP_MULTIPART;
+	auto response = (ReadJournal::Response*) (memory->ptr() + sizeof(ReadJournal::Header));
+	response->bytes = bytesWritten;
+	return mConnection->send(memory);
+}
+
+JournalEventsTask::JournalEventsTask(const ESHeader* responseHeader, const AttachedConnection* connection,
+                                     Journal* journal, uint32_t maxBufferSize, JournalCursor* cursor,
+                                     bool includeTimestamp, uint32_t eventCount, const char* untilTimestamp,
+                                     uint32_t untilLength)
+		: ChunkTask(connection, responseHeader->requestUID, journal, maxBufferSize, responseHeader->workerId),
+		  mResponseHeader(*responseHeader), mCursor(cursor), mIncludeTimestamp(includeTimestamp),
+		  mEventsLeft(eventCount), mUntilLength(untilTimestamp != nullptr ? untilLength : 0), mNumParts(0), mPart(0),
+		  mFirstEvent(true) {
+	if (mUntilLength > 0) {
+		memcpy(mUntilTimestamp, untilTimestamp, mUntilLength);
+	}
+}
+
+JournalEventsTask::~JournalEventsTask() {
+	delete mCursor;
+}
+
+ESErrorCode JournalEventsTask::sendNext(ByteBuffer* memory, bool* done) {
+	// The amount of bytes left after the header and the response header is written to buffer
+	const auto BYTES_LEFT_AFTER_HEADERS = mMaxBufferSize - sizeof(ESHeader) - sizeof(ReadJournalEvents::Response);
+
+	memory->reset();
+	memory->ensureCapacity(mMaxBufferSize);
+	memory->write(&mResponseHeader);
+	memory->allocate<ReadJournalEvents::Response>();
+	uint32_t bytesWritten = 0;
+	uint32_t eventsWritten = 0;
+
+	*done = false;
+	while (true) {
+		// Take the next event when all parts of the current event are written
+		if (mPart == mNumParts && !nextEvent()) {
+			*done = true;
+			break;
+		}
+
+		// The part is full, but there are more events to send
+		if (bytesWritten == BYTES_LEFT_AFTER_HEADERS) {
+			break;
+		}
+
+		const auto size = mSizes[mPart];
+		const auto bytesToWrite = size > BYTES_LEFT_AFTER_HEADERS - bytesWritten
+		                          ? BYTES_LEFT_AFTER_HEADERS - bytesWritten : size;
+		memory->write(mParts[mPart], bytesToWrite);
+		mParts[mPart] += bytesToWrite;
+		mSizes[mPart] -= bytesToWrite;
+		bytesWritten += bytesToWrite;
+		if (mSizes[mPart] == 0 && ++mPart == mNumParts) {
+			eventsWritten++;
+		}
+	}
+	if (isError(mCursor->error())) {
+		return mCursor->error();
+	}
+
+	auto header = (ESHeader*) memory->ptr();
+	header->properties = *done ? ESPROP_NONE : ESPROP_MULTIPART;
+	auto response = (ReadJournalEvents::Response*) (memory->ptr() + sizeof(ESHeader));
+	response->bytes = bytesWritten;
+	response->eventCount = eventsWritten;
+	return mConnection->send(memory);
+}
+
+bool JournalEventsTask::nextEvent() {
+	if (mEventsLeft == 0 || !mCursor->next()) {
+		return false;
+	}
+	if (mUntilLength > 0 && memcmp(mCursor->timestamp(), mUntilTimestamp, mUntilLength) >= 0) {
+		mEventsLeft = 0;
+		return false;
+	}
+	mEventsLeft--;
+
+	// Events are separated and formatted the same way as when the journal is read
+	mNumParts = 0;
+	mPart = 0;
+	if (!mFirstEvent) {
+		mParts[mNumParts] = &FileUtils::NL;
+		mSizes[mNumParts++] = FileUtils::NL_SIZE;
+	}
+	if (mIncludeTimestamp) {
+		mParts[mNumParts] = mCursor->timestamp();
+		mSizes[mNumParts++] = Timestamp::BytesLength;
+		mParts[mNumParts] = &FileUtils::SPACE;
+		mSizes[mNumParts++] = FileUtils::SPACE_SIZE;
+	}
+	mParts[mNumParts] = mCursor->event();
+	mSizes[mNumParts++] = mCursor->eventLength();
+	mFirstEvent = false;
+	return true;
+}
@@ -0,0 +1,134 @@
+#ifndef _EVERSTORE_CHUNK_TASK_H_
+#define _EVERSTORE_CHUNK_TASK_H_
+
+#include "../Shared/everstore.h"
+#include "AttachedSockets.h"
+
+//
+// A read that's sent to the client one response at a time, so that it can be interleaved with other requests. The
+// journal is kept open until the task is deleted
+class ChunkTask
+{
+public:
+	//
+	// \param connection The client connection
+	// \param requestUID The request the responses belong to. Also used when an error is sent to the client
+	// \param journal The journal that's read
+	// \param maxBufferSize The maximum size of each response, including the headers
+	// \param worker The worker that sends the responses
+	ChunkTask(const AttachedConnection* connection, uint32_t requestUID, Journal* journal, uint32_t maxBufferSize,
+	          ProcessID worker);
+
+	virtual ~ChunkTask();
+
+	//
+	// Send the next response to the client
+	//
+	// \param memory Memory used for the response
+	// \param done Set to true when the last response is sent
+	virtual ESErrorCode sendNext(ByteBuffer* memory, bool* done) = 0;
+
+	//
+	// Send all the responses that are left
+	ESErrorCode sendAll(ByteBuffer* memory);
+
+	//
+	// Tell the client that the request failed
+	ESErrorCode sendError(ESErrorCode err, ByteBuffer* memory);
+
+	inline const AttachedConnection* connection() const { return mConnection; }
+
+	// When the task started to wait for its next turn
+	chrono::steady_clock::time_point waitingSince;
+
+protected:
+	const AttachedConnection* const mConnection;
+	const uint32_t mRequestUID;
+	Journal* const mJournal;
+	const uint32_t mMaxBufferSize;
+	const ProcessID mWorker;
+};
+
+//
+// Reads a version 1 journal without the timestamps
+class JournalBytesTask : public ChunkTask
+{
+public:
+	JournalBytesTask(const AttachedConnection* connection, uint32_t requestUID, Journal* journal,
+	                 uint32_t maxBufferSize, ProcessID worker, FileInputStream* stream);
+
+	~JournalBytesTask() final;
+
+	ESErrorCode sendNext(ByteBuffer* memory, bool* done) final;
+
+private:
+	FileInputStream* const mStream;
+};
+
+//
+// Sends a version 1 journal, including the timestamps, directly from the journal file
+class JournalFileTask : public ChunkTask
+{
+public:
+	JournalFileTask(const AttachedConnection* connection, uint32_t requestUID, Journal* journal,
+	                uint32_t maxBufferSize, ProcessID worker, uint32_t offset, uint32_t size);
+
+	ESErrorCode sendNext(ByteBuffer* memory, bool* done) final;
+
+private:
+	uint32_t mOffset;
+	uint32_t mSize;
+};
+
+//
+// Reads the records in a version 2 journal
+class JournalRecordsTask : public ChunkTask
+{
+public:
+	JournalRecordsTask(const AttachedConnection* connection, uint32_t requestUID, Journal* journal,
+	                   uint32_t maxBufferSize, ProcessID worker, FileInputStream* stream, bool includeTimestamp);
+
+	~JournalRecordsTask() final;
+
+	ESErrorCode sendNext(ByteBuffer* memory, bool* done) final;
+
+private:
+	FileInputStream* const mStream;
+	const bool mIncludeTimestamp;
+};
+
+//
+// Sends the events found by a cursor. Stops after the supplied number of events or at the first event written at,
+// or after, the "until" timestamp (if one is supplied)
+class JournalEventsTask : public ChunkTask
+{
+public:
+	JournalEventsTask(const ESHeader* responseHeader, const AttachedConnection* connection, Journal* journal,
+	                  uint32_t maxBufferSize, JournalCursor* cursor, bool includeTimestamp, uint32_t eventCount,
+	                  const char* untilTimestamp, uint32_t untilLength);
+
+	~JournalEventsTask() final;
+
+	ESErrorCode sendNext(ByteBuffer* memory, bool* done) final;
+
+private:
+	// Move to the next event and split it into the parts that are sent. Returns false if there are no more events
+	bool nextEvent();
+
+private:
+	const ESHeader mResponseHeader;
+	JournalCursor* const mCursor;
+	const bool mIncludeTimestamp;
+	uint32_t mEventsLeft;
+	char mUntilTimestamp[Timestamp::BytesLength];
+	const uint32_t mUntilLength;
+
+	// The parts of the current event: separator, timestamp, space and the event itself
+	const char* mParts[4];
+	uint32_t mSizes[4];
+	uint32_t mNumParts;
+	uint32_t mPart;
+	bool mFirstEvent;
+};
+
+#endif
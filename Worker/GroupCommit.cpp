@@ -0,0 +1,50 @@
+#include "GroupCommit.h"
+
+GroupCommit::GroupCommit(uint32_t windowMicros, uint32_t maxBytes, IoRing* ring)
+		: mWindowMicros(windowMicros), mMaxBytes(maxBytes), mRing(ring), mBytes(0) {
+}
+
+void GroupCommit::add(const StagedCommit& commit, uint32_t stagedBytes) {
+	// The window starts when the first commit arrives
+	if (mCommits.empty()) {
+		mFirstCommit = chrono::steady_clock::now();
+	}
+	mCommits.push_back(commit);
+	mBytes += stagedBytes;
+}
+
+uint32_t GroupCommit::remainingMicros() const {
+	const auto elapsed = chrono::duration_cast<chrono::microseconds>(
+			chrono::steady_clock::now() - mFirstCommit).count();
+	if (elapsed >= mWindowMicros) {
+		return 0u;
+	}
+	return mWindowMicros - (uint32_t) elapsed;
+}
+
+void GroupCommit::flush() {
+	// Each journal is written once, even if it's part of more than one commit in this group
+	mJournals.clear();
+	for (auto& commit : mCommits) {
+		if (commit.journal->hasStagedEvents() &&
+		    std::find(mJournals.begin(), mJournals.end(), commit.journal) == mJournals.end()) {
+			mJournals.push_back(commit.journal);
+		}
+	}
+
+	Journal::flush(mJournals, mRing, &mErrors);
+	for (uint32_t i = 0; i < mJournals.size(); ++i) {
+		if (isError(mErrors[i])) {
+			for (auto& failed : mCommits) {
+				if (failed.journal == mJournals[i]) {
+					failed.error = mErrors[i];
+				}
+			}
+		}
+	}
+}
+
+void GroupCommit::clear() {
+	mCommits.clear();
+	mBytes = 0;
+}
@@ -0,0 +1,76 @@
+#ifndef _EVERSTORE_GROUP_COMMIT_H_
+#define _EVERSTORE_GROUP_COMMIT_H_
+
+#include "../Shared/everstore.h"
+#include "AttachedSockets.h"
+#include "../Shared/File/IoRing.h"
+#include <algorithm>
+
+//
+// A commit that's staged on it's journal. The response is held back until the journal is written to the disk
+struct StagedCommit
+{
+	Journal* journal;
+	const AttachedConnection* connection;
+	uint32_t requestUID;
+
+	// If the commit was successful or if a conflict occurred (TRUE or FALSE)
+	uint32_t success;
+
+	// The size of the journal when this commit is written
+	uint32_t journalSize;
+
+	// Error that occurred when the journal was written
+	ESErrorCode error;
+};
+
+//
+// Collects commits arriving within a short time window so that each journal is only written and flushed once
+// per group
+class GroupCommit
+{
+public:
+	//
+	// \param windowMicros How long the first commit in a group waits for other commits (0 = disabled)
+	// \param maxBytes The group is written immediately when this many bytes are collected
+	// \param ring Used to write all journals in the group at the same time, if available
+	GroupCommit(uint32_t windowMicros, uint32_t maxBytes, IoRing* ring);
+
+	// Is group commit enabled
+	inline bool enabled() const { return mWindowMicros > 0; }
+
+	// Are there any commits waiting to be written
+	inline bool empty() const { return mCommits.empty(); }
+
+	// Has this group collected enough bytes for it to be written immediately
+	inline bool full() const { return mBytes >= mMaxBytes; }
+
+	// Add a commit that's been staged on it's journal
+	void add(const StagedCommit& commit, uint32_t stagedBytes);
+
+	// Retrieves how many microseconds that are left until this group must be written
+	uint32_t remainingMicros() const;
+
+	// Write all staged journals to the disk. Commits for a journal that could not be written are marked with the error
+	void flush();
+
+	// Retrieves all commits in this group
+	inline const vector<StagedCommit>& commits() const { return mCommits; }
+
+	// Remove all commits from this group
+	void clear();
+
+private:
+	const uint32_t mWindowMicros;
+	const uint32_t mMaxBytes;
+	IoRing* const mRing;
+	vector<StagedCommit> mCommits;
+
+	// Memory used when the group is written
+	vector<Journal*> mJournals;
+	vector<ESErrorCode> mErrors;
+	uint32_t mBytes;
+	chrono::steady_clock::time_point mFirstCommit;
+};
+
+#endif
@@ -1,9 +1,9 @@
 #include "Journals.h"
 
 
-Journals::Journals(ProcessID id, uint32_t maxJournalLifeTime)
-		: mChildProcessId(id), mMaxJournalLifeTime(maxJournalLifeTime),
-		  mJournalsToBeRemoved(offsetof(Journal, link)) {
+Journals::Journals(uint32_t maxJournalLifeTime, uint32_t maxOpenJournals, const JournalOptions& options)
+		: mMaxJournalLifeTime(maxJournalLifeTime), mMaxOpenJournals(maxOpenJournals), mOptions(options),
+		  mJournalsToBeRemoved(&Journal::link), mHits(0), mMisses(0), mEvictions(0) {
 	mTimeSinceLastGC = chrono::system_clock::now();
 }
 
@@ -18,14 +18,26 @@ Journal* Journals::getOrCreate(const Path& path) {
 	auto it = mJournals.find(path);
 	Journal* journal = nullptr;
 	if (it == mJournals.end()) {
-		journal = new Journal(path, mChildProcessId);
+		mMisses++;
+
+		// Make room for the new journal directly instead of waiting for the next scheduled garbage collection. This is
+		// done before the journal is added, since it's not in use yet and would otherwise be closed as well
+		if (mMaxOpenJournals > 0 && mJournals.size() >= mMaxOpenJournals) {
+			collect(1u);
+		} else {
+			gcIfDue();
+		}
+
+		journal = new Journal(path, mOptions);
 		mJournals[path] = journal;
 		mJournalsToBeRemoved.addLast(journal);
-		gc();
-	} else {
-		journal = it->second;
-		mJournalsToBeRemoved.moveToLast(journal);
+		journal->refresh();
+		return journal;
 	}
+
+	mHits++;
+	journal = it->second;
+	mJournalsToBeRemoved.moveToLast(journal);
 	journal->refresh();
 	return journal;
 }
@@ -33,9 +45,11 @@ Journal* Journals::getOrCreate(const Path& path) {
 Journal* Journals::getOrNull(const Path& path) {
 	auto it = mJournals.find(path);
 	if (it == mJournals.end()) {
+		mMisses++;
 		return nullptr;
 	}
 
+	mHits++;
 	auto journal = it->second;
 	journal->refresh();
 	mJournalsToBeRemoved.moveToLast(journal);
@@ -43,27 +57,65 @@ Journal* Journals::getOrNull(const Path& path) {
 }
 
 void Journals::gc() {
-	Log::Write(Log::Debug, "Garbage collecting journals");
-	// Ignore if nothing is removable
-	if (mJournalsToBeRemoved.empty()) return;
+	collect(0u);
+}
 
-	// Ignore if not over one minute since last GC
+void Journals::collect(uint32_t reserved) {
+	Log::Write(Log::Debug, "Garbage collecting journals");
 	const auto now = chrono::system_clock::now();
-	const auto timeSinceLastGC = chrono::duration_cast<chrono::seconds>(now - mTimeSinceLastGC).count();
-	if (timeSinceLastGC < mMaxJournalLifeTime) return;
 	mTimeSinceLastGC = now;
 
+	// The least recently used journals are first in the list
 	Journal* journal = mJournalsToBeRemoved.first();
 	while (journal != nullptr) {
 		Journal* next = journal->link.tail;
+		const bool overCapacity = mMaxOpenJournals > 0 && mJournals.size() + reserved > mMaxOpenJournals;
 		const auto duration = chrono::duration_cast<chrono::seconds>(now - journal->timeSinceLastUsed()).count();
-		if (duration < mMaxJournalLifeTime)
+		if (!overCapacity && duration < mMaxJournalLifeTime)
 			break;
 
-		Log::Write(Log::Debug, "Destroing journal");
-		auto it = mJournals.find(journal->path());
-		mJournals.erase(it);
-		delete journal;
+		// Journals that are in use are kept open, even if there are too many open journals
+		if (!journal->hasOpenTransactions() && !journal->hasStagedEvents() && !journal->hasReaders()) {
+			if (duration < mMaxJournalLifeTime) {
+				mEvictions++;
+			}
+			close(journal);
+		}
 		journal = next;
 	}
+
+	Log::Write(Log::Debug, "Journals | open: %d, hits: %llu, misses: %llu, evictions: %llu", size(),
+	           (unsigned long long) mHits, (unsigned long long) mMisses, (unsigned long long) mEvictions);
+}
+
+void Journals::gcIfDue() {
+	// Ignore if nothing is removable
+	if (mJournalsToBeRemoved.empty()) return;
+
+	// Ignore if not over the journal life-time since last GC
+	const auto now = chrono::system_clock::now();
+	const auto timeSinceLastGC = chrono::duration_cast<chrono::seconds>(now - mTimeSinceLastGC).count();
+	if (timeSinceLastGC < mMaxJournalLifeTime) return;
+	gc();
+}
+
+uint32_t Journals::remainingMicros() const {
+	if (mJournalsToBeRemoved.empty()) {
+		return UINT32_MAX;
+	}
+
+	const auto now = chrono::system_clock::now();
+	const auto nextGC = mTimeSinceLastGC + chrono::seconds(mMaxJournalLifeTime);
+	if (now >= nextGC) {
+		return 0u;
+	}
+	const auto micros = chrono::duration_cast<chrono::microseconds>(nextGC - now).count();
+	return micros >= UINT32_MAX ? UINT32_MAX - 1 : (uint32_t) micros;
+}
+
+void Journals::close(Journal* journal) {
+	Log::Write(Log::Debug, "Destroing journal");
+	auto it = mJournals.find(journal->path());
+	mJournals.erase(it);
+	delete journal;
 }
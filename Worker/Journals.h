@@ -5,11 +5,12 @@
 #include "../Shared/File/Path.hpp"
 
 //
-// Map managing any open journals
+// Map managing any open journals. The journals are kept in the order they were last used, so that the least
+// recently used journals are closed first when too many journals are open
 class Journals
 {
 public:
-	Journals(ProcessID id, uint32_t maxJournalLifeTime);
+	Journals(uint32_t maxJournalLifeTime, uint32_t maxOpenJournals, const JournalOptions& options);
 
 	~Journals();
 
@@ -21,18 +22,52 @@ public:
 	Journal* getOrNull(const Path& path);
 
 	//
-	// Look for journals that's reacently been closed and remove them if they are old enough
+	// Close the journals that's not been used within their life-time and the least recently used journals if too many
+	// journals are open. Journals with open transactions, staged commits or reads in progress are never closed
 	void gc();
 
+	//
+	// Run the garbage collection if it's more than the journal life-time since it was last run
+	void gcIfDue();
+
+	//
+	// Retrieves how many microseconds until the next garbage collection is due. UINT32_MAX if no journals are open
+	uint32_t remainingMicros() const;
+
+	// Number of open journals
+	inline uint32_t size() const { return mJournals.size(); }
+
+	// Number of lookups that found an open journal
+	inline uint64_t hits() const { return mHits; }
+
+	// Number of lookups where the journal had to be opened, or was not open
+	inline uint64_t misses() const { return mMisses; }
+
+	// Number of journals closed because too many journals were open
+	inline uint64_t evictions() const { return mEvictions; }
+
+private:
+	// Close the journals like gc does, but also make room for the supplied number of journals that are about to be
+	// opened
+	void collect(uint32_t reserved);
+
+	// Close the supplied journal
+	void close(Journal* journal);
+
 private:
-	const ProcessID mChildProcessId;
 	const uint32_t mMaxJournalLifeTime;
+	const uint32_t mMaxOpenJournals;
+	const JournalOptions mOptions;
 	unordered_map<Path, Journal*> mJournals;
 
 	// GC
 	LinkedList<Journal> mJournalsToBeRemoved;
 	chrono::system_clock::time_point mTimeSinceLastGC;
 
+	// Statistics
+	uint64_t mHits;
+	uint64_t mMisses;
+	uint64_t mEvictions;
 };
 
 #endif
@@ -0,0 +1,112 @@
+#include "MultipartCommits.h"
+
+void MultipartCommit::append(const char* bytes, uint32_t size) {
+	if (isError(error)) {
+		return;
+	}
+	if (size > eventsSize - eventsReceived()) {
+		error = ESERR_JOURNAL_COMMIT_INCOMPLETE;
+		return;
+	}
+	if (size > 0) {
+		events->write(bytes, size);
+	}
+}
+
+void MultipartCommit::fail(ESErrorCode err) {
+	if (!isError(error)) {
+		error = err;
+	}
+}
+
+ESErrorCode MultipartCommit::result() const {
+	if (!isError(error) && eventsReceived() != eventsSize) {
+		return ESERR_JOURNAL_COMMIT_INCOMPLETE;
+	}
+	return error;
+}
+
+MultipartCommits::MultipartCommits(uint32_t maxBytes)
+		: mMaxBytes(maxBytes) {
+}
+
+MultipartCommits::~MultipartCommits() {
+	clear();
+}
+
+MultipartCommit* MultipartCommits::get(const AttachedConnection* connection, uint32_t requestUID) {
+	auto it = mConnections.find(connection);
+	if (it == mConnections.end()) {
+		return nullptr;
+	}
+	auto commit = it->second.commits.find(requestUID);
+	if (commit == it->second.commits.end()) {
+		return nullptr;
+	}
+	return commit->second;
+}
+
+MultipartCommit* MultipartCommits::start(const AttachedConnection* connection, uint32_t requestUID,
+                                         uint32_t eventsSize) {
+	auto& state = mConnections[connection];
+	auto const commit = new MultipartCommit();
+	commit->transactionUID = 0;
+	commit->eventsSize = eventsSize;
+	commit->events = nullptr;
+	commit->error = ESERR_NO_ERROR;
+	if (eventsSize > mMaxBytes - state.bytes) {
+		commit->error = ESERR_JOURNAL_COMMIT_TOO_LARGE;
+	} else {
+		state.bytes += eventsSize;
+		if (eventsSize > 0) {
+			commit->events = new ByteBuffer(eventsSize);
+		}
+	}
+	state.commits[requestUID] = commit;
+	return commit;
+}
+
+void MultipartCommits::remove(const AttachedConnection* connection, uint32_t requestUID) {
+	auto it = mConnections.find(connection);
+	if (it == mConnections.end()) {
+		return;
+	}
+	auto& state = it->second;
+	auto commit = state.commits.find(requestUID);
+	if (commit == state.commits.end()) {
+		return;
+	}
+
+	// Only the commits that were not too large reserved their bytes
+	if (commit->second->error != ESERR_JOURNAL_COMMIT_TOO_LARGE) {
+		state.bytes -= commit->second->eventsSize;
+	}
+	delete commit->second->events;
+	delete commit->second;
+	state.commits.erase(commit);
+	if (state.commits.empty()) {
+		mConnections.erase(it);
+	}
+}
+
+void MultipartCommits::remove(const AttachedConnection* connection) {
+	auto it = mConnections.find(connection);
+	if (it == mConnections.end()) {
+		return;
+	}
+	for (auto& pair : it->second.commits) {
+		delete pair.second->events;
+		delete pair.second;
+	}
+	mConnections.erase(it);
+}
+
+void MultipartCommits::clear() {
+	for (auto& connection : mConnections) {
+		for (auto& pair : connection.second.commits) {
+			delete pair.second->events;
+			delete pair.second;
+		}
+	}
+	mConnections.clear();
+}
@@ -0,0 +1,86 @@
+#ifndef _EVERSTORE_MULTIPART_COMMITS_H_
+#define _EVERSTORE_MULTIPART_COMMITS_H_
+
+#include "../Shared/everstore.h"
+#include "AttachedSockets.h"
+
+//
+// A commit that's sent in many parts. The events are collected until the last part has arrived, and then the commit
+// is made as if it was sent as one request
+struct MultipartCommit
+{
+	Path journalName;
+	TypeSet types;
+	uint32_t transactionUID;
+
+	// The size of all events in the commit
+	uint32_t eventsSize;
+
+	// The events that have arrived. Allocated up front, since the memory is already reserved for the commit
+	ByteBuffer* events;
+
+	// The first error that occurred. The parts that arrive after an error are skipped
+	ESErrorCode error;
+
+	// Add the next part of the events
+	void append(const char* bytes, uint32_t size);
+
+	// Fail the commit with the supplied error, unless it has already failed
+	void fail(ESErrorCode err);
+
+	// Have all events arrived
+	inline bool complete() const { return isError(error) || eventsReceived() == eventsSize; }
+
+	// The error the commit fails with when its last part has arrived. ESERR_JOURNAL_COMMIT_INCOMPLETE if some of
+	// the events never arrived
+	ESErrorCode result() const;
+
+	// The number of event bytes that have arrived
+	inline uint32_t eventsReceived() const { return events != nullptr ? events->offset() : 0; }
+};
+
+//
+// The commits that are being sent in many parts, for each connection. A commit is found by the id of its request.
+// The unfinished commits from a connection can't reserve more than maxBytes bytes together
+class MultipartCommits
+{
+public:
+	explicit MultipartCommits(uint32_t maxBytes);
+
+	~MultipartCommits();
+
+	//
+	// Find an unfinished commit
+	//
+	// \return The commit; nullptr if no commit with the supplied request id is being sent by the connection
+	MultipartCommit* get(const AttachedConnection* connection, uint32_t requestUID);
+
+	//
+	// Start a new commit. The commit is failed with ESERR_JOURNAL_COMMIT_TOO_LARGE if it would make the connection
+	// reserve more than maxBytes bytes. A failed commit is still added, so that its parts can be skipped
+	MultipartCommit* start(const AttachedConnection* connection, uint32_t requestUID, uint32_t eventsSize);
+
+	// Remove a commit when its last part has arrived
+	void remove(const AttachedConnection* connection, uint32_t requestUID);
+
+	// Remove all commits for the supplied connection
+	void remove(const AttachedConnection* connection);
+
+	// Remove all commits
+	void clear();
+
+private:
+	struct Connection
+	{
+		Connection() : bytes(0) {}
+
+		// The number of bytes reserved by the commits
+		uint32_t bytes;
+		unordered_map<uint32_t, MultipartCommit*> commits;
+	};
+
+	const uint32_t mMaxBytes;
+	unordered_map<const AttachedConnection*, Connection> mConnections;
+};
+
+#endif
@@ -0,0 +1,93 @@
+#include "ReaderPool.h"
+
+ReaderPool::ReaderPool(uint32_t numThreads, uint32_t bufferSize)
+		: mNumThreads(numThreads), mBufferSize(bufferSize), mStopped(false) {
+}
+
+ReaderPool::~ReaderPool() {
+	stop();
+}
+
+void ReaderPool::start() {
+	mStopped = false;
+	for (uint32_t i = 0; i < mNumThreads; ++i) {
+		mThreads.push_back(thread(&ReaderPool::run, this));
+	}
+}
+
+void ReaderPool::stop() {
+	{
+		unique_lock<mutex> l(mLock);
+		mStopped = true;
+	}
+	mJobAdded.notify_all();
+	for (auto& t : mThreads) {
+		t.join();
+	}
+	mThreads.clear();
+
+	// Skip the reads that have not been started
+	for (auto task : mTasks) {
+		delete task;
+	}
+	mTasks.clear();
+}
+
+void ReaderPool::add(ChunkTask* task) {
+	{
+		unique_lock<mutex> l(mLock);
+		mTasks.push_back(task);
+	}
+	mJobAdded.notify_one();
+}
+
+void ReaderPool::waitFor(const AttachedConnection* connection) {
+	unique_lock<mutex> l(mLock);
+	while (isReading(connection)) {
+		mJobDone.wait(l);
+	}
+}
+
+void ReaderPool::run() {
+	ByteBuffer memory(mBufferSize);
+	while (true) {
+		ChunkTask* task;
+		{
+			unique_lock<mutex> l(mLock);
+			while (!mStopped && mTasks.empty()) {
+				mJobAdded.wait(l);
+			}
+			if (mStopped) {
+				return;
+			}
+			task = mTasks.front();
+			mTasks.pop_front();
+			mReading.push_back(task->connection());
+		}
+
+		const auto connection = task->connection();
+		ESErrorCode err = task->sendAll(&memory);
+		if (isError(err)) {
+			Log::Write(Log::Warn, "ReaderPool | %s (%d)", parseErrorCode(err), err);
+			if (IsErrorButNotFatal(err)) {
+				task->sendError(err, &memory);
+			}
+		}
+		delete task;
+
+		{
+			unique_lock<mutex> l(mLock);
+			mReading.erase(std::find(mReading.begin(), mReading.end(), connection));
+		}
+		mJobDone.notify_all();
+	}
+}
+
+bool ReaderPool::isReading(const AttachedConnection* connection) const {
+	for (auto task : mTasks) {
+		if (task->connection() == connection) {
+			return true;
+		}
+	}
+	return std::find(mReading.begin(), mReading.end(), connection) != mReading.end();
+}
@@ -0,0 +1,55 @@
+#ifndef _EVERSTORE_READER_POOL_H_
+#define _EVERSTORE_READER_POOL_H_
+
+#include "../Shared/everstore.h"
+#include "ChunkTask.h"
+#include <condition_variable>
+#include <deque>
+#include <algorithm>
+
+//
+// Threads that read journals and send them to the clients, so that large reads don't hold back the commits
+// handled by the worker
+class ReaderPool
+{
+public:
+	ReaderPool(uint32_t numThreads, uint32_t bufferSize);
+
+	~ReaderPool();
+
+	// Start the reader threads
+	void start();
+
+	// Stop the reader threads. Reads that have not been started are skipped
+	void stop();
+
+	// Are there any reader threads
+	inline bool enabled() const { return mNumThreads > 0; }
+
+	// Add a read. The pool takes ownership of the task and deletes it when all responses are sent
+	void add(ChunkTask* task);
+
+	// Wait until all reads for the supplied connection are done
+	void waitFor(const AttachedConnection* connection);
+
+private:
+	// Take and serve reads until the pool is stopped
+	void run();
+
+	// Is there a read for the supplied connection that's waiting or in progress
+	bool isReading(const AttachedConnection* connection) const;
+
+private:
+	const uint32_t mNumThreads;
+	const uint32_t mBufferSize;
+	vector<thread> mThreads;
+
+	mutex mLock;
+	condition_variable mJobAdded;
+	condition_variable mJobDone;
+	deque<ChunkTask*> mTasks;
+	vector<const AttachedConnection*> mReading;
+	bool mStopped;
+};
+
+#endif
@@ -0,0 +1,66 @@
+#include "ResponseChannel.h"
+
+constexpr uint32_t ResponseChannel::MaxPartSize;
+
+ResponseChannel::ResponseChannel()
+		: mChild(nullptr) {
+}
+
+ESErrorCode ResponseChannel::send(int32_t client, const ByteBuffer* memory) {
+	lock_guard<mutex> l(mLock);
+	addParts(client, memory->ptr(), memory->offset(), true, completesRequest(memory) ? 1 : 0);
+	return flush();
+}
+
+ESErrorCode ResponseChannel::complete(int32_t client) {
+	lock_guard<mutex> l(mLock);
+	mHeaders.push_back({client, 0, 1, 1});
+	mParts.push_back({(const char*) &mHeaders.back(), sizeof(IpcResponse)});
+	return flush();
+}
+
+bool ResponseChannel::completesRequest(const ByteBuffer* memory) {
+	const auto header = (const ESHeader*) memory->ptr();
+	return (header->properties & ESPROP_MULTIPART) == 0;
+}
+
+ESErrorCode ResponseChannel::sendWithFile(int32_t client, const ByteBuffer* memory, FILE* file, uint32_t offset,
+                                          uint32_t size) {
+	lock_guard<mutex> l(mLock);
+	mFileBytes.resize(size);
+	if (size > 0 && !FileUtils::readAt(file, offset, mFileBytes.data(), size)) {
+		return ESERR_SOCKET_SEND;
+	}
+
+	const uint16_t completed = completesRequest(memory) ? 1 : 0;
+	addParts(client, memory->ptr(), memory->offset(), size == 0, completed);
+	addParts(client, mFileBytes.data(), size, true, completed);
+	return flush();
+}
+
+void ResponseChannel::addParts(int32_t client, const char* bytes, uint32_t size, bool last, uint16_t completed) {
+	while (size > 0) {
+		const uint32_t partSize = size > MaxPartSize ? MaxPartSize : size;
+		const bool lastPart = last && partSize == size;
+		mHeaders.push_back({client, partSize, (uint16_t) (lastPart ? 1 : 0), (uint16_t) (lastPart ? completed : 0)});
+		mParts.push_back({(const char*) &mHeaders.back(), sizeof(IpcResponse)});
+		mParts.push_back({bytes, partSize});
+		bytes += partSize;
+		size -= partSize;
+	}
+}
+
+ESErrorCode ResponseChannel::flush() {
+	ESErrorCode err = ESERR_NO_ERROR;
+	if (mChild == nullptr) {
+		err = ESERR_SOCKET_NOT_ATTACHED;
+	} else if (!mParts.empty()) {
+		err = mChild->sendToHost(mParts.data(), mParts.size());
+	}
+	mParts.clear();
+	mHeaders.clear();
+	if (isError(err)) {
+		return ESERR_SOCKET_SEND;
+	}
+	return err;
+}
@@ -0,0 +1,59 @@
+#ifndef _EVERSTORE_RESPONSE_CHANNEL_H_
+#define _EVERSTORE_RESPONSE_CHANNEL_H_
+
+#include "../Shared/everstore.h"
+#include "../Shared/Ipc/IpcChild.h"
+
+//
+// Sends the responses back to the host, which writes them to the clients. Used instead of the client sockets when
+// the sockets are not shared with the worker. Otherwise only used for telling the host when requests are completed, if
+// the number of requests in flight is limited. Can be used by the worker and the reader threads at the same time
+class ResponseChannel
+{
+public:
+	// The largest number of bytes sent to the host with one response header. Larger responses are split up
+	static constexpr uint32_t MaxPartSize = 64 * 1024;
+
+	ResponseChannel();
+
+	// Start sending the responses using the supplied channel to the host
+	inline void attach(IpcChild* child) { mChild = child; }
+
+	// Is the channel attached to the host
+	inline bool attached() const { return mChild != nullptr; }
+
+	// Send the supplied memory block to the client
+	ESErrorCode send(int32_t client, const ByteBuffer* memory);
+
+	// Tell the host that a request from the client is completed. Used when the response is sent directly to the client
+	ESErrorCode complete(int32_t client);
+
+	// Is the response in the supplied memory block the last response to its request
+	static bool completesRequest(const ByteBuffer* memory);
+
+	//
+	// Send the supplied memory block followed by a part of a file, without any other response to the same client in
+	// between. The part of the file is read into memory, since the host can't read the worker's files
+	ESErrorCode sendWithFile(int32_t client, const ByteBuffer* memory, FILE* file, uint32_t offset, uint32_t size);
+
+private:
+	// Add the supplied bytes to the parts sent to the host. The response is ended by the last part if last is true
+	void addParts(int32_t client, const char* bytes, uint32_t size, bool last, uint16_t completed);
+
+	// Send the added parts to the host
+	ESErrorCode flush();
+
+private:
+	IpcChild* mChild;
+	mutex mLock;
+
+	// The parts sent to the host with one write. The headers are kept in a deque, so that they are not moved when
+	// more headers are added
+	vector<SharedRing::Part> mParts;
+	deque<IpcResponse> mHeaders;
+
+	// The part of a file that's being sent
+	vector<char> mFileBytes;
+};
+
+#endif
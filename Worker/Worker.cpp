@@ -6,10 +6,37 @@
 #include "../Shared/File/Path.hpp"
 #include "../Shared/Socket/Socket.hpp"
 
+constexpr uint32_t Worker::TransactionTickMillis;
+
+// The current tick of the transaction timers
+static uint64_t transactionTick() {
+	const auto millis = chrono::duration_cast<chrono::milliseconds>(
+			chrono::steady_clock::now().time_since_epoch()).count();
+	return (uint64_t) millis / Worker::TransactionTickMillis;
+}
+
+// The settings for the journals opened by a worker
+static JournalOptions journalOptions(const Config& config, RecoveryLog* recoveryLog, Durability* durability) {
+	JournalOptions options;
+	options.recoveryLog = recoveryLog;
+	options.durability = durability;
+	options.format = config.journalFormat;
+	options.mmapReadMinBytes = config.mmapReadMinBytes;
+	return options;
+}
+
 Worker::Worker(ProcessID id, const Config& config)
-		: mId(id), mIpcChild(nullptr), mJournals(id, config.maxJournalLifeTime),
-		  mNextTransactionTypeBit(1),
-		  mConfig(config) {
+		: mId(id), mIpcChild(nullptr), mIoRing(config.ioUringEntries),
+		  mDurability(config.durability, config.durabilityIntervalMillis, &mIoRing),
+		  mJournals(config.maxJournalLifeTime, config.maxOpenJournals,
+		            journalOptions(config, &mRecoveryLog, &mDurability)),
+		  mGroupCommit(config.durability == Durability::Group && config.groupCommitMicros == 0
+		               ? DEFAULT_DURABILITY_GROUP_MICROS : config.groupCommitMicros, config.groupCommitMaxBytes,
+		               &mIoRing),
+		  mReaderPool(config.readerThreads, config.maxBufferSize), mMultipartCommits(config.maxCommitSize),
+		  mRequestsSinceChunk(0),
+		  mTransactionTimers(&Transaction::expiryLink, transactionTick()), mExpiredTransactions(0),
+		  mLastStatistics(chrono::steady_clock::now()), mConfig(config) {
 }
 
 Worker::~Worker() {
@@ -36,6 +63,29 @@ ESErrorCode Worker::start() {
 	// Memory for this worker
 	ByteBuffer memory(mConfig.maxBufferSize);
 	while (mRunning.load() && !isErrorCodeFatal(err)) {
+		// Run the scheduled tasks if they are due before the host sends more data
+		const auto micros = nextScheduledTaskMicros();
+		if (micros == 0) {
+			runScheduledTasks();
+			continue;
+		}
+
+		// Send the next part of an unfinished read when the host has nothing to send, or when enough requests have
+		// been handled since the last part was sent
+		if (!mChunkScheduler.empty()) {
+			if (mRequestsSinceChunk >= ChunkScheduler::RequestsPerChunk || !mIpcChild->waitForData(0)) {
+				err = mChunkScheduler.sendNext(&memory);
+				mRequestsSinceChunk = 0;
+				if (IsErrorButNotFatal(err)) {
+					Log::Write(Log::Warn, "Worker(%p) | %s (%d)", this, parseErrorCode(err), err);
+				}
+				continue;
+			}
+		} else if (micros != UINT32_MAX && !mIpcChild->waitForData(micros)) {
+			runScheduledTasks();
+			continue;
+		}
+
 		// Load the next data block to be processed from the host
 		ESHeader* header = loadHeaderFromHost(&memory);
 		Log::Write(Log::Debug3, "Worker(%p) | Received %s from SOCKET(%d)", this, parseRequestType(header->type),
@@ -47,6 +97,13 @@ ESErrorCode Worker::start() {
 
 		// Get the request type
 		const ESRequestType type = header->type;
+		const uint32_t requestUID = header->requestUID;
+		mRequestsSinceChunk++;
+
+		// Any other request must be able to observe the staged commits, so make sure that they are written first
+		if (type != REQ_COMMIT_TRANSACTION) {
+			flushGroupCommit();
+		}
 
 		// Process internal messages in a special way
 		if (isInternalRequestType(type)) {
@@ -55,10 +112,16 @@ ESErrorCode Worker::start() {
 		}
 
 		const AttachedConnection* attachedSocket = mAttachedSockets.get(header->client);
-		if (attachedSocket->socket != nullptr && attachedSocket->lock != nullptr) {
+		if (attachedSocket->attached()) {
 			err = handleMessage(header, attachedSocket, &memory);
 		} else {
 			err = ESERR_SOCKET_NOT_ATTACHED;
+
+			// The host still counts the request as being in flight, unless it's a part of a request that's sent in many
+			// parts. Such a request is only counted by its last part
+			if (mResponseChannel.attached() && !Bits::IsSet(header->properties, ESPROP_MULTIPART)) {
+				mResponseChannel.complete(header->client);
+			}
 		}
 
 		// If the error is not fatal then log it, send it to the client and
@@ -71,8 +134,8 @@ ESErrorCode Worker::start() {
 				// Reset memory
 				memory.reset();
 
-				// Create response header
-				const RequestError::Header responseHeader(type, id());
+				// Create response header. The client finds the failed request by its id
+				const RequestError::Header responseHeader(requestUID, id());
 				const RequestError::Response response(err);
 				memory.write(&responseHeader);
 				memory.write(&response);
@@ -87,6 +150,7 @@ ESErrorCode Worker::start() {
 		}
 	}
 
+	flushGroupCommit();
 	release();
 	return err;
 }
@@ -98,17 +162,7 @@ void Worker::stop() {
 ESErrorCode Worker::sendBytesToClient(const AttachedConnection* connection, const ByteBuffer* memory) {
 	assert(connection != nullptr);
 	assert(memory != nullptr);
-
-	// The current offset indicates how much memory we've written to the memory
-	const uint32_t size = memory->offset();
-
-	connection->lock->Lock();
-	const uint32_t recv = connection->socket->SendAll(memory->ptr(), size);
-	connection->lock->Unlock();
-
-	// Verify that we've sent all the data to the client
-	if (recv != size) return ESERR_SOCKET_SEND;
-	return ESERR_NO_ERROR;
+	return connection->send(memory);
 }
 
 ESErrorCode Worker::initialize() {
@@ -124,6 +178,25 @@ ESErrorCode Worker::initialize() {
 		return ESERR_PROCESS_CREATE_CHILD;
 	}
 	mIpcChild = new IpcChild(mId, process);
+	ESErrorCode err = mIpcChild->attachRing();
+	if (isError(err)) {
+		return err;
+	}
+	if (mIpcChild->usesRing()) {
+		Log::Write(Log::Info, "Worker(%p) | Receiving requests over shared memory", this);
+	}
+	if (mConfig.serverResponses != 0 || mConfig.maxPipelinedRequests > 0) {
+		err = mIpcChild->attachResponseRing();
+		if (isError(err)) {
+			return err;
+		}
+		mResponseChannel.attach(mIpcChild);
+		if (mConfig.serverResponses != 0) {
+			Log::Write(Log::Info, "Worker(%p) | Sending responses to the clients through the host", this);
+		} else {
+			Log::Write(Log::Info, "Worker(%p) | Telling the host when requests are completed", this);
+		}
+	}
 
 	const auto path = mConfig.rootDir + mConfig.journalDir;
 	Log::Write(Log::Info, "Worker(%p) | Changing working directory to: %s", this, path.value.c_str());
@@ -131,11 +204,27 @@ ESErrorCode Worker::initialize() {
 		return ESERR_FILESYSTEM_CHANGEPATH;
 	}
 
+	Log::Write(Log::Info, "Worker(%p) | Opening recovery log", this);
+	if (!mRecoveryLog.open(RecoveryLog::forWorker(mId))) {
+		return ESERR_RECOVERY_LOG_OPEN;
+	}
+
 	Log::Write(Log::Info, "Worker(%p) | Preparing built-in transaction types", this);
-	vector<string> types;
-	types.push_back(Bits::BuiltIn::NewJournalKey);
-	auto mask = transactionTypes(types);
-	assert(mask == Bits::BuiltIn::NewJournalBit);
+	const auto& newJournal = Bits::BuiltIn::NewJournalKey;
+	const auto builtIn = mTypes.intern(newJournal.c_str(), (uint32_t) newJournal.length());
+	assert(builtIn == TypeSet::NewJournal);
+
+	if (mConfig.ioUringEntries > 0) {
+		if (mIoRing.available()) {
+			Log::Write(Log::Info, "Worker(%p) | Submitting up to %d journal operations at a time with io_uring", this,
+			           mIoRing.capacity());
+		} else {
+			Log::Write(Log::Warn, "Worker(%p) | io_uring is not available. Journals are written one at a time", this);
+		}
+	}
+
+	Log::Write(Log::Info, "Worker(%p) | Starting %d reader threads", this, mConfig.readerThreads);
+	mReaderPool.start();
 
 	Log::Write(Log::Info, "Worker(%p) | Initialization complete", this);
 	mRunning = true;
@@ -143,28 +232,21 @@ ESErrorCode Worker::initialize() {
 }
 
 void Worker::release() {
+	logStatistics();
 	if (mIpcChild != nullptr) {
 		mIpcChild->close();
 	}
+	mReaderPool.stop();
+	mChunkScheduler.clear();
+	mMultipartCommits.clear();
 	mAttachedSockets.clear();
+	mRecoveryLog.close();
 	Socket::Shutdown();
 }
 
 bool Worker::performConsistencyCheck() {
 	Log::Write(Log::Info, "Worker(%p) | Performing consistency check for journals", this);
-	const string lockSuffix(string(".log.") + id().ToString() + string(".lock"));
-	auto files = FileUtils::findFilesEndingWith(mConfig.journalDir.value, lockSuffix);
-	for (auto& file : files) {
-		const Path journalFile = Path(file.substr(0, file.length() - lockSuffix.length()));
-		Log::Write(Log::Info, "Worker(%p) | Validating consistency for journal: %s", this, journalFile.value.c_str());
-		Journal j(journalFile, id());
-		if (!j.performConsistencyCheck()) {
-			Log::Write(Log::Error, "Worker(%p) | Consistency check failed for file: %s", this,
-			           journalFile.value.c_str());
-			return false;
-		}
-	}
-	return true;
+	return RecoveryLog::replay(mConfig.journalDir + RecoveryLog::forWorker(id()), mConfig.journalDir);
 }
 
 ESErrorCode Worker::handleHostMessage(const ESHeader* header) {
@@ -200,6 +282,15 @@ ESErrorCode Worker::handleMessage(ESHeader* header, const AttachedConnection* co
 		case REQ_JOURNAL_EXISTS:
 			err = checkIfJournalExists(header, connection, memory);
 			break;
+		case REQ_READ_JOURNAL_EVENTS:
+			err = readJournalEvents(header, connection, memory);
+			break;
+		case REQ_READ_JOURNAL_RANGE:
+			err = readJournalRange(header, connection, memory);
+			break;
+		case REQ_REGISTER_TYPES:
+			err = registerTypes(header, connection, memory);
+			break;
 		default:
 			break;
 	}
@@ -209,6 +300,12 @@ ESErrorCode Worker::handleMessage(ESHeader* header, const AttachedConnection* co
 
 ESErrorCode Worker::newConnection(const ESHeader* header) {
 	Log::Write(Log::Debug, "Worker(%p) | A new connection has been established for SOCKET(%p)", this, header->client);
+	if (mConfig.serverResponses != 0) {
+		// The host doesn't share the socket. The responses are sent back to the host instead
+		mAttachedSockets.add(header->client, &mResponseChannel);
+		return ESERR_NO_ERROR;
+	}
+
 	auto const newSocket = Socket::LoadFromProcess(process(), mConfig.maxBufferSize);
 	if (!newSocket) {
 		Log::Write(Log::Error, "Failed to attach socket to this process");
@@ -218,18 +315,27 @@ ESErrorCode Worker::newConnection(const ESHeader* header) {
 	Log::Write(Log::Debug, "Worker(%p) | Fetching mutex associated with SOCKET(%p)", this, header->client);
 	auto const m = Mutex::LoadFromProcess(process());
 	if (!m) {
-		Log::Write(Log::Error, "Failed to attach mutex to this process");
-		return ESERR_MUTEX_ATTACH;
+		// The server removes the mutex when the client disconnects, which might happen before this worker has
+		// caught up with the connection
+		Log::Write(Log::Warn, "Worker(%p) | Failed to attach mutex for SOCKET(%d). The client might have disconnected",
+		           this, header->client);
+		delete newSocket;
+		return ESERR_SOCKET_NOT_ATTACHED;
 	}
 
 	Log::Write(Log::Debug, "Worker(%p) | Associating SOCKET(%p) with Mutex(%p)", this, header->client, m);
-	mAttachedSockets.add(header->client, newSocket, m);
+	mAttachedSockets.add(header->client, newSocket, m, mResponseChannel.attached() ? &mResponseChannel : nullptr);
 	Log::Write(Log::Info, "Worker(%p) | New SOCKET(%d) mapped to Socket(%p) on child process", this, header->client,
 	           newSocket);
 	return ESERR_NO_ERROR;
 }
 
 ESErrorCode Worker::closeConnection(const ESHeader* header) {
+	// The reader threads might still be sending to the connection. Reads that are not finished are skipped
+	const auto connection = mAttachedSockets.get(header->client);
+	mReaderPool.waitFor(connection);
+	mChunkScheduler.remove(connection);
+	mMultipartCommits.remove(connection);
 	mAttachedSockets.remove(header->client);
 	Log::Write(Log::Info, "Worker(%p) | SOCKET(%d) unmapped from child process", this, header->client);
 	return ESERR_NO_ERROR;
@@ -253,6 +359,14 @@ ESErrorCode Worker::newTransaction(const ESHeader* header, const AttachedConnect
 		return ESERR_JOURNAL_PATH_INVALID;
 	}
 
+	// Expire the transaction if it's not committed or rolled back in time. The timers are brought up to date first,
+	// since they are not moved forward while no transaction is waiting to expire
+	if (mConfig.transactionTimeoutMillis > 0) {
+		expireTransactions();
+		const uint64_t ticks = (mConfig.transactionTimeoutMillis + TransactionTickMillis - 1) / TransactionTickMillis;
+		mTransactionTimers.add(journal->transaction(transaction), mTransactionTimers.tick() + ticks);
+	}
+
 	// Write the response
 	const NewTransaction::Header responseHeader(header->requestUID, id());
 	const NewTransaction::Response response(journal->journalSize(), transaction);
@@ -266,11 +380,37 @@ ESErrorCode Worker::newTransaction(const ESHeader* header, const AttachedConnect
 
 ESErrorCode Worker::commitTransaction(const ESHeader* header, const AttachedConnection* connection,
                                       ByteBuffer* memory) {
+	// The next part of a commit that's sent in many parts
+	auto const multipart = mMultipartCommits.get(connection, header->requestUID);
+	if (multipart != nullptr) {
+		return commitNextPart(header, connection, multipart, memory);
+	}
+
 	const auto request = memory->allocate<CommitTransaction::Request>();
 
 	// Get journal name and make sure that it's valid
 	Path journalName;
 	auto err = readAndValidatePath(request->journalStringLength, memory, &journalName);
+
+	// The rest of the events arrive with the next parts. Errors are sent when the last part has arrived
+	if (Bits::IsSet(header->properties, ESPROP_MULTIPART)) {
+		auto const commit = mMultipartCommits.start(connection, header->requestUID, request->eventsSize);
+		if (isError(err)) {
+			commit->fail(err);
+			return ESERR_NO_ERROR;
+		}
+		commit->journalName = journalName;
+
+		// A commit that's too large keeps its error, since no memory is reserved for its events
+		commit->fail(readTransactionTypes(header, request->typeSize, memory));
+		commit->types = mCommitTypes;
+		commit->transactionUID = request->transactionUID.value;
+
+		const uint32_t consumed = memory->offset() - sizeof(ESHeader);
+		const uint32_t size = (uint32_t) header->size > consumed ? header->size - consumed : 0;
+		commit->append(memory->allocate(size), size);
+		return ESERR_NO_ERROR;
+	}
 	if (err != ESERR_NO_ERROR) {
 		return err;
 	}
@@ -281,33 +421,141 @@ ESErrorCode Worker::commitTransaction(const ESHeader* header, const AttachedConn
 		return ESERR_JOURNAL_IS_CLOSED;
 	}
 
+	err = readTransactionTypes(header, request->typeSize, memory);
+	if (isError(err)) {
+		return err;
+	}
+	auto events = MutableString(request->eventsSize, memory);
+	return commitEvents(header, connection, journal, request->transactionUID, mCommitTypes, events, memory);
+}
+
+ESErrorCode Worker::commitNextPart(const ESHeader* header, const AttachedConnection* connection,
+                                   MultipartCommit* commit, ByteBuffer* memory) {
+	commit->append(memory->allocate(header->size), header->size);
+	if (Bits::IsSet(header->properties, ESPROP_MULTIPART)) {
+		return ESERR_NO_ERROR;
+	}
+
+	// This is the last part. The commit is removed when it's done, since the events are read from its memory
+	ESErrorCode err = commit->result();
+	if (!isError(err)) {
+		auto journal = mJournals.getOrNull(commit->journalName);
+		if (journal == nullptr) {
+			err = ESERR_JOURNAL_IS_CLOSED;
+		} else {
+			if (commit->events != nullptr) {
+				commit->events->reset();
+			}
+			const auto events = commit->events != nullptr ? MutableString(commit->eventsSize, commit->events)
+			                                              : MutableString(0, memory);
+			err = commitEvents(header, connection, journal, TransactionID(commit->transactionUID), commit->types,
+			                   events, memory);
+		}
+	}
+	mMultipartCommits.remove(connection, header->requestUID);
+	return err;
+}
+
+ESErrorCode Worker::readTransactionTypes(const ESHeader* header, uint32_t size, ByteBuffer* memory) {
 	// Load types that the client sent to us
+	const auto typeString = MutableString(size, memory);
+	mCommitTypes.clear();
+
+	// The ids are not aligned, since they follow the journal name
+	if (Bits::IsSet(header->properties, ESPROP_TYPE_IDS)) {
+		if (size % sizeof(uint32_t) != 0) {
+			return ESERR_JOURNAL_TYPE_NOT_REGISTERED;
+		}
+		for (uint32_t offset = 0; offset < size; offset += sizeof(uint32_t)) {
+			uint32_t type;
+			memcpy(&type, typeString.str + offset, sizeof(uint32_t));
+			if (type >= mTypes.size()) {
+				return ESERR_JOURNAL_TYPE_NOT_REGISTERED;
+			}
+			mCommitTypes.add(type);
+		}
+		return ESERR_NO_ERROR;
+	}
+
+	// Hash each name while it's split, so that a known name is only compared with the names that have the same hash
+	const char* name = typeString.str;
+	const char* const end = typeString.str + typeString.length;
+	uint32_t hash = TypeInterner::EmptyHash;
+	for (const char* str = name; str != end; ++str) {
+		if (*str != EVENT_TYPE_DELIMITER) {
+			hash = TypeInterner::hash(hash, *str);
+			continue;
+		}
+		if (str != name) {
+			mCommitTypes.add(mTypes.intern(name, (uint32_t) (str - name), hash));
+		}
+		name = str + 1;
+		hash = TypeInterner::EmptyHash;
+	}
+	if (end != name) {
+		mCommitTypes.add(mTypes.intern(name, (uint32_t) (end - name), hash));
+	}
+	return ESERR_NO_ERROR;
+}
+
+ESErrorCode Worker::registerTypes(const ESHeader* header, const AttachedConnection* connection,
+                                  ByteBuffer* memory) {
+	const auto request = memory->allocate<RegisterTypes::Request>();
 	const auto typeString = MutableString(request->typeSize, memory);
 
-	// Convert the types into bit masks, used to identify different event types
-	vector<string> typeStrings;
-	string tmp;
-	const char* str = typeString.str;
-	const char* end = typeString.str + typeString.length;
-	for (; str != end; ++str) {
-		if (*str != EVENT_TYPE_DELIMITER)
-			tmp += *str;
-		else {
-			typeStrings.push_back(tmp);
-			tmp.clear();
+	// Empty names are given an id as well, so that the ids match the names in the request
+	mRegisteredTypes.clear();
+	const char* name = typeString.str;
+	const char* const end = typeString.str + typeString.length;
+	for (const char* str = name; str != end; ++str) {
+		if (*str == EVENT_TYPE_DELIMITER) {
+			mRegisteredTypes.push_back(mTypes.intern(name, (uint32_t) (str - name)));
+			name = str + 1;
 		}
 	}
-	if (tmp.length() > 0) {
-		typeStrings.push_back(tmp);
+	if (typeString.length > 0) {
+		mRegisteredTypes.push_back(mTypes.intern(name, (uint32_t) (end - name)));
 	}
 
-	const auto types = transactionTypes(typeStrings);
-	auto events = MutableString(request->eventsSize, memory);
+	// Write the response
+	const auto count = (uint32_t) mRegisteredTypes.size();
+	const RegisterTypes::Header responseHeader(header->requestUID, count, id());
+	const RegisterTypes::Response response(count);
+	memory->reset();
+	memory->write(&responseHeader);
+	memory->write(&response);
+	memory->write(mRegisteredTypes.data(), count * sizeof(uint32_t));
+
+	// Send the data to the client
+	return sendBytesToClient(connection, memory);
+}
+
+ESErrorCode Worker::commitEvents(const ESHeader* header, const AttachedConnection* connection, Journal* journal,
+                                 TransactionID transactionUID, const TypeSet& types, MutableString events,
+                                 ByteBuffer* memory) {
+	// Stage the commit and hold back the response until the whole group has been written to the journals
+	if (mGroupCommit.enabled()) {
+		const auto stagedBytes = journal->stagedBytes();
+		auto err = journal->tryStage(transactionUID, types, events);
+		if (err != ESERR_NO_ERROR && err != ESERR_JOURNAL_TRANSACTION_CONFLICT) {
+			return err;
+		}
+
+		StagedCommit commit;
+		commit.journal = journal;
+		commit.connection = connection;
+		commit.requestUID = header->requestUID;
+		commit.success = err != ESERR_JOURNAL_TRANSACTION_CONFLICT ? 1 : 0;
+		commit.journalSize = journal->journalSize() + journal->stagedBytes();
+		commit.error = ESERR_NO_ERROR;
+		mGroupCommit.add(commit, journal->stagedBytes() - stagedBytes);
+		return ESERR_NO_ERROR;
+	}
 
 	// Commit the data into the journal. If the journal is null then it's been garbage collected (i.e. you are 
 	// not allowed to have a transaction open for over 1 minute)
-	err = journal->tryCommit(request->transactionUID, types, events);
-	if (err == ESERR_JOURNAL_TRANSACTION_DOES_NOT_EXIST) {
+	auto err = journal->tryCommit(transactionUID, types, events);
+	if (err != ESERR_NO_ERROR && err != ESERR_JOURNAL_TRANSACTION_CONFLICT) {
 		return err;
 	}
 
@@ -374,13 +622,13 @@ ESErrorCode Worker::readJournal(const ESHeader* header, const AttachedConnection
 
 	// Journal size (No not include EOF-marker)
 	const auto clampedJournalSize = journalSize > journal->journalSize() ? journal->journalSize() : journalSize;
-	uint32_t readBytes = (clampedJournalSize - offset);
-	if (readBytes > 0) readBytes--;
-
-	// The amount of bytes left after the header and the response header is written to buffer
 	const auto BYTES_LEFT_AFTER_HEADERS =
 			mConfig.maxBufferSize - sizeof(ReadJournal::Header) - sizeof(ReadJournal::Response);
-	if (readBytes <= BYTES_LEFT_AFTER_HEADERS) {
+	uint32_t readBytes = offset < clampedJournalSize ? clampedJournalSize - offset : 0;
+	if (readBytes > 0) readBytes--;
+
+	// A version 1 journal without the timestamps that fits in one response is sent right away
+	if (journal->format() == JournalFormat::V1 && !includeTimestamp && readBytes <= BYTES_LEFT_AFTER_HEADERS) {
 		// Write and send header and the read-journal responses first
 		memory->reset();
 		const ReadJournal::Header responseHeader(requestUID, ESPROP_NONE, id());
@@ -392,69 +640,99 @@ ESErrorCode Worker::readJournal(const ESHeader* header, const AttachedConnection
 		if (readBytes > 0) {
 			auto stream = AutoClosable<FileInputStream>(journal->inputStream(offset));
 
-			// Write the journal body (with or without timestamp)
-			if (includeTimestamp) {
-				err = stream->readBytes(memory, readBytes);
-				if (isError(err)) return err;
-			} else {
-				err = stream->readJournalBytes(memory, readBytes, &response->bytes);
-				if (isError(err)) return err;
-			}
+			// Write the journal body without the timestamps
+			err = stream->readJournalBytes(memory, readBytes, &response->bytes);
+			if (isError(err)) return err;
 		}
 
 		// Send the data to the client
 		return sendBytesToClient(connection, memory);
+	}
+
+	// Anything else might need more than one response, so the journal is read one response at a time. The reads
+	// only go up to the current journal size
+	ChunkTask* task;
+	if (journal->format() == JournalFormat::V2) {
+		// Records in a version 2 journal are formatted while they are read
+		auto const stream = journal->inputStream(offset, clampedJournalSize);
+		task = new JournalRecordsTask(connection, requestUID, journal, mConfig.maxBufferSize, id(), stream,
+		                              includeTimestamp);
+	} else if (includeTimestamp) {
+		// The journal already contains the timestamps, so the bytes can be sent directly from the journal file
+		task = new JournalFileTask(connection, requestUID, journal, mConfig.maxBufferSize, id(), offset, readBytes);
 	} else {
-		auto stream = AutoClosable<FileInputStream>(journal->inputStream(offset));
-		return readJournalParts(connection, requestUID, includeTimestamp, stream.get(), memory);
+		auto const stream = journal->inputStream(offset, offset + readBytes);
+		task = new JournalBytesTask(connection, requestUID, journal, mConfig.maxBufferSize, id(), stream);
 	}
+
+	// Reads that need more than one response are done by the reader threads, if there are any, so that they don't
+	// hold back the commits
+	if (mReaderPool.enabled() && readBytes > BYTES_LEFT_AFTER_HEADERS) {
+		mReaderPool.add(task);
+		return ESERR_NO_ERROR;
+	}
+	return runTask(task, memory);
 }
 
-ESErrorCode Worker::readJournalParts(const AttachedConnection* connection, uint32_t requestUID, bool includeTimestamp,
-                                     FileInputStream* stream, ByteBuffer* memory) {
-	// The amount of bytes left after the header and the response header is written to buffer
-	const auto BYTES_LEFT_AFTER_HEADERS =
-			mConfig.maxBufferSize - sizeof(ReadJournal::Header) - sizeof(ReadJournal::Response);
+ESErrorCode Worker::runTask(ChunkTask* task, ByteBuffer* memory) {
+	// The first response is sent right away. The rest are interleaved with other requests
+	bool done = false;
+	const ESErrorCode err = task->sendNext(memory, &done);
+	if (done || isError(err)) {
+		delete task;
+		return err;
+	}
+	mChunkScheduler.add(task);
+	return ESERR_NO_ERROR;
+}
 
-	// TODO: Put this as a threaded job (to ensure that smaller journals can be loaded)
-	while (stream->bytesLeft() > 0) {
-		const uint32_t bytesLeft = stream->bytesLeft();
-		const ESHeaderProperties properties = bytesLeft > BYTES_LEFT_AFTER_HEADERS ? ESPROP_MULTIPART : ESPROP_NONE;
-		const uint32_t sendSize = bytesLeft > BYTES_LEFT_AFTER_HEADERS ? BYTES_LEFT_AFTER_HEADERS : bytesLeft;
+ESErrorCode Worker::readJournalEvents(const ESHeader* header, const AttachedConnection* connection,
+                                      ByteBuffer* memory) {
+	const auto request = memory->allocate<ReadJournalEvents::Request>();
+	const auto includeTimestamp = Bits::IsSet(header->properties, ESPROP_INCLUDE_TIMESTAMP);
 
-		// Write and send header and the read-journal responses first
-		memory->reset();
-		memory->ensureCapacity(mConfig.maxBufferSize);
-		const ReadJournal::Header responseHeader(requestUID, properties, id());
-		memory->write(&responseHeader);
-		memory->allocate<ReadJournal::Response>();
-		uint32_t bytesWritten = 0;
-
-		// Write the journal body (with or without timestamp)
-		if (includeTimestamp) {
-			const ESErrorCode err = stream->readBytes(memory, sendSize);
-			if (isError(err)) {
-				return err;
-			}
-		} else {
-			const ESErrorCode err = stream->readJournalBytes(memory, sendSize, &bytesWritten);
-			if (isError(err)) {
-				return err;
-			}
-		}
+	// Get journal name and make sure that it's valid
+	Path journalName;
+	auto err = readAndValidatePath(request->journalStringLength, memory, &journalName);
+	if (err != ESERR_NO_ERROR) return err;
 
-		// TODO: Make this better!!! Update response header
-		auto tm = (ReadJournal::Response*) (memory->ptr() + sizeof(ReadJournal::Header));
-		tm->bytes = bytesWritten;
+	auto journal = mJournals.getOrNull(journalName);
+	if (journal == nullptr) return ESERR_JOURNAL_IS_CLOSED;
 
-		// Send to client
-		const ESErrorCode err = sendBytesToClient(connection, memory);
-		if (isError(err)) {
-			return err;
-		}
-	}
+	// Seek to the closest indexed event and then move forward to the requested event
+	std::unique_ptr<JournalCursor> cursor(journal->cursor(request->firstEvent));
+	if (isError(cursor->error())) return cursor->error();
 
-	return ESERR_NO_ERROR;
+	const ReadJournalEvents::Header responseHeader(header->requestUID, ESPROP_NONE, id());
+	return runTask(new JournalEventsTask(&responseHeader, connection, journal, mConfig.maxBufferSize, cursor.release(),
+	                                     includeTimestamp, request->eventCount, nullptr, 0), memory);
+}
+
+ESErrorCode Worker::readJournalRange(const ESHeader* header, const AttachedConnection* connection,
+                                     ByteBuffer* memory) {
+	const auto request = memory->allocate<ReadJournalRange::Request>();
+	const auto includeTimestamp = Bits::IsSet(header->properties, ESPROP_INCLUDE_TIMESTAMP);
+
+	// Get journal name and make sure that it's valid
+	Path journalName;
+	auto err = readAndValidatePath(request->journalStringLength, memory, &journalName);
+	if (err != ESERR_NO_ERROR) return err;
+
+	auto journal = mJournals.getOrNull(journalName);
+	if (journal == nullptr) return ESERR_JOURNAL_IS_CLOSED;
+
+	// The timestamps are not required to be null-terminated
+	const uint32_t fromLength = strnlen(request->fromTimestamp, Timestamp::BytesLength);
+	const uint32_t toLength = strnlen(request->toTimestamp, Timestamp::BytesLength);
+
+	// Seek to the closest indexed event and then move forward to the first event in the range
+	std::unique_ptr<JournalCursor> cursor(journal->cursor(request->fromTimestamp, fromLength));
+	if (isError(cursor->error())) return cursor->error();
+
+	const ReadJournalRange::Header responseHeader(header->requestUID, ESPROP_NONE, id());
+	return runTask(new JournalEventsTask(&responseHeader, connection, journal, mConfig.maxBufferSize, cursor.release(),
+	                                     includeTimestamp, UINT32_MAX, toLength > 0 ? request->toTimestamp : nullptr,
+	                                     toLength), memory);
 }
 
 ESErrorCode Worker::checkIfJournalExists(const ESHeader* header, const AttachedConnection* connection,
@@ -483,19 +761,118 @@ ESErrorCode Worker::checkIfJournalExists(const ESHeader* header, const AttachedC
 	return sendBytesToClient(connection, memory);
 }
 
-Bits::Type Worker::transactionTypes(vector<string>& types) {
-	Bits::Type transactionType = Bits::None;
-	for (auto& type : types) {
-		auto mask = mTransactionTypes.find(type);
-		if (mask == mTransactionTypes.end()) {
-			transactionType |= mNextTransactionTypeBit;
-			mTransactionTypes.insert(make_pair(type, mNextTransactionTypeBit));
-			mNextTransactionTypeBit = mNextTransactionTypeBit << 1u;
+void Worker::flushGroupCommit() {
+	if (mGroupCommit.empty()) {
+		return;
+	}
+
+	// Make the whole group durable before any of the clients are notified
+	mGroupCommit.flush();
+
+	ByteBuffer memory(sizeof(CommitTransaction::Header) + sizeof(CommitTransaction::Response));
+	for (auto& commit : mGroupCommit.commits()) {
+		memory.reset();
+		if (isError(commit.error)) {
+			Log::Write(Log::Warn, "Worker(%p) | %s (%d)", this, parseErrorCode(commit.error), commit.error);
+			const RequestError::Header responseHeader(commit.requestUID, id());
+			const RequestError::Response response(commit.error);
+			memory.write(&responseHeader);
+			memory.write(&response);
 		} else {
-			transactionType |= mask->second;
+			const CommitTransaction::Header responseHeader(commit.requestUID, id());
+			const CommitTransaction::Response response(commit.success, commit.journalSize);
+			memory.write(&responseHeader);
+			memory.write(&response);
+		}
+
+		const auto err = sendBytesToClient(commit.connection, &memory);
+		if (isError(err)) {
+			Log::Write(Log::Warn, "Worker(%p) | %s (%d)", this, parseErrorCode(err), err);
+		}
+	}
+	mGroupCommit.clear();
+}
+
+void Worker::runScheduledTasks() {
+	// Write the staged commits when the group-commit window has passed or if the group is large enough
+	if (!mGroupCommit.empty() && (mGroupCommit.full() || mGroupCommit.remainingMicros() == 0)) {
+		flushGroupCommit();
+	}
+
+	mDurability.syncWrittenJournals();
+	if (mConfig.transactionTimeoutMillis > 0) {
+		expireTransactions();
+	}
+	mJournals.gcIfDue();
+	if (nextStatisticsMicros() == 0) {
+		logStatistics();
+	}
+}
+
+uint32_t Worker::nextScheduledTaskMicros() const {
+	uint32_t micros = std::min(mDurability.remainingMicros(), mJournals.remainingMicros());
+	if (!mGroupCommit.empty()) {
+		if (mGroupCommit.full()) {
+			return 0u;
 		}
+		micros = std::min(micros, mGroupCommit.remainingMicros());
+	}
+	if (mConfig.transactionTimeoutMillis > 0) {
+		micros = std::min(micros, nextTransactionExpiryMicros());
+	}
+	return std::min(micros, nextStatisticsMicros());
+}
+
+void Worker::logStatistics() {
+	mLastStatistics = chrono::steady_clock::now();
+	Log::Write(Log::Info, "Worker(%p) | Synchronized journals %llu times in %llu microseconds", this,
+	           (unsigned long long) mDurability.syncs(), (unsigned long long) mDurability.syncMicros());
+	Log::Write(Log::Info, "Worker(%p) | Sent %llu read responses between requests, max %d reads waiting, waited %llu "
+	           "microseconds in total (max %llu)", this, (unsigned long long) mChunkScheduler.chunks(),
+	           mChunkScheduler.maxDepth(), (unsigned long long) mChunkScheduler.waitMicros(),
+	           (unsigned long long) mChunkScheduler.maxWaitMicros());
+	Log::Write(Log::Info, "Worker(%p) | Open journals: %d, hits: %llu, misses: %llu, evictions: %llu", this,
+	           mJournals.size(), (unsigned long long) mJournals.hits(), (unsigned long long) mJournals.misses(),
+	           (unsigned long long) mJournals.evictions());
+	Log::Write(Log::Info, "Worker(%p) | Expired %llu transactions", this, (unsigned long long) mExpiredTransactions);
+}
+
+uint32_t Worker::nextStatisticsMicros() const {
+	if (mConfig.statsIntervalMillis == 0) {
+		return UINT32_MAX;
+	}
+
+	const uint64_t interval = mConfig.statsIntervalMillis * 1000ULL;
+	const uint64_t elapsed = chrono::duration_cast<chrono::microseconds>(
+			chrono::steady_clock::now() - mLastStatistics).count();
+	if (elapsed >= interval) {
+		return 0u;
+	}
+	return (uint32_t) std::min(interval - elapsed, (uint64_t) UINT32_MAX);
+}
+
+void Worker::expireTransactions() {
+	const auto expired = mTransactionTimers.advance(transactionTick(), [this](Transaction* t) {
+		Log::Write(Log::Debug, "Worker(%p) | Transaction %u expired", this, t->id().value);
+		t->journal()->expire(t->id());
+	});
+	mExpiredTransactions += expired;
+}
+
+uint32_t Worker::nextTransactionExpiryMicros() const {
+	const auto ticks = mTransactionTimers.ticksUntilNext();
+	if (ticks == UINT64_MAX) {
+		return UINT32_MAX;
+	}
+
+	// The transactions expire when their tick has begun
+	const uint64_t expiresAt = (mTransactionTimers.tick() + ticks) * TransactionTickMillis * 1000u;
+	const auto now = (uint64_t) chrono::duration_cast<chrono::microseconds>(
+			chrono::steady_clock::now().time_since_epoch()).count();
+	if (now >= expiresAt) {
+		return 0u;
 	}
-	return transactionType;
+	return expiresAt - now >= UINT32_MAX ? UINT32_MAX - 1 : (uint32_t) (expiresAt - now);
 }
 
 ESHeader* Worker::loadHeaderFromHost(ByteBuffer* memory) {
@@ -528,8 +905,7 @@ ESHeader* Worker::loadHeaderFromHost(ByteBuffer* memory) {
 	// Restore to the body position
 	memory->restore();
 
-	// Do not allow multipart requests yet!
-	if (header->properties != ESPROP_NONE) {
+	if (!isRequestPropertiesValid(header)) {
 		return &INVALID_HEADER;
 	}
 	return header;
@@ -4,11 +4,18 @@
 #include "../Shared/everstore.h"
 #include "Journals.h"
 #include "AttachedSockets.h"
+#include "GroupCommit.h"
+#include "ReaderPool.h"
+#include "ChunkScheduler.h"
+#include "MultipartCommits.h"
 #include "../Shared/Ipc/IpcChild.h"
 
 class Worker
 {
 public:
+	// How many milliseconds each tick of the transaction timers is
+	static constexpr uint32_t TransactionTickMillis = 10u;
+
 	Worker(ProcessID id, const Config& config);
 
 	~Worker();
@@ -37,18 +44,56 @@ private:
 
 	ESErrorCode commitTransaction(const ESHeader* header, const AttachedConnection* socket, ByteBuffer* memory);
 
+	// Add the next part of a commit that's sent in many parts. The commit is made when the last part arrives
+	ESErrorCode commitNextPart(const ESHeader* header, const AttachedConnection* socket, MultipartCommit* commit,
+	                           ByteBuffer* memory);
+
+	// Commit the supplied events, or stage them if group commit is enabled, and respond to the client
+	ESErrorCode commitEvents(const ESHeader* header, const AttachedConnection* socket, Journal* journal,
+	                         TransactionID transactionUID, const TypeSet& types, MutableString events,
+	                         ByteBuffer* memory);
+
+	// Load the types of a commit into mCommitTypes. The types are comma separated names, or ids from registerTypes if
+	// the request has the ESPROP_TYPE_IDS property. No memory is allocated for types that are already known
+	ESErrorCode readTransactionTypes(const ESHeader* header, uint32_t size, ByteBuffer* memory);
+
+	// Give each of the comma separated event types an id and send the ids to the client
+	ESErrorCode registerTypes(const ESHeader* header, const AttachedConnection* socket, ByteBuffer* memory);
+
 	ESErrorCode rollbackTransaction(const ESHeader* header, const AttachedConnection* socket, ByteBuffer* memory);
 
 	ESErrorCode readJournal(const ESHeader* header, const AttachedConnection* socket, ByteBuffer* memory);
 
 	ESErrorCode checkIfJournalExists(const ESHeader* header, const AttachedConnection* socket, ByteBuffer* memory);
 
-	// Read and send the journal as multiple responses
-	ESErrorCode readJournalParts(const AttachedConnection* socket, uint32_t requestUID,
-	                             bool includeTimestamp, FileInputStream* stream, ByteBuffer* memory);
+	ESErrorCode readJournalEvents(const ESHeader* header, const AttachedConnection* socket, ByteBuffer* memory);
+
+	ESErrorCode readJournalRange(const ESHeader* header, const AttachedConnection* socket, ByteBuffer* memory);
+
+	// Write all staged commits to the journals and then send the held back responses
+	void flushGroupCommit();
+
+	// Run the tasks that are due, such as writing the group commit or synchronizing the journals with the disk
+	void runScheduledTasks();
+
+	// Retrieves how many microseconds until the next task is due. UINT32_MAX if nothing is scheduled
+	uint32_t nextScheduledTaskMicros() const;
+
+	// Close the transactions that have been open for longer than the transaction timeout
+	void expireTransactions();
 
-	// Convert the types into transaction types
-	Bits::Type transactionTypes(vector<string>& types);
+	// Retrieves how many microseconds until the next transaction might expire. UINT32_MAX if no transaction expires
+	uint32_t nextTransactionExpiryMicros() const;
+
+	// Log the synchronizations, the reads waiting between requests, the open journals and the expired transactions
+	void logStatistics();
+
+	// Retrieves how many microseconds until the statistics are logged. UINT32_MAX if they're only logged when stopped
+	uint32_t nextStatisticsMicros() const;
+
+	// Send the first response of a read and then let the scheduler send the rest, interleaved with other requests.
+	// The task is deleted when all responses are sent
+	ESErrorCode runTask(ChunkTask* task, ByteBuffer* memory);
 
 	// Load the next header form host application - with the associated request data
 	ESHeader* loadHeaderFromHost(ByteBuffer* memory);
@@ -68,12 +113,37 @@ private:
 	const ProcessID mId;
 	IpcChild* mIpcChild;
 	atomic_bool mRunning;
+	IoRing mIoRing;
+	Durability mDurability;
+	RecoveryLog mRecoveryLog;
 	Journals mJournals;
 	AttachedSockets mAttachedSockets;
 
-	// Transaction types
-	Bits::Type mNextTransactionTypeBit;
-	unordered_map<string, Bits::Type> mTransactionTypes;
+	// Used instead of the client sockets if the host sends the responses to the clients
+	ResponseChannel mResponseChannel;
+	GroupCommit mGroupCommit;
+	ReaderPool mReaderPool;
+	ChunkScheduler mChunkScheduler;
+	MultipartCommits mMultipartCommits;
+
+	// How many requests have been handled since the last part of an unfinished read was sent
+	uint32_t mRequestsSinceChunk;
+
+	// Transaction types. Each type name is given an id the first time it's seen
+	TypeInterner mTypes;
+
+	// The types of the commit that's being handled. Reused, so that its memory is kept between commits
+	TypeSet mCommitTypes;
+
+	// The ids of the types in the registration that's being handled
+	vector<uint32_t> mRegisteredTypes;
+
+	// Expires the transactions that are open for too long. Counted in ticks of the steady clock
+	TimerWheel<Transaction> mTransactionTimers;
+	uint64_t mExpiredTransactions;
+
+	// When the statistics were last logged
+	chrono::steady_clock::time_point mLastStatistics;
 
 	const Config mConfig;
 };
@@ -40,6 +40,22 @@ void DisplayStartupConfig(const Config& config) {
 	Log::Write(Log::Info, "port = %d", config.port);
 	Log::Write(Log::Info, "maxBufferSize = %d", config.maxBufferSize);
 	Log::Write(Log::Info, "logLevel = %d", config.logLevel);
+	Log::Write(Log::Info, "groupCommitMicros = %d", config.groupCommitMicros);
+	Log::Write(Log::Info, "groupCommitMaxBytes = %d", config.groupCommitMaxBytes);
+	Log::Write(Log::Info, "durability = %s", Durability::toString(config.durability));
+	Log::Write(Log::Info, "durabilityIntervalMillis = %d", config.durabilityIntervalMillis);
+	Log::Write(Log::Info, "journalFormat = %d", config.journalFormat);
+	Log::Write(Log::Info, "mmapReadMinBytes = %d", config.mmapReadMinBytes);
+	Log::Write(Log::Info, "maxOpenJournals = %d", config.maxOpenJournals);
+	Log::Write(Log::Info, "readerThreads = %d", config.readerThreads);
+	Log::Write(Log::Info, "ioUringEntries = %d", config.ioUringEntries);
+	Log::Write(Log::Info, "ioThreads = %d", config.ioThreads);
+	Log::Write(Log::Info, "ipcRingSize = %d", config.ipcRingSize);
+	Log::Write(Log::Info, "serverResponses = %d", config.serverResponses);
+	Log::Write(Log::Info, "maxPipelinedRequests = %d", config.maxPipelinedRequests);
+	Log::Write(Log::Info, "maxCommitSize = %d", config.maxCommitSize);
+	Log::Write(Log::Info, "transactionTimeoutMillis = %d", config.transactionTimeoutMillis);
+	Log::Write(Log::Info, "statsIntervalMillis = %d", config.statsIntervalMillis);
 }
 
 int start(ProcessID idx, const Config& config) {
@@ -80,7 +96,12 @@ int main(int argc, char** argv) {
 
 	// Read the necessary configuration for the worker
 	const auto rootPath = Config::getWorkingDirectory(argv[0]);
-	const string configFileName(argv[2]);
+	string configFileName(argv[2]);
+
+	// The host quotes the path for the Windows command line. The quotes are passed on as they are by execvp
+	if (configFileName.length() >= 2 && configFileName.front() == '"' && configFileName.back() == '"') {
+		configFileName = configFileName.substr(1, configFileName.length() - 2);
+	}
 	const auto p = Config::readFromConfigFile(rootPath, Path(configFileName));
 	Log::SetLogLevel(p.logLevel);
 